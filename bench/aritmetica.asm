@@ -0,0 +1,19 @@
+.NombreProg aritmetica
+# Bucle de SUM/RES/MULT/DIVI en modo inmediato sobre un contador en memoria
+# 99999 vueltas de 11 instrucciones
+_start 0
+04100000
+05000100
+04000100
+02100003
+00100007
+03100002
+01100001
+05000101
+04000100
+00100001
+05000100
+08199999
+11000002
+04100000
+13000000
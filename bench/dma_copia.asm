@@ -0,0 +1,23 @@
+.NombreProg dma_copia
+# Copia 16 sectores del cilindro 1 al 2 pasando por Mem[1000] (dirección
+# física): una lectura y una escritura por vuelta, 2000 vueltas
+_start 0
+04100000
+05000100
+28000000
+29000001
+30000000
+34000016
+32001000
+31000000
+33000000
+29000002
+31000001
+33000000
+04000100
+00100001
+05000100
+08102000
+11000002
+04100000
+13000000
@@ -0,0 +1,29 @@
+.NombreProg j
+# Microbenchmark: J a la instruccion siguiente
+# 16 copias por vuelta mas 5 de control del bucle, 50000 vueltas
+_start 0
+04100000
+05000200
+27000003
+27000004
+27000005
+27000006
+27000007
+27000008
+27000009
+27000010
+27000011
+27000012
+27000013
+27000014
+27000015
+27000016
+27000017
+27000018
+04000200
+00100001
+05000200
+08150000
+11000002
+04100000
+13000000
@@ -0,0 +1,29 @@
+.NombreProg load_indexado
+# Microbenchmark: LOAD indexado (RX = 0)
+# 16 copias por vuelta mas 5 de control del bucle, 50000 vueltas
+_start 0
+04100000
+05000200
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04200201
+04000200
+00100001
+05000200
+08150000
+11000002
+04100000
+13000000
@@ -0,0 +1,29 @@
+.NombreProg psh_pop
+# Microbenchmark: PSH y POP alternados
+# 16 copias por vuelta mas 5 de control del bucle, 50000 vueltas
+_start 0
+04100000
+05000200
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+25000000
+26000000
+04000200
+00100001
+05000200
+08150000
+11000002
+04100000
+13000000
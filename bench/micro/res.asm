@@ -0,0 +1,29 @@
+.NombreProg res
+# Microbenchmark: RES inmediato
+# 16 copias por vuelta mas 5 de control del bucle, 50000 vueltas
+_start 0
+04100000
+05000200
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+01100001
+04000200
+00100001
+05000200
+08150000
+11000002
+04100000
+13000000
@@ -0,0 +1,29 @@
+.NombreProg str
+# Microbenchmark: STR directo (invalida la decodificacion de la palabra)
+# 16 copias por vuelta mas 5 de control del bucle, 50000 vueltas
+_start 0
+04100000
+05000200
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+05000201
+04000200
+00100001
+05000200
+08150000
+11000002
+04100000
+13000000
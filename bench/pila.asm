@@ -0,0 +1,28 @@
+.NombreProg pila
+# Llamada y retorno de subrutina: la dirección de retorno (RB + 7) se apila
+# y RETRN la desapila. La subrutina apila y desapila tres palabras.
+# 50000 llamadas de 21 instrucciones
+_start 0
+04100000
+05000100
+19000000
+00100007
+25000000
+04000100
+27000014
+04000100
+00100001
+05000100
+08150000
+11000002
+04100000
+13000000
+25000000
+00100001
+25000000
+00100001
+25000000
+26000000
+26000000
+26000000
+14000000
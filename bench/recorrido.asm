@@ -0,0 +1,27 @@
+.NombreProg recorrido
+# Recorre 1000 palabras en modo indexado (Mem[400 + RX]) leyendo y
+# escribiendo cada una; 200 pasadas de unas 12 instrucciones por palabra
+_start 0
+04100000
+05000300
+04100000
+05000301
+05000302
+06000301
+04000302
+00200400
+05000302
+04100007
+05200400
+04000301
+00100001
+05000301
+08101000
+11000005
+04000300
+00100001
+05000300
+08100200
+11000002
+04100000
+13000000
@@ -0,0 +1,21 @@
+.NombreProg timer
+# Cálculo largo para repartir entre varios procesos con el reloj al mínimo
+# (TTI 1 = un tick cada 10 ms): 8 x 99999 vueltas de 5 instrucciones
+_start 0
+17000001
+04100000
+05000100
+04100000
+05000101
+04000101
+00100001
+05000101
+08199999
+11000005
+04000100
+00100001
+05000100
+08100008
+11000003
+04100000
+13000000
@@ -0,0 +1,28 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// ====================================================
+// ARENAS DE MEMORIA (RAM simulada y sus tablas paralelas)
+// ====================================================
+// La RAM del simulador y todo lo que lleva una entrada por palabra
+// (caché de decodificación, bloques traducidos, marcas del checkpoint,
+// cuentas del perfil) viven en mapeos anónimos propios. El kernel entrega
+// las páginas en cero recién cuando se tocan: reservar millones de
+// palabras no cuesta nada al arrancar y solo ocupa lo que se usa. Las
+// arenas de al menos ARENA_PAGINA_GRANDE se alinean a ese tamaño y piden
+// transparent huge pages, así un recorrido grande no vive de fallos de TLB.
+
+#define ARENA_PAGINA_GRANDE (2UL * 1024 * 1024)   // Huge page de x86-64
+
+// Reserva 'bytes' en cero (sin tocarlos). Retorna NULL si no hay espacio
+void *arena_reservar(size_t bytes);
+
+// Deja la arena en cero otra vez: devuelve sus páginas al kernel
+void arena_limpiar(void *arena, size_t bytes);
+
+// Libera una arena de arena_reservar (NULL no hace nada)
+void arena_liberar(void *arena, size_t bytes);
+
+#endif
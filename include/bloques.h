@@ -0,0 +1,61 @@
+#ifndef BLOQUES_H
+#define BLOQUES_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "cpu.h"
+
+// ====================================================
+// CACHÉ DE TRADUCCIÓN (motor de bloques y JIT)
+// ====================================================
+// Tipos de los bloques básicos traducidos. Los usa el motor de bloques
+// (motor_bloques.c) y el compilador a código nativo (motor_jit.c).
+
+#define BLOQUE_MAX  16   // Palabras por bloque
+#define REGION      16   // Palabras por región de invalidación
+
+enum {
+    B_SIMPLE,                   // Una instrucción con rutina especializada (H_*)
+    B_GENERICO,                 // Manejador del motor clásico
+    B_COMP_SALTO,               // COMP + JMPE/JMPNE/JMPLT/JMPLGT
+    B_CARGAR_OPERAR,            // LOAD + SUM/RES
+    B_CARGAR_OPERAR_GUARDAR     // LOAD + SUM/RES + STR
+};
+
+typedef struct {
+    unsigned char tipo;           // B_*
+    unsigned char largo;          // Palabras que cubre (1 a 3)
+    unsigned char escribe;        // Puede escribir memoria (y pisar el bloque)
+    int dir;                      // Dirección física de la primera
+    const Decodificada_t *d[3];   // Sus entradas en la caché de decodificación
+} OpBloque_t;
+
+// Código nativo de un bloque. Recibe las instrucciones que quedan en el
+// lote y retorna las retiradas en los 32 bits bajos; el bit 32 pide que la
+// siguiente (cpu.psw.pc) la ejecute el intérprete
+typedef uint64_t (*nativo_t)(int restantes);
+
+typedef struct {
+    int palabras;                 // 0 = lugar vacío
+    int ops;
+    int region[2];                // Primera y última región que cubre
+    unsigned int generacion[2];   // Generaciones de esas regiones al traducirlo
+    unsigned int ejecuciones;     // Veces que corrió interpretado (JIT)
+    unsigned char sin_nativo;     // El JIT no pudo compilarlo
+    unsigned char modo_nativo;    // Modo de operación para el que se compiló
+    unsigned int epoca_nativo;    // Vaciado del JIT en que se compiló (ver ejecutar_bloques)
+    nativo_t nativo;              // NULL = todavía interpretado
+    OpBloque_t op[BLOQUE_MAX];
+} Bloque_t;
+
+// Generación de cada región: sube cuando se escribe sobre código traducido
+// (una por REGION palabras de la RAM, ver bloques_reservar)
+extern atomic_uint *bloques_generacion;
+
+// 1 si nadie escribió sobre el bloque desde que se tradujo
+#define VIGENTE(b)                                                         \
+    ((b)->palabras > 0 &&                                                  \
+     atomic_load_explicit(&bloques_generacion[(b)->region[0]], memory_order_acquire) == (b)->generacion[0] && \
+     atomic_load_explicit(&bloques_generacion[(b)->region[1]], memory_order_acquire) == (b)->generacion[1])
+
+#endif
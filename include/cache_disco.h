@@ -0,0 +1,46 @@
+#ifndef CACHE_DISCO_H
+#define CACHE_DISCO_H
+
+#include "disco.h"
+
+// ====================================================
+// CACHÉ DE SECTORES (BUFFER CACHE)
+// ====================================================
+// Se ubica entre el DMA y el plato. Busca por índice lineal de sector
+// (pista, cilindro, sector) en una tabla hash, desaloja el menos usado
+// (LRU) y difiere las escrituras: un sector escrito queda sucio en la
+// caché hasta que lo desalojan o hasta el próximo vaciado periódico.
+// Solo la usa el hilo del DMA, así que no lleva candados.
+
+#define CACHE_SECTORES_DEFECTO 128   // Capacidad por defecto (0 = sin caché)
+#define CACHE_PERIODO_DEFECTO  1000  // ms entre vaciados de sectores sucios
+
+extern int cache_capacidad;
+extern int cache_periodo_ms;
+
+// Reserva la caché con cache_capacidad entradas. Retorna 1 si tuvo éxito
+int cache_iniciar();
+
+// Libera la caché (los sucios deben haberse vaciado antes)
+void cache_liberar();
+
+// Lee 'cantidad' sectores desde 'primero' hacia 'valores'. Los aciertos no
+// tocan el plato; los fallos se leen del disco y quedan en la caché.
+// Retorna el tiempo mecánico en us
+long long cache_leer(long primero, Sector_t *valores, int cantidad);
+
+// Escribe 'cantidad' sectores desde 'valores'. Con caché solo paga el
+// desalojo de sectores sucios. Retorna el tiempo mecánico en us
+long long cache_escribir(long primero, const Sector_t *valores, int cantidad);
+
+// Baja al plato todos los sectores sucios en orden de disco.
+// Retorna el tiempo mecánico en us
+long long cache_vaciar();
+
+// Sectores sucios en este momento (lo puede consultar cualquier hilo)
+int cache_sucios();
+
+// Escribe en el log los aciertos, fallos y desalojos
+void cache_reporte();
+
+#endif
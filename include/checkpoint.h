@@ -0,0 +1,89 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "constantes.h"
+
+// ====================================================
+// CHECKPOINT Y RESTAURACIÓN DE LA MÁQUINA
+// ====================================================
+// Un archivo de checkpoint es una cadena de fotos. La primera es completa:
+// toda la RAM y los bloques de disco que no están en cero. Las siguientes
+// solo llevan los bloques de RAM y de disco escritos desde la foto
+// anterior. Cada foto guarda además el estado chico completo: registros y
+// PSW, registros del DMA, periodo del timer, tabla de procesos y brazo
+// del disco.
+//
+//   [CabeceraCheckpoint_t] [FotoCheckpoint_t, estado, bloques de RAM, bloques de disco] ...
+//
+// Cada bloque va precedido por su índice. Solo se restaura con el mismo
+// binario que lo grabó (se comparan los tamaños de CPU_t y PCB_t).
+
+#define CHECKPOINT_MAGICO   "SOCHKPT1"  // 8 bytes al inicio del archivo
+#define CHECKPOINT_VERSION  1
+#define BLOQUE_MEMORIA      64          // Palabras por bloque de RAM
+#define BLOQUE_DISCO        1024        // Sectores por bloque de disco
+#define CHECKPOINT_CADA_DEFECTO 1000000ULL
+
+typedef struct {
+    char magico[8];
+    uint32_t version;
+    uint32_t tamano_cpu;        // sizeof(CPU_t)
+    uint32_t tamano_pcb;        // sizeof(PCB_t)
+    uint32_t tamano_memoria;    // maquina.tamano_memoria (--memoria)
+    uint32_t pistas;
+    uint32_t cilindros;
+    uint32_t sectores;
+} CabeceraCheckpoint_t;
+
+typedef struct {
+    uint32_t numero;            // 0 = foto completa
+    uint32_t bloques_memoria;
+    uint32_t bloques_disco;
+    uint32_t reservado;
+    uint64_t instrucciones;     // cpu.instrucciones al tomarla
+} FotoCheckpoint_t;
+
+// Instrucciones entre fotos
+extern unsigned long long checkpoint_cada;
+
+// Bloques de RAM escritos desde la última foto (1 byte por bloque)
+extern unsigned char *checkpoint_memoria_sucia;
+
+// Reserva las marcas de una RAM de 'palabras' (inicializar_cpu).
+// Retorna 1 si tuvo éxito, 0 si falló
+int checkpoint_reservar(int palabras);
+
+// La llama cada escritura a RAM: una sola asignación
+static inline void checkpoint_marcar_memoria(int dir) {
+    checkpoint_memoria_sucia[dir / BLOQUE_MEMORIA] = 1;
+}
+
+// La llama cada escritura al plato del disco
+void checkpoint_marcar_disco(long primero, int cantidad);
+
+// Crea el archivo y empieza a grabar fotos (el disco ya debe estar listo).
+// Retorna 1 si tuvo éxito, 0 si falló
+int checkpoint_abrir(const char *ruta);
+
+// 1 si ya pasaron checkpoint_cada instrucciones desde la última foto
+int checkpoint_toca();
+
+// Recorta un lote para que termine justo en la próxima foto
+int checkpoint_recortar(int cantidad);
+
+// Graba una foto. La máquina debe estar quieta: DMA en pausa, sin
+// interrupciones pendientes y la caché de sectores vaciada
+int checkpoint_tomar();
+
+void checkpoint_cerrar();
+
+// Lee la geometría del disco y el tamaño de la RAM guardados en un
+// checkpoint. Retorna 1 si tuvo éxito, 0 si falló
+int checkpoint_leer_geometria(const char *ruta, int *pistas, int *cilindros, int *sectores, int *palabras);
+
+// Aplica las primeras 'fotos' fotos del archivo (0 = todas) sobre una
+// máquina recién inicializada. Retorna 1 si tuvo éxito, 0 si falló
+int checkpoint_restaurar(const char *ruta, int fotos);
+
+#endif
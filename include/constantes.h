@@ -2,11 +2,14 @@
 #define CONSTANTES_H
 
 // --- CONFIGURACIÓN GENERAL ---
-#define TAMANO_MEMORIA 2000     //
+#define TAMANO_MEMORIA 2000     // Palabras de RAM por defecto (--memoria=N)
+#define MEMORIA_MAXIMA 100000000 // Todo lo que alcanza un registro de 8 dígitos (RB, RX)
 #define TAMANO_PALABRA 8        // 8 dígitos
 #define INICIO_SO      0        // Inicio memoria SO
 #define FIN_SO         299      // Las primeras 300 son del SO
 #define INICIO_USUARIO 300      // El usuario empieza en la 300
+#define MAX_VALOR      99999999  // Rango del AC (8 dígitos)
+#define MIN_VALOR      -99999999
 
 // --- CÓDIGOS DE OPERACIÓN (OpCodes) ---
 // Aritméticas
@@ -51,6 +54,11 @@
 #define OP_SDMAIO  31  // Set DMA I/O (Leer/Escribir)
 #define OP_SDMAM   32  // Set DMA Memoria Direccion
 #define OP_SDMAON  33  // Encender DMA
+// Ráfagas y cadenas de descriptores (DMA scatter-gather)
+#define OP_SDMACNT 34  // Set DMA Cantidad (sectores consecutivos por ráfaga)
+#define OP_SDMACAD 35  // Arrancar cadena de descriptores en Mem[operando]
+
+#define OP_MAXIMO  OP_SDMACAD  // Último opcode válido
 
 // --- CÓDIGOS DE INTERRUPCIÓN ---
 #define INT_SVC_INVALIDO 0
@@ -62,6 +70,8 @@
 #define INT_DIR_INVALIDA 6
 #define INT_UNDERFLOW    7
 #define INT_OVERFLOW     8
+#define INT_IPI          9   // Interrupción entre núcleos (SMP)
+#define INT_FALLO_PAGINA 10  // Página ausente (--memoria-virtual)
 
 // --- MODOS DE DIRECCIONAMIENTO ---
 #define DIR_DIRECTO    0
@@ -3,6 +3,20 @@
 
 #include "constantes.h"
 #include <pthread.h>
+#include <stdatomic.h>
+
+#define MAX_NUCLEOS 8   // Núcleos simulados (SMP)
+#define LINEA_CACHE 64  // Bytes por línea de caché del host
+
+// Lo que escriben hilos distintos va en líneas de caché distintas, así el
+// lock del bus o un tick del timer no invalidan la línea que un núcleo lee
+// en cada instrucción. 'make SIN_ALINEAR=1' quita el relleno (para medir
+// la diferencia con 'make bench BASE=...')
+#ifdef MAQUINA_SIN_ALINEAR
+#define ALINEADO_LINEA
+#else
+#define ALINEADO_LINEA __attribute__((aligned(LINEA_CACHE)))
+#endif
 
 // Estructura para la Palabra de Estado del Programa (PSW)
 typedef struct {
@@ -12,8 +26,11 @@ typedef struct {
     int pc;               // Program Counter (Próxima instrucción)
 } PSW_t;
 
-// Estructura Principal de la CPU
+// Registros de UN núcleo. Cada hilo de núcleo tiene su propia copia y
+// ningún otro hilo la escribe. Lo que toca cada instrucción ocupa
+// exactamente la primera línea de caché; lo que se usa menos va después.
 typedef struct {
+    // --- Primera línea: el camino caliente del intérprete ---
     // Registros de Propósito Especial
     int AC;   // Acumulador (Para operaciones aritméticas)
     int MAR;  // Memory Address Register (Dirección a buscar)
@@ -23,37 +40,111 @@ typedef struct {
     // Registros de Protección de Memoria
     int RB;   // Registro Base (Inicio del proceso)
     int RL;   // Registro Límite (Tamaño del proceso)
-    
+
     // Registros de Pila
     int RX;   // Registro Índice/Auxiliar
     int SP;   // Stack Pointer (Tope de la pila)
 
-    // Hilos y timer
-    int timer_periodo;
-    int interrupcion_pendiente;
-    int codigo_interrupcion;
-
-    // Control de hilos
-    pthread_mutex_t mutex;
-    
     // Palabra de Estado
     PSW_t psw;
 
-    // Memoria Principal (RAM)
-    int memoria[TAMANO_MEMORIA]; 
+    // Lo escribe solo el hilo de la CPU: una instrucción disparó una
+    // interrupción y el lote en curso debe terminar para atenderla
+    int corte_quantum;
+
+    // Instrucciones retiradas desde el arranque
+    unsigned long long instrucciones;
+
+    // --- Segunda línea ---
+    // Registros de la MMU (solo con --paginacion, ver mmu.h)
+    int PTBR; // Base de la tabla de páginas (en la región del SO)
+    int PTLR; // Cantidad de páginas del proceso
+
+    // Número de este núcleo (0..maquina.nucleos-1)
+    int nucleo;
+
+} ALINEADO_LINEA CPU_t;
+
+// Lo que comparten todos los núcleos: la RAM, el bus y el timer. Son
+// tres bloques en líneas de caché separadas, según quién los escribe
+typedef struct {
+    // --- Solo lectura mientras la máquina corre (cada instrucción) ---
+    // Memoria Principal (RAM). Vive en su propia arena (ver arena.h), no
+    // junto a los registros: su tamaño se elige al arrancar (--memoria)
+    int *memoria;
+    int tamano_memoria;     // Palabras (0 = TAMANO_MEMORIA)
 
-    // Variable para saber si la CPU debe seguir corriendo
-    int ejecutando; 
+    // Cantidad de núcleos que corren
+    int nucleos;
 
-} CPU_t;
+    // --- Arbitraje del bus (los núcleos y el DMA) ---
+    // Cada lock escribe esta línea: no debe ser la del puntero a la RAM
+    ALINEADO_LINEA pthread_mutex_t mutex;
 
-// Variable global que representa nuestra máquina única
-extern CPU_t cpu;
+    // --- Dispositivos: los escribe un hilo y los leen otros ---
+    // Periodo del timer en ciclos de 10 ms (0 = apagado). Lo cambia TTI y
+    // lo lee el hilo del timer; relajado: no publica otros datos
+    ALINEADO_LINEA atomic_int timer_periodo;
+
+    // 1 mientras quede algún proceso vivo; lo miran todos los hilos.
+    // Relajado: los resultados se leen después de juntar los hilos
+    atomic_int ejecutando;
+} Maquina_t;
+
+// Registros del núcleo que corre en este hilo. Es una variable por hilo,
+// así el código de la CPU sigue escribiendo cpu.AC sin saber en qué núcleo está.
+extern __thread CPU_t cpu;
+
+// La máquina compartida
+extern Maquina_t maquina;
+
+// --- CACHÉ DE DECODIFICACIÓN ---
+// Cada palabra de memoria se decodifica una sola vez (al cargarla o al
+// sobrescribirla) y paso_cpu despacha directo desde aquí.
+
+// Rutina que ejecuta una instrucción ya decodificada
+typedef void (*manejador_t)(int modo, int operando);
+
+// Rutinas especializadas del motor hilado: una por par (opcode, modo).
+// Las familias con operando van en orden Directo(0), Inmediato(1), Indexado(2).
+enum {
+    H_SUM_DIRECTO,    H_SUM_INMEDIATO,    H_SUM_INDEXADO,
+    H_RES_DIRECTO,    H_RES_INMEDIATO,    H_RES_INDEXADO,
+    H_MULT_DIRECTO,   H_MULT_INMEDIATO,   H_MULT_INDEXADO,
+    H_DIVI_DIRECTO,   H_DIVI_INMEDIATO,   H_DIVI_INDEXADO,
+    H_LOAD_DIRECTO,   H_LOAD_INMEDIATO,   H_LOAD_INDEXADO,
+    H_LOADRX_DIRECTO, H_LOADRX_INMEDIATO, H_LOADRX_INDEXADO,
+    H_COMP_DIRECTO,   H_COMP_INMEDIATO,   H_COMP_INDEXADO,
+    H_STR_DIRECTO,    H_STR_INDEXADO,
+    H_STRRX_DIRECTO,  H_STRRX_INDEXADO,
+    H_JMPE, H_JMPNE, H_JMPLT, H_JMPLGT, H_J,
+    H_GENERICO,       // Cualquier otro caso: usa el manejador clásico
+    H_TOTAL
+};
+
+typedef struct {
+    int opcode;             // Primeros 2 dígitos
+    int modo;               // 3er dígito (Directo/Inmediato/Indexado)
+    int operando;           // Últimos 5 dígitos
+    manejador_t manejador;  // Rutina del opcode (o la de instrucción inválida)
+    int indice;             // Rutina especializada del motor hilado (H_*)
+    void *etiqueta;         // Dirección de esa rutina (goto computado)
+    int contador;           // Contador de (opcode, modo) en estadisticas.h
+} Decodificada_t;
+
+// Arreglo paralelo a maquina.memoria. Arranca en cero y cada entrada se
+// decodifica la primera vez que se busca (ver decodificada)
+extern Decodificada_t *cache_decodificada;
 
 // --- PROTOTIPOS DE FUNCIONES ---
 
-// Inicializa el cpu con valores por defecto
-void inicializar_cpu();
+// Reserva (o limpia) la memoria compartida de maquina.tamano_memoria
+// palabras e inicializa los registros del núcleo 0. No recorre la RAM:
+// arranca en O(1) con cualquier tamaño. Retorna 1 si tuvo éxito, 0 si falló
+int inicializar_cpu();
+
+// Registros de arranque para el núcleo que corre en este hilo
+void inicializar_nucleo(int nucleo);
 
 // Debugger del cpu
 void dump_cpu();
@@ -62,9 +153,114 @@ void dump_cpu();
 // Retorna 1 si salio bien y 0 si hubo error o Halt
 int paso_cpu();
 
-// Bucle principal que llama a paso_cpu hasta terminar
+// Arranca los maquina.nucleos núcleos (el 0 en este hilo) y espera a que terminen
 void ejecutar_cpu();
 
 void *hilo_timer(void *arg);
 
+// Decodifica Mem[dir] y actualiza su entrada en la caché
+void decodificar_palabra(int dir);
+
+// Entrada de la caché de Mem[dir]. Una entrada en cero (sin manejador) es
+// una palabra que nadie escribió todavía: se decodifica al primer uso
+static inline Decodificada_t *decodificada(int dir) {
+    Decodificada_t *d = &cache_decodificada[dir];
+
+    if (__builtin_expect(d->manejador == NULL, 0)) decodificar_palabra(dir);
+    return d;
+}
+
+// Escribe en RAM manteniendo la caché de decodificación al día.
+// Todo Store (STR, STRRX, PSH, DMA, loader) debe pasar por aquí.
+void escribir_memoria(int dir, int valor);
+
+// Copia 'cantidad' palabras a Mem[dir..] de un solo golpe y las decodifica
+// (el loader; no pasa por la traza)
+void escribir_bloque(int dir, const int *valores, int cantidad);
+
+// Postea una interrupción (INT_*) y corta el lote de instrucciones en curso
+void lanzar_interrupcion(int codigo);
+
+// --- MOTORES DE EJECUCIÓN ---
+#define MOTOR_CLASICO 0   // paso_cpu: despacho por puntero a manejador
+#define MOTOR_HILADO  1   // ejecutar_hilado: goto computado + rutinas por modo
+#define MOTOR_BLOQUES 2   // ejecutar_bloques: bloques básicos traducidos y fusionados
+#define MOTOR_JIT     3   // ejecutar_bloques + bloques calientes a código x86-64 (jit.h)
+
+// Motor elegido al arrancar (por defecto el clásico)
+extern int motor_cpu;
+
+// --- MODOS DE EJECUCIÓN ---
+#define MODO_DEMO  0   // Una instrucción, dump_cpu y usleep(100ms) por paso
+#define MODO_TURBO 1   // Lotes de quantum_turbo instrucciones, sin pausas
+#define QUANTUM_TURBO_DEFECTO 10000
+
+extern int modo_ejecucion;
+extern int quantum_turbo;   // Instrucciones entre revisiones de interrupciones
+
+// Resultado de la última ejecutar_cpu (sumando todos los núcleos)
+extern unsigned long long instrucciones_totales;
+extern double ms_ejecucion;
+
+// Tabla de etiquetas del motor hilado (la llena ejecutar_hilado(-1))
+extern void **etiquetas_hilado;
+
+// Rutina especializada (H_*) que le toca a un par (opcode, modo)
+int indice_hilado(int opcode, int modo);
+
+// Ejecuta hasta 'cantidad' instrucciones con el motor hilado.
+// Retorna 1 si salió bien y 0 si hubo error (igual que paso_cpu)
+int ejecutar_hilado(int cantidad);
+
+// Ejecuta hasta 'cantidad' instrucciones con el motor de bloques (y el JIT).
+// Retorna 1 si salió bien y 0 si hubo error (igual que paso_cpu)
+int ejecutar_bloques(int cantidad);
+
+// Avisa que se escribió Mem[dir..dir+cantidad-1]: los bloques traducidos
+// que la cubren dejan de valer
+void bloques_invalidar(int dir, int cantidad);
+
+// Reserva las generaciones de las regiones de una RAM de 'palabras'
+// (inicializar_cpu). Retorna 1 si tuvo éxito, 0 si falló
+int bloques_reservar(int palabras);
+
+// Libera la caché de bloques del núcleo de este hilo
+void bloques_liberar();
+
+void bloques_reporte();
+
+// Piezas de la etapa EXECUTE compartidas por los motores
+int validar_direccion(int dir_fisica);
+int obtener_valor_operando(int modo, int operando);
+void actualizar_codigo_condicion();
+void guardar_resultado(long long resultado_temp);
+
+// Lectura de un operando en memoria sin pasar por obtener_valor_operando.
+// Si la dirección es ilegal, validar_direccion deja el log y el valor es 0.
+static inline int leer_dato(int dir) {
+    if (dir >= 0 && dir < maquina.tamano_memoria &&
+        (cpu.psw.modo_operacion == 1 || (dir >= cpu.RB && dir <= cpu.RL))) {
+        return maquina.memoria[dir];
+    }
+    validar_direccion(dir);
+    return 0;
+}
+
+// COMP: solo fija el código de condición
+static inline void comparar(int val) {
+    if (cpu.AC == val) cpu.psw.codigo_condicion = 0;
+    else if (cpu.AC < val) cpu.psw.codigo_condicion = 1;
+    else cpu.psw.codigo_condicion = 2;
+}
+
+static inline void dividir(int val) {
+    if (val != 0) {
+        cpu.AC /= val;
+        actualizar_codigo_condicion();
+    } else {
+        cpu.psw.codigo_condicion = 3;
+        lanzar_interrupcion(INT_OVERFLOW);
+    }
+}
+
 #endif // CPU_H
\ No newline at end of file
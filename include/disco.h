@@ -3,22 +3,53 @@
 
 #include "constantes.h"
 
+#include <stdint.h>
+#include <stdatomic.h>
+
 // --- DEFINICIONES FÍSICAS DEL DISCO ---
+// Geometría por defecto. Una imagen existente trae la suya en la cabecera
+// y una nueva puede crearse con otra (--geometria=PxCxS).
 #define DISCO_PISTAS    10
 #define DISCO_CILINDROS 10
 #define DISCO_SECTORES  100
-#define TAMANO_SECTOR   9   // "Cada sector tiene un dato de 9 caracteres"
 
-// Estructura de un Sector (La unidad mínima de almacenamiento)
+// Cada sector guarda una palabra entera de ancho fijo (antes eran 9
+// caracteres en texto). Se lee y escribe sin conversiones.
+typedef int32_t Sector_t;
+#define TAMANO_SECTOR   ((int)sizeof(Sector_t))
+
+// --- IMAGEN DE DISCO EN ARCHIVO ---
+// [Cabecera (DISCO_CABECERA bytes)] [Sectores en orden pista, cilindro, sector]
+// Los sectores empiezan alineados a página para mapearlos directamente.
+#define DISCO_MAGICO    "SODISCO"
+#define DISCO_VERSION   1
+#define DISCO_CABECERA  4096
+
 typedef struct {
-    char datos[TAMANO_SECTOR]; 
-} Sector_t;
+    char magico[8];        // "SODISCO\0"
+    uint32_t version;
+    uint32_t tamano_sector; // Bytes por sector (sizeof(Sector_t))
+    uint32_t pistas;
+    uint32_t cilindros;
+    uint32_t sectores;
+} CabeceraDisco_t;
 
-// El Disco Duro completo (Matriz 3D)
+// El Disco Duro completo: una vista mapeada de la imagen
 typedef struct {
-    Sector_t plato[DISCO_PISTAS][DISCO_CILINDROS][DISCO_SECTORES];
+    int pistas;
+    int cilindros;
+    int sectores;
+    long total_sectores;
+    Sector_t *plato;        // total_sectores sectores contiguos
+    void *mapa;             // Región devuelta por mmap (cabecera incluida)
+    size_t tamano_mapa;
+    int fd;                 // -1 = disco volátil (mapeo anónimo)
 } Disco_t;
 
+// Índice lineal de (pista, cilindro, sector) en disco.plato
+#define DISCO_INDICE(p, c, s) \
+    (((long)(p) * disco.cilindros + (c)) * disco.sectores + (s))
+
 // --- CONTROLADOR DMA (El intermediario) ---
 typedef struct {
     // Registros de configuración (Llenados por instrucciones SDMAP, SDMAC, etc.)
@@ -28,16 +59,101 @@ typedef struct {
     int direccion_memoria; // A dónde va/viene el dato en RAM
     
     int es_escritura;      // 0 = Leer del Disco (Disk->RAM), 1 = Escribir (RAM->Disk)
-    int estado;            // Registro ESTADOdma (0=Exito, 1=Error)
-    int activo;            // 1 = Trabajando, 0 = Inactivo
+    int cantidad;          // Sectores consecutivos por ráfaga (SDMACNT, 1 por defecto)
 } DMA_t;
 
+// Estado del controlador: uno solo para toda la máquina. Lo escribe el
+// hilo del DMA (y SDMAON al encolar) y lo lee cualquier núcleo
+typedef struct {
+    atomic_int estado;     // Registro ESTADOdma de la última transferencia (0=Exito, 1=Error)
+    atomic_int activo;     // 1 = Hay solicitudes en curso, 0 = Inactivo
+} EstadoDMA_t;
+
+// Foto de los registros del DMA tomada por SDMAON. El hilo del DMA trabaja
+// sobre la foto, así la CPU puede reprogramar los registros enseguida.
+typedef struct {
+    int pista;
+    int cilindro;
+    int sector;
+    int direccion_memoria;
+    int es_escritura;
+    int cantidad;          // Sectores de la ráfaga
+    int cadena;            // Dirección de la cadena de descriptores (-1 = ráfaga simple, DMA_VACIADO)
+    long long llegada_us;  // Cuándo se encoló (reloj del planificador)
+    int pid;               // Proceso que la pidió (recibe su INT_IO_FIN)
+} SolicitudDMA_t;
+
+// --- DESCRIPTORES EN MEMORIA (Scatter-Gather) ---
+// Cada descriptor ocupa 6 palabras consecutivas en RAM:
+//   [0] pista  [1] cilindro  [2] sector  [3] dirección RAM
+//   [4] cantidad de sectores  [5] 0 = Leer, 1 = Escribir
+// La cadena sigue con el descriptor siguiente y termina en el primero
+// que tenga cantidad 0. Una ráfaga recorre sectores consecutivos: al
+// pasar el último sector sigue en el próximo cilindro, y luego pista.
+#define DESC_PISTA     0
+#define DESC_CILINDRO  1
+#define DESC_SECTOR    2
+#define DESC_MEMORIA   3
+#define DESC_CANTIDAD  4
+#define DESC_ESCRITURA 5
+#define DESC_PALABRAS  6
+#define DMA_MAX_DESCRIPTORES 1024   // Tope por cadena (evita cadenas infinitas)
+
+#define DMA_VACIADO          -2      // Valor de 'cadena' para un vaciado de la caché
+#define DMA_MAX_SOLICITUDES  256     // Solicitudes en cola antes de frenar a la CPU
+
 // Variables Globales (Para que cpu.c y main.c las vean)
 extern Disco_t disco;
-extern DMA_t dma;
+// Los registros de programación son por núcleo (cada hilo de CPU arma su
+// transferencia sin pisar la de otro núcleo)
+extern __thread DMA_t dma;
+
+// ESTADOdma y el indicador de actividad, compartidos. ESTADOdma se publica
+// con release antes del INT_IO_FIN: quien atiende el fin ya lo ve
+extern EstadoDMA_t dma_controlador;
+
+// 1 = el hilo del DMA duerme el tiempo que calcula el modelo del disco
+// (ver planificador_disco.h); 0 = el tiempo solo se simula
+extern int dma_tiempo_real;
 
 // Funciones
-void inicializar_disco();
+// Mapea la imagen 'ruta' (la crea dispersa con la geometría pedida si no
+// existe). Con ruta NULL el disco es volátil, como en la Fase 1.
+// Retorna 1 si tuvo éxito, 0 si falló
+int inicializar_disco(const char *ruta, int pistas, int cilindros, int sectores);
+
+// Baja a la imagen lo escrito y libera el mapeo
+void cerrar_disco();
+
 void *hilo_dma(void *arg); // El hilo que moverá los datos
+void *hilo_vaciado(void *arg); // Vacía periódicamente la caché de sectores
+
+// Encola los registros actuales como una solicitud del proceso 'pid' y
+// despierta al hilo (SDMAON)
+void dma_encolar(int pid);
+
+// Encola una cadena de descriptores que empieza en Mem[direccion] (SDMACAD)
+void dma_encolar_cadena(int direccion, int pid);
+
+// Proceso dueño de la transferencia terminada más antigua que todavía no
+// se atendió (una por cada INT_IO_FIN). Retorna -1 si no hay ninguna
+int dma_siguiente_completada();
+
+// Espera a que el DMA termine todo lo encolado (sus INT_IO_FIN ya quedan
+// posteadas) y lo deja sin tomar trabajo nuevo hasta dma_reanudar.
+// Lo usa el checkpoint para ver el disco y la RAM quietos
+void dma_pausar();
+void dma_reanudar();
+
+// Escribe 'cantidad' sectores desde 'primero' sin pasar por el DMA ni la
+// caché (valores NULL = ceros). Solo antes de arrancar el hilo del DMA:
+// el loader lo usa para armar el swap de --memoria-virtual
+void disco_escribir_directo(long primero, const Sector_t *valores, int cantidad);
+
+// Transferencias terminadas desde inicializar_disco
+unsigned long long dma_transferencias();
+
+// El hilo del DMA termina las solicitudes pendientes y sale
+void detener_dma();
 
 #endif // DISCO_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef ESTADISTICAS_H
+#define ESTADISTICAS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include "constantes.h"
+#include "interrupciones.h"
+
+// ====================================================
+// CONTADORES SIEMPRE ACTIVOS
+// ====================================================
+// Cada hilo (núcleos, timer, DMA, main) suma en su propio bloque de
+// contadores y nadie más escribe en él: no hay candados ni líneas de
+// caché compartidas. Un contador se suma con una lectura y una escritura
+// relajadas, que cuestan lo mismo que un ++ común. Quien lee (el
+// exportador, los reportes) recorre todos los bloques y los suma.
+
+// Una entrada por par (opcode, modo) válido y una para todo lo inválido
+#define ESTAD_MODOS        3    // Directo, Inmediato, Indexado
+#define ESTAD_INVALIDA     ((OP_MAXIMO + 1) * ESTAD_MODOS)
+#define ESTAD_INSTRUCCIONES (ESTAD_INVALIDA + 1)
+
+#define ESTAD_PERIODO_DEFECTO 1000   // ms entre exportaciones
+
+typedef _Atomic uint64_t Contador_t;
+
+typedef struct {
+    Contador_t instrucciones[ESTAD_INSTRUCCIONES];
+    Contador_t int_posteadas[TOTAL_INTERRUPCIONES];
+    Contador_t int_atendidas[TOTAL_INTERRUPCIONES];
+    Contador_t fallas_proteccion;   // validar_direccion (o la MMU) rechazó un acceso
+    Contador_t tlb_aciertos;        // Traducciones resueltas por la TLB (--paginacion)
+    Contador_t tlb_fallos;          // Traducciones que recorrieron la tabla de páginas
+    Contador_t fallos_pagina;       // INT_FALLO_PAGINA atendidos (--memoria-virtual)
+    Contador_t swap_paginas_leidas; // Páginas subidas del swap (prefetch incluido)
+    Contador_t swap_paginas_escritas; // Páginas sucias bajadas al swap
+    Contador_t prefetch_paginas;    // Páginas subidas de más por --prefetch
+    Contador_t dma_lecturas;        // Ráfagas Disco -> RAM
+    Contador_t dma_escrituras;      // Ráfagas RAM -> Disco
+    Contador_t dma_sectores_leidos;
+    Contador_t dma_sectores_escritos;
+    Contador_t dma_errores;
+    Contador_t io_cuenta;           // SDMAON/SDMACAD -> INT_IO_FIN
+    Contador_t io_suma_us;
+    Contador_t io_max_us;
+} __attribute__((aligned(64))) Contadores_t;
+
+// Bloque del hilo actual. Apunta a un bloque común hasta que el hilo
+// llama a estadisticas_hilo(), así nunca es NULL
+extern __thread Contadores_t *contadores;
+
+// Período del exportador (ms)
+extern int estadisticas_periodo_ms;
+
+// Le da al hilo actual su propio bloque (al arrancar cada hilo)
+void estadisticas_hilo();
+
+// Macro y no función: está en el camino de cada instrucción
+#define ESTAD_SUMAR(c, n) \
+    atomic_store_explicit((c), atomic_load_explicit((c), memory_order_relaxed) + (n), memory_order_relaxed)
+
+static inline void estad_maximo(Contador_t *c, uint64_t valor) {
+    if (valor > atomic_load_explicit(c, memory_order_relaxed)) {
+        atomic_store_explicit(c, valor, memory_order_relaxed);
+    }
+}
+
+// Índice en 'instrucciones' de una palabra decodificada
+static inline int estad_indice(int opcode, int modo) {
+    if (opcode < 0 || opcode > OP_MAXIMO || modo < 0 || modo >= ESTAD_MODOS) return ESTAD_INVALIDA;
+    return opcode * ESTAD_MODOS + modo;
+}
+
+// Suma de un contador en todos los bloques. 'desplazamiento' es
+// offsetof(Contadores_t, campo)
+uint64_t estadisticas_total(size_t desplazamiento);
+
+// Empieza a exportar a 'ruta' cada estadisticas_periodo_ms (lo hace
+// hilo_estadisticas). Retorna 1 si tuvo éxito, 0 si falló
+int estadisticas_abrir(const char *ruta);
+
+// Reescribe el archivo con los valores actuales (también el volcado final)
+int estadisticas_exportar();
+
+// Exporta periódicamente hasta que se apaga la máquina
+void *hilo_estadisticas(void *arg);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef IMAGEN_H
+#define IMAGEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ====================================================
+// IMAGEN BINARIA DE PROGRAMA
+// ====================================================
+// Un programa ya ensamblado: cabecera fija seguida de las palabras como
+// int32_t. El loader la mapea y la copia de un solo golpe a la RAM. La
+// genera bin/asm2img a partir del formato de texto .asm.
+
+#define IMAGEN_MAGICO   "SOIMAGN1"  // 8 bytes al inicio del archivo
+#define IMAGEN_VERSION  1
+#define IMAGEN_NOMBRE   32
+
+typedef struct {
+    char magico[8];
+    uint32_t version;
+    uint32_t tamano_cabecera;   // sizeof(CabeceraImagen_t): las palabras empiezan aquí
+    char nombre[IMAGEN_NOMBRE]; // .NombreProg
+    int32_t entrada;            // _start: primera instrucción, relativa al inicio del programa
+    int32_t palabras;
+    int32_t base;               // Dónde se carga, relativa al inicio de la partición
+    uint32_t suma;              // FNV-1a de las palabras
+} CabeceraImagen_t;
+
+// Programa en memoria, leído del texto .asm
+typedef struct {
+    char nombre[IMAGEN_NOMBRE];
+    int entrada;
+    int declaradas;     // .NumeroPalabras (-1 si no vino)
+    int palabras;
+    int32_t *valores;
+    int *lineas;        // Línea del .asm de cada palabra (1 = la primera)
+    int linea_error;    // Línea del primer error de sintaxis (0 = ninguno)
+} Programa_t;
+
+// Interpreta un .asm completo en una pasada:
+//   _start N            primera instrucción (desplazamiento desde el inicio)
+//   .NumeroPalabras N   cantidad declarada (solo se compara)
+//   .NombreProg texto   nombre del programa
+//   NNNNNNNN [resto]    una palabra; lo que sigue al número es comentario
+// Cualquier otra línea se ignora. Retorna 1 si tuvo éxito, 0 si falló
+int imagen_parsear_texto(const char *texto, size_t largo, Programa_t *p);
+
+void imagen_liberar(Programa_t *p);
+
+// FNV-1a de 32 bits sobre las palabras
+uint32_t imagen_suma(const int32_t *valores, int palabras);
+
+// 1 si 'datos' empieza con la cabecera de una imagen
+int imagen_es_binaria(const void *datos, size_t largo);
+
+// Revisa cabecera, tamaño y suma. Retorna NULL si es válida o el motivo
+const char *imagen_validar(const void *datos, size_t largo);
+
+// Escribe 'p' como imagen binaria con la base de carga indicada.
+// Retorna 1 si tuvo éxito, 0 si falló
+int imagen_escribir(const char *ruta, const Programa_t *p, int base);
+
+#endif
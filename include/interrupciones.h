@@ -0,0 +1,67 @@
+#ifndef INTERRUPCIONES_H
+#define INTERRUPCIONES_H
+
+#include <stdatomic.h>
+#include "constantes.h"
+#include "cpu.h"
+
+// ====================================================
+// CONTROLADOR DE INTERRUPCIONES
+// ====================================================
+// Un bit pendiente por cada código INT_* de constantes.h. Los dispositivos
+// (Timer, DMA) y la propia CPU postean con operaciones atómicas, sin mutex.
+// Cada fuente lleva además la cantidad de ocurrencias sin atender, así dos
+// fines de DMA o dos ticks seguidos se atienden dos veces (no se pierden).
+// Con varios núcleos cada uno tiene su propia máscara: las excepciones
+// van al núcleo que las causó, el reloj a todos y el fin de E/S al 0.
+// Un núcleo despierta a otro con INT_IPI (un OR atómico en su máscara).
+
+#define TOTAL_INTERRUPCIONES (INT_FALLO_PAGINA + 1)
+
+// Lo pendiente de un núcleo. Cada núcleo tiene sus propias líneas de caché:
+// limpiar un bit propio no invalida la máscara que sondea otro núcleo
+typedef struct {
+    atomic_uint mascara;                              // Bit i = código i con ocurrencias
+    atomic_uint cuenta[TOTAL_INTERRUPCIONES];         // Ocurrencias sin atender (la máscara es su resumen)
+    atomic_llong posteada_ns[TOTAL_INTERRUPCIONES];   // Posteo de la ocurrencia que levantó el bit
+} ALINEADO_LINEA PendientesNucleo_t;
+
+extern PendientesNucleo_t ic_pendientes[MAX_NUCLEOS];
+
+// Revisión barata para el bucle de la CPU: una sola lectura relajada
+static inline int ic_hay_pendientes() {
+    return atomic_load_explicit(&ic_pendientes[cpu.nucleo].mascara, memory_order_relaxed) != 0;
+}
+
+// Deja el controlador sin pendientes y la latencia en cero (los
+// contadores por fuente están en estadisticas.h)
+void ic_reiniciar();
+
+// Postea una ocurrencia de la interrupción 'codigo' al núcleo actual
+void ic_postear(int codigo);
+
+// Postea al núcleo indicado (dispositivos e interrupciones entre núcleos)
+void ic_postear_nucleo(int nucleo, int codigo);
+
+// Postea a todos los núcleos (el tick del reloj)
+void ic_difundir(int codigo);
+
+// Saca la interrupción pendiente de mayor prioridad del núcleo actual.
+// Retorna -1 si no hay
+int ic_siguiente();
+
+// Ocurrencias posteadas / atendidas de un código desde el arranque
+unsigned long long ic_posteadas(int codigo);
+unsigned long long ic_atendidas(int codigo);
+
+// Latencia entre el posteo y el despacho (ic_siguiente) de un código, o de
+// todos con codigo -1. Retorna cuántas ocurrencias se midieron
+unsigned long long ic_latencia(int codigo, double *media_us, double *max_us);
+
+// Nombre corto de un código ("SYSCALL", "OVERFLOW"...); "?" si no existe
+const char *ic_nombre(int codigo);
+
+// Escribe en el log los contadores por fuente
+void ic_reporte();
+
+#endif
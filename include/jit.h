@@ -0,0 +1,45 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "bloques.h"
+
+// ====================================================
+// JIT: BLOQUES CALIENTES A CÓDIGO x86-64
+// ====================================================
+// Segundo nivel del motor de bloques (--motor=jit). Un bloque que corrió
+// JIT_UMBRAL veces interpretado se compila a código nativo: AC, RX, SP,
+// RB, RL y el código de condición viven en registros del host, y los
+// chequeos de rango (MAX_VALOR/MIN_VALOR) y de partición (RB..RL) van en
+// línea. Cuando uno falla, el código nativo devuelve la instrucción al
+// intérprete, que dispara la interrupción igual que paso_cpu.
+//
+// El código se especializa en el modo de operación del momento: en modo
+// Kernel solo se chequea la RAM física; en modo Usuario también RB..RL.
+// El código nativo lleva grabadas las direcciones de los registros y los
+// contadores del hilo que lo compiló: cada núcleo tiene el suyo, igual
+// que su caché de bloques.
+
+#define JIT_UMBRAL 50      // Ejecuciones interpretadas antes de compilar
+#define JIT_ARENA  (4 << 20)   // Bytes de código nativo por núcleo
+
+// 1 si el host puede correr el JIT (x86-64 con Linux)
+int jit_disponible();
+
+// Compila el bloque (o su comienzo, hasta la primera instrucción que el
+// JIT no maneja) y deja el código en b->nativo.
+// Retorna 1 si tuvo éxito, 0 si no hay nada compilable
+int jit_compilar(Bloque_t *b);
+
+// 1 si en la arena del núcleo entra otro bloque
+int jit_hay_lugar();
+
+// Descarta todo el código nativo del núcleo (quien llama borra los
+// punteros b->nativo que lo apuntaban)
+void jit_vaciar();
+
+// Devuelve la arena del núcleo de este hilo
+void jit_liberar();
+
+void jit_reporte();
+
+#endif
@@ -1,8 +1,13 @@
 #ifndef LOADER_H
 #define LOADER_H
 
-// Carga un archivo .asm en la memoria de la CPU
+// Carga un programa en la memoria de la CPU, en Mem[base..limite]. Acepta
+// el texto .asm o una imagen binaria de bin/asm2img (ver imagen.h); el
+// formato se reconoce por el contenido. Deja en *entrada la dirección
+// de la primera instrucción (_start). Con tabla >= 0 (PTBR de un proceso
+// paginado, ver mmu.h) base..limite y la entrada son lógicas y cada página
+// va a su marco; con -1 son direcciones físicas.
 // Retorna 1 si tuvo éxito, 0 si falló
-int cargar_programa(const char *nombre_archivo);
+int cargar_programa(const char *nombre_archivo, int base, int limite, int tabla, int *entrada);
 
 #endif
\ No newline at end of file
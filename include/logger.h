@@ -1,13 +1,48 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-// Inicializa el sistema de logs (abre el archivo)
+// --- NIVELES DE SEVERIDAD ---
+#define LOG_NIVEL_TRAZA 0   // Una línea por instrucción (camino caliente de la CPU)
+#define LOG_NIVEL_DEBUG 1   // Volcados de estado (dump_cpu)
+#define LOG_NIVEL_INFO  2   // Eventos normales (carga, DMA, interrupciones)
+#define LOG_NIVEL_ERROR 3   // Fallos
+#define LOG_NIVEL_SILENCIO 4 // Nada (las instancias del modo lote)
+
+// Umbral actual: se descartan los mensajes con nivel menor
+extern int logger_nivel;
+
+// Inicializa el sistema de logs (abre el archivo y arranca el hilo escritor)
 void logger_init(const char *filename);
 
-// Escribe un mensaje (funciona IGUAL que printf)
+// Escribe un mensaje de nivel INFO (funciona IGUAL que printf)
 void logger_log(const char *format, ...);
 
-// Cierra el archivo de log
+// Escribe un mensaje con un nivel explícito
+void logger_log_nivel(int nivel, const char *format, ...);
+
+// Cambia el umbral en tiempo de ejecución
+void logger_set_nivel(int nivel);
+
+// Convierte "traza", "debug", "info" o "error" en su nivel (-1 si no existe)
+int logger_nivel_desde_texto(const char *texto);
+
+// Vacía lo pendiente, detiene el hilo escritor y cierra el archivo de log
 void logger_close();
 
-#endif
\ No newline at end of file
+// --- MACROS POR NIVEL ---
+// El umbral se revisa antes de formatear, así un mensaje filtrado no cuesta
+// más que una comparación. Compilando con -DLOG_SIN_TRAZA (make SIN_TRAZA=1)
+// las TRAZAS desaparecen del binario.
+#define LOG_NIVEL(nivel, ...) \
+    do { if ((nivel) >= logger_nivel) logger_log_nivel((nivel), __VA_ARGS__); } while (0)
+
+#ifdef LOG_SIN_TRAZA
+#define LOG_TRAZA(...) ((void)0)
+#else
+#define LOG_TRAZA(...) LOG_NIVEL(LOG_NIVEL_TRAZA, __VA_ARGS__)
+#endif
+#define LOG_DEBUG(...) LOG_NIVEL(LOG_NIVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_NIVEL(LOG_NIVEL_INFO, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_NIVEL(LOG_NIVEL_ERROR, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+// ====================================================
+// MODO LOTE: MUCHAS MÁQUINAS INDEPENDIENTES EN PARALELO
+// ====================================================
+// Un manifiesto lista programas y sus entradas, uno por línea:
+//
+//     programa.asm [AC=n] [RX=n] [M<dir>=n ...] [LIMITE=n]
+//
+// M<dir> es una dirección lógica (relativa al inicio de la partición).
+// Las líneas vacías y las que empiezan con '#' se ignoran.
+//
+// Cada programa corre en una máquina propia (CPU, memoria, disco y DMA)
+// dentro de un proceso hijo, en modo TURBO y sin log. Un grupo de
+// trabajadores (uno por núcleo del host) toma el programa siguiente de un
+// contador atómico compartido: el que termina antes agarra más trabajo.
+// Al final se imprime una línea por programa, en el orden del manifiesto:
+//
+//     programa AC=.. RX=.. SP=.. PC=.. CC=.. INT=n SALIDA=NOMBRE INSTRUCCIONES=n MS=x
+
+#define LOTE_MAX_PROGRAMAS  100000
+#define LOTE_MAX_MEMORIA    16          // Entradas M<dir>= por programa
+#define LOTE_LIMITE_DEFECTO 100000000ULL // Instrucciones por programa (corta bucles infinitos)
+
+// Códigos de salida propios del lote (los demás son INT_* o SALIDA_LIMITE)
+#define LOTE_ERROR_CARGA  -2    // No se pudo cargar el programa o sus entradas
+#define LOTE_CAIDA        -3    // La instancia murió sin dejar resultado
+
+// Trabajadores en paralelo (0 = uno por núcleo del host)
+extern int lote_trabajadores;
+
+// Corre el manifiesto y escribe los resultados en la salida estándar.
+// Deja en instrucciones_totales y ms_ejecucion lo de todo el lote (para
+// --resumen). Retorna 1 si todos los programas terminaron con SVC 0, 0 si no
+int lote_ejecutar(const char *manifiesto);
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include "cpu.h"
+#include "constantes.h"
+#include "estadisticas.h"
+
+// ====================================================
+// MEMORIA PAGINADA (--paginacion)
+// ====================================================
+// Sin paginación cada proceso ocupa una partición contigua RB..RL. Con
+// paginación su espacio lógico (0..RL, con RB = 0) se parte en páginas de
+// PAGINA palabras que caen en cualquier marco libre. La tabla de páginas
+// de cada proceso vive en la región del SO (una palabra por página, ver
+// PTE_*) y la apuntan los registros PTBR/PTLR.
+//
+// Cada núcleo traduce con una TLB de correspondencia directa. Sus entradas
+// llevan el PTBR del proceso como etiqueta: al cambiar de contexto no hace
+// falta vaciarla, y como las tablas nunca se reubican dos procesos no
+// comparten etiqueta.
+//
+// Con --memoria-virtual las páginas se cargan por demanda desde un área de
+// swap al final del disco. Tocar una página ausente postea INT_FALLO_PAGINA
+// sin ejecutar la instrucción; el SO elige un marco con el algoritmo del
+// reloj (segunda oportunidad, bits R y M), arma una cadena de descriptores
+// del DMA (bajar la víctima si está sucia, subir la página y, con
+// --prefetch, las siguientes que entren en marcos libres) y bloquea al proceso hasta su INT_IO_FIN. Solo con un
+// núcleo: el reloj invalida las entradas de la TLB del núcleo que lo corre.
+
+#define PAGINA_BITS   5
+#define PAGINA        (1 << PAGINA_BITS)          // 32 palabras por página
+#define MARCOS        (TAMANO_MEMORIA / PAGINA)   // Marcos enteros de la RAM
+#define PRIMER_MARCO  ((INICIO_USUARIO + PAGINA - 1) / PAGINA)   // Primero de usuario
+#define TLB_ENTRADAS  64                          // Potencia de 2 (cubre un proceso que use toda la RAM)
+
+// Entrada de la tabla de páginas
+#define PTE_MARCO        0xFF       // Número de marco
+#define PTE_PRESENTE     (1 << 8)   // La página está en ese marco
+#define PTE_REFERENCIADA (1 << 9)   // Bit R del reloj
+#define PTE_SUCIA        (1 << 10)  // Bit M: hay que bajarla al swap antes de reusar el marco
+#define PTE_SALIENDO     (1 << 11)  // Su copia al swap todavía está en la cola del DMA
+
+#define MMU_FALLO     -2   // mmu_traducir: página ausente, INT_FALLO_PAGINA posteada
+#define PREFETCH_MAX  3    // Páginas siguientes que sube un fallo (--prefetch)
+
+typedef struct {
+    int ptbr;     // Tabla del proceso dueño de la entrada
+    int pagina;   // -1 = vacía
+    int marco;
+    int sucia;    // Ya se marcó M: un store no necesita pasar por la tabla
+} EntradaTLB_t;
+
+// 1 = memoria paginada
+extern int paginacion;
+
+// 1 = paginación por demanda con swap en el disco (implica paginacion)
+extern int memoria_virtual;
+
+// Páginas de cada proceso (0 = repartir los marcos libres en partes iguales)
+extern int paginas_proceso;
+
+// Marcos de usuario que se usan (--marcos, todos por defecto)
+extern int marcos_usuario;
+
+// Páginas siguientes que sube cada fallo (--prefetch)
+extern int prefetch_paginas;
+
+// TLB del núcleo que corre en este hilo
+extern __thread EntradaTLB_t tlb[TLB_ENTRADAS];
+
+// Camino lento: recorre la tabla de páginas y llena la TLB.
+// Retorna la dirección física, -1 si la página no es del proceso o
+// MMU_FALLO si no está en RAM
+int mmu_fallo_tlb(int dir);
+
+// Dirección lógica -> física con la tabla del proceso en la CPU
+static inline int mmu_traducir(int dir) {
+    unsigned int pagina = (unsigned int)dir >> PAGINA_BITS;
+    const EntradaTLB_t *e = &tlb[pagina & (TLB_ENTRADAS - 1)];
+
+    if (e->pagina == (int)pagina && e->ptbr == cpu.PTBR) {
+        ESTAD_SUMAR(&contadores->tlb_aciertos, 1);
+        return (e->marco << PAGINA_BITS) | (dir & (PAGINA - 1));
+    }
+    return mmu_fallo_tlb(dir);
+}
+
+// Dirección física de una dirección que armó la CPU (RB + operando, PC,
+// pila). Sin paginación es la misma, validada contra RB..RL. Retorna -1 si
+// es ilegal (validar_direccion o la MMU ya dejaron el log y la falla contada)
+static inline int traducir_direccion(int dir) {
+    if (!paginacion) return validar_direccion(dir) ? dir : -1;
+    return mmu_traducir(dir);
+}
+
+// Memoria virtual: 1 si la página de 'dir' está en RAM (y queda en la TLB,
+// con M marcado si 'escribe'); 0 si no está y se posteó el fallo. Una
+// dirección fuera del proceso da 1: la rechaza la instrucción misma
+int mmu_acceso(int dir, int escribe);
+
+// Arma la tabla de un proceso nuevo. Sin memoria virtual le asigna
+// 'paginas' marcos; con memoria virtual reserva y limpia su swap.
+// Retorna la base de la tabla (PTBR), o -1 si no hay lugar
+int mmu_crear_tabla(int paginas);
+
+// Copia 'cantidad' palabras (dentro de una página) a la dirección lógica
+// 'dir' de un proceso: a su marco o, si no está en RAM, a su swap (el
+// loader, antes de arrancar el DMA). Retorna la dirección física o -1
+int mmu_escribir_logica(int ptbr, int ptlr, int dir, const int *valores, int cantidad);
+
+// Devuelve los marcos de un proceso que terminó
+void mmu_liberar_tabla(int ptbr, int paginas);
+
+// Marca como ocupados una tabla que ya está en la RAM y sus marcos (al
+// restaurar un checkpoint)
+void mmu_reservar_tabla(int ptbr, int paginas);
+
+// Traducción sin TLB con una tabla cualquiera (loader, lote). -1 si no es válida
+int mmu_fisica(int ptbr, int ptlr, int dir);
+
+// Marcos de usuario sin asignar
+int mmu_marcos_libres();
+
+// INT_FALLO_PAGINA: trae la página del proceso actual que falló
+void mmu_atender_fallo();
+
+// INT_IO_FIN de 'pid': suelta los marcos que su cadena tenía tomados
+void mmu_fin_io(int pid);
+
+// Deja la TLB del núcleo vacía
+void mmu_vaciar_tlb();
+
+// Escribe en el log la tasa de aciertos de la TLB, los marcos usados y,
+// con memoria virtual, los fallos y el conjunto residente de cada proceso
+void mmu_reporte();
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <signal.h>
+
+// ====================================================
+// PERFILADOR DE LOS PROGRAMAS SIMULADOS
+// ====================================================
+// Cuenta en qué direcciones pasa el tiempo el programa invitado y al
+// terminar escribe un reporte con las más calientes y su línea del .asm.
+//   muestreo: SIGPROF cada N us de CPU anota la instrucción que ejecuta el
+//             núcleo interrumpido. El camino caliente no cambia.
+//   exacto:   cada instrucción retirada suma en su dirección, y cada PC no
+//             consecutivo es una arista entre bloques básicos.
+
+#define PERFIL_APAGADO  0
+#define PERFIL_MUESTREO 1
+#define PERFIL_EXACTO   2
+
+#define PERFIL_PERIODO_DEFECTO 1000   // us de CPU entre muestras
+#define PERFIL_TOP             20     // Renglones de cada tabla del reporte
+
+// Período del muestreo (us)
+extern int perfil_periodo_us;
+
+// 1 en modo exacto (se consulta en cada instrucción)
+extern int perfil_exacto;
+
+// 1 mientras corre el muestreo. La muestra se atribuye a cpu.MAR, que el
+// código nativo del JIT solo actualiza al salir del bloque: el motor jit
+// no usa ese nivel mientras tanto
+extern int perfil_muestreo;
+
+// Los fija ejecutar_lote. Fuera de un lote la muestra no es del programa
+// (planificador, interrupciones u ocio) y la arista no se anota
+extern __thread volatile sig_atomic_t perfil_en_lote;
+extern __thread int perfil_anterior;   // Última dirección retirada (-1 = ninguna)
+
+// Recuerda de qué archivo y línea salió cada palabra cargada (lo llama el
+// loader). 'lineas' es NULL para las imágenes binarias
+void perfil_fuente(const char *ruta, int base, int palabras, const int *lineas);
+
+// Arranca el perfil (PERFIL_MUESTREO o PERFIL_EXACTO) con reporte en 'ruta'.
+// Retorna 1 si tuvo éxito, 0 si falló
+int perfil_abrir(const char *ruta, int modo);
+
+// Suma la instrucción en 'pc' recién buscada (modo exacto)
+void perfil_retirar(int pc);
+
+// Detiene el muestreo y escribe el reporte
+void perfil_cerrar();
+
+#endif
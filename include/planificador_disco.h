@@ -0,0 +1,67 @@
+#ifndef PLANIFICADOR_DISCO_H
+#define PLANIFICADOR_DISCO_H
+
+#include <stdio.h>
+#include "disco.h"
+
+// ====================================================
+// PLANIFICADOR DE DISCO Y MODELO DE TIEMPOS
+// ====================================================
+// El brazo se mueve sobre los cilindros (la pista elige la superficie y
+// cambiarla no cuesta). Cada ráfaga paga:
+//   seek      = seek_base + seek_cilindro * |cilindros recorridos|  (0 si no se mueve)
+//   rotación  = espera hasta que el sector pedido pase bajo la cabeza
+//   lectura   = cantidad * (rotacion / sectores)
+// Los tiempos son simulados y se miden en un reloj propio del disco. En
+// modo DEMO el hilo del DMA además duerme ese tiempo (dma_tiempo_real).
+
+#define PD_FCFS  0   // Orden de llegada
+#define PD_SSTF  1   // El cilindro más cercano primero
+#define PD_SCAN  2   // Ascensor: barre hasta el borde y vuelve
+#define PD_CSCAN 3   // Barre hacia arriba y regresa al cilindro 0
+
+#define PD_SEEK_BASE_DEFECTO     3000   // us de arranque y asentamiento del brazo
+#define PD_SEEK_CILINDRO_DEFECTO 500    // us por cilindro recorrido
+#define PD_ROTACION_DEFECTO      8333   // us por vuelta (7200 RPM)
+
+typedef struct {
+    int seek_base_us;
+    int seek_cilindro_us;
+    int rotacion_us;
+} ModeloDisco_t;
+
+extern int pd_politica;
+extern ModeloDisco_t pd_modelo;
+
+// Convierte "fcfs", "sstf", "scan" o "cscan" en su política (-1 si no existe)
+int pd_politica_desde_texto(const char *texto);
+
+// Lee "BASE,CILINDRO,ROTACION" (en us) en pd_modelo. Retorna 1 si es válido
+int pd_modelo_desde_texto(const char *texto);
+
+// Brazo en el cilindro 0, reloj y estadísticas en cero
+void pd_reiniciar();
+
+// Microsegundos reales desde pd_reiniciar() (marca de llegada de una solicitud)
+long long pd_ahora_us();
+
+// Índice de la próxima solicitud a atender en cola[0..cantidad-1]
+// (se llama con la cola del DMA bloqueada)
+int pd_elegir(const SolicitudDMA_t *cola, int cantidad);
+
+// Abre / cierra la atención de una solicitud en el reloj del disco
+void pd_iniciar(const SolicitudDMA_t *s);
+void pd_terminar(const SolicitudDMA_t *s);
+
+// Mueve el brazo para una ráfaga y retorna su tiempo de servicio en us
+long long pd_servir(int cilindro, int sector, int cantidad);
+
+// Escribe en el log la latencia por solicitud y el recorrido del brazo
+void pd_reporte();
+
+// Estado del brazo, estadísticas y reloj (checkpoint).
+// Retornan 1 si tuvieron éxito, 0 si fallaron
+int pd_guardar(FILE *f);
+int pd_restaurar(FILE *f);
+
+#endif
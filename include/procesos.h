@@ -0,0 +1,117 @@
+#ifndef PROCESOS_H
+#define PROCESOS_H
+
+#include <stdio.h>
+#include "cpu.h"
+#include "disco.h"
+
+// ====================================================
+// TABLA DE PROCESOS Y PLANIFICADOR ROUND-ROBIN
+// ====================================================
+// Cada programa cargado es un proceso con su propia partición de la RAM
+// de usuario (RB..RL). El reloj (INT_RELOJ) reparte la CPU por turnos de
+// quantum_rr ticks; un proceso que enciende el DMA queda bloqueado hasta
+// su INT_IO_FIN y mientras tanto corren los demás. Con varios núcleos la
+// cola de listos es una sola y cada núcleo despacha de ella.
+
+#define MAX_PROCESOS    16
+#define RELOJ_MULTIPROGRAMACION 5   // Ciclos de timer (50 ms) si hay varios procesos
+#define QUANTUM_RR_DEFECTO      1   // Ticks de reloj por turno
+
+// Código de salida de un proceso cortado por limite_instrucciones (los
+// demás códigos son el INT_* que lo terminó: INT_SYSCALL si pidió SVC 0)
+#define SALIDA_LIMITE  -1
+
+// Estados del proceso
+#define PROC_LISTO      0
+#define PROC_EJECUTANDO 1
+#define PROC_BLOQUEADO  2
+#define PROC_TERMINADO  3
+
+// Bloque de control de proceso (PCB)
+typedef struct {
+    int pid;
+    char nombre[64];
+    int estado;
+
+    // Contexto guardado de la CPU
+    int AC;
+    int RX;
+    int SP;
+    int RB;
+    int RL;
+    int PTBR;
+    int PTLR;
+    PSW_t psw;
+
+    // Registros de configuración del DMA (cada proceso arma su transferencia)
+    DMA_t dma;
+
+    int io_pendientes;      // Solicitudes de DMA sin su INT_IO_FIN
+    int nucleo;             // Núcleo que tiene cargado su contexto (-1 = ninguno)
+    int error;              // 1 = terminó por una interrupción fatal
+    int codigo_salida;      // INT_* que lo terminó (o SALIDA_LIMITE)
+
+    // Estadísticas (ms desde el arranque)
+    double llegada;
+    double fin;
+    double espera;          // Tiempo total en la cola de listos
+    double bloqueado;       // Tiempo total esperando al DMA
+    double desde;           // Cuándo entró a su estado actual
+    unsigned long long instrucciones;
+    unsigned long long instrucciones_al_entrar; // cpu.instrucciones al recibir la CPU
+    unsigned long long fallos_pagina;           // --memoria-virtual
+    int residentes;         // Páginas en RAM ahora
+    int residentes_max;     // Conjunto residente más grande que tuvo
+} PCB_t;
+
+extern int quantum_rr;
+
+// Instrucciones que puede ejecutar cada proceso (0 = sin límite)
+extern unsigned long long limite_instrucciones;
+
+// Cantidad de procesos cargados
+extern int total_procesos;
+
+// Deja la tabla vacía y arranca el reloj de estadísticas
+void procesos_reiniciar();
+
+// Carga 'programa' en la partición 'indice' de 'particiones' y crea su PCB.
+// Retorna 1 si tuvo éxito, 0 si falló
+int procesos_crear(const char *programa, int indice, int particiones);
+
+// PID del proceso en la CPU (-1 si no hay ninguno)
+int proceso_actual();
+
+// Pone un proceso en la CPU si hace falta (turno vencido, actual bloqueado
+// o terminado). Retorna 0 si no hay ninguno listo; si además ya no queda
+// ninguno vivo apaga la máquina (maquina.ejecutando = 0)
+int procesos_despachar();
+
+// Eventos que llegan desde las instrucciones y las interrupciones
+void procesos_bloquear_actual();     // SDMAON / SDMACAD
+void procesos_terminar_actual();           // SVC 0
+void procesos_abortar_actual(int codigo);  // Interrupción fatal (INT_*) o SALIDA_LIMITE
+void procesos_tick();                // INT_RELOJ
+void procesos_io_fin(int pid);       // INT_IO_FIN
+
+// Cuántas de 'cantidad' instrucciones puede ejecutar el proceso actual
+// antes de llegar a limite_instrucciones (0 = ya llegó)
+int procesos_presupuesto(int cantidad);
+
+// PCB del proceso 'pid' (NULL si no existe)
+PCB_t *procesos_pcb(int pid);
+
+// El núcleo no tiene nada que hacer: espera una interrupción (o el
+// INT_IPI de otro núcleo que encoló un proceso listo)
+void procesos_ocioso();
+
+// Tabla, cola de listos y estado del planificador (checkpoint, un solo
+// núcleo). Retornan 1 si tuvieron éxito, 0 si fallaron
+int procesos_guardar(FILE *f);
+int procesos_restaurar(FILE *f);
+
+// Escribe en el log retorno, espera y uso de CPU por proceso
+void procesos_reporte();
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stdint.h>
+
+// ====================================================
+// TRAZA BINARIA DE EJECUCIÓN
+// ====================================================
+// Un registro de tamaño fijo por cada instrucción retirada. La lee
+// la herramienta bin/simtrace (filtros por PC/opcode y resumen).
+// Cada núcleo junta sus registros en un buffer propio y lo vuelca entero:
+// con varios núcleos el archivo trae tramos de uno y otro, cada tramo en
+// el orden en que ese núcleo retiró sus instrucciones. Cada registro dice
+// qué núcleo lo retiró, así simtrace separa los flujos.
+
+#define TRAZA_MAGICO   "SOTRAZA1"  // 8 bytes al inicio del archivo
+#define TRAZA_VERSION  2   // 2: el byte libre del registro guarda el núcleo
+
+// Cabecera del archivo
+typedef struct {
+    char magico[8];
+    uint32_t version;
+    uint32_t tamano_registro;   // sizeof(RegistroTraza_t) al escribirla
+} CabeceraTraza_t;
+
+// Sin escritura a memoria, dir_escritura vale -1
+typedef struct {
+    int32_t pc;               // Dirección de la instrucción (MAR)
+    int32_t ir;               // Palabra ejecutada
+    int32_t ac;               // AC después de ejecutarla
+    int32_t dir_escritura;    // Mem[dir] escrita por la instrucción
+    int32_t valor_escritura;  // Valor escrito
+    uint8_t cc;               // Código de condición después de ejecutarla
+    uint8_t opcode;
+    uint8_t modo;
+    uint8_t nucleo;           // Núcleo que la retiró
+} RegistroTraza_t;
+
+// 1 mientras la traza esté grabando (se consulta en cada instrucción)
+extern int traza_activa;
+
+// Crea el archivo de traza. Retorna 1 si tuvo éxito, 0 si falló
+int traza_abrir(const char *ruta);
+
+// Anota la escritura a memoria de la instrucción en curso (por hilo)
+void traza_anotar_escritura(int dir, int valor);
+
+// Graba la instrucción recién retirada por el núcleo de este hilo
+void traza_retirar(int pc, int ir, int ac, int cc, int opcode, int modo);
+
+// Vacía el buffer y cierra el archivo
+void traza_cerrar();
+
+#endif
@@ -0,0 +1,43 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "../include/arena.h"
+
+// Lo que realmente queda mapeado: páginas enteras (grandes si alcanza)
+static size_t largo_mapeo(size_t bytes) {
+    size_t pagina = (bytes >= ARENA_PAGINA_GRANDE) ? ARENA_PAGINA_GRANDE : (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + pagina - 1) / pagina * pagina;
+}
+
+void *arena_reservar(size_t bytes) {
+    size_t largo = largo_mapeo(bytes);
+    size_t extra = (largo >= ARENA_PAGINA_GRANDE) ? ARENA_PAGINA_GRANDE : 0;
+    char *mapa, *alineado;
+
+    if (bytes == 0) return NULL;
+
+    // NORESERVE: las páginas que nunca se tocan no cuentan contra la memoria del sistema
+    mapa = mmap(NULL, largo + extra, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapa == MAP_FAILED) return NULL;
+    if (extra == 0) return mapa;
+
+    // Se pide de más para poder alinear a página grande y se recorta el sobrante
+    alineado = (char *)(((uintptr_t)mapa + ARENA_PAGINA_GRANDE - 1) & ~(uintptr_t)(ARENA_PAGINA_GRANDE - 1));
+    if (alineado > mapa) munmap(mapa, alineado - mapa);
+    if (alineado + largo < mapa + largo + extra) munmap(alineado + largo, mapa + largo + extra - (alineado + largo));
+
+#ifdef MADV_HUGEPAGE
+    madvise(alineado, largo, MADV_HUGEPAGE);   // Solo una preferencia: si el kernel no puede, sigue igual
+#endif
+    return alineado;
+}
+
+void arena_limpiar(void *arena, size_t bytes) {
+    // En un mapeo privado y anónimo la próxima lectura ve una página en cero
+    if (arena != NULL) madvise(arena, largo_mapeo(bytes), MADV_DONTNEED);
+}
+
+void arena_liberar(void *arena, size_t bytes) {
+    if (arena != NULL) munmap(arena, largo_mapeo(bytes));
+}
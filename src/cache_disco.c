@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/cache_disco.h"
+#include "../include/planificador_disco.h"
+#include "../include/checkpoint.h"
+#include "../include/logger.h"
+
+int cache_capacidad = CACHE_SECTORES_DEFECTO;
+int cache_periodo_ms = CACHE_PERIODO_DEFECTO;
+
+#define NINGUNA -1
+
+typedef struct {
+    long indice;        // Sector lineal guardado en esta entrada
+    Sector_t valor;
+    int sucio;          // 1 = difiere del plato
+    int anterior;       // Lista LRU (cabeza = más reciente)
+    int siguiente;
+    int siguiente_hash; // Cadena de la cubeta
+} EntradaCache_t;
+
+static EntradaCache_t *entradas = NULL;
+static int *cubetas = NULL;
+static int mascara_hash = 0;
+static int usadas = 0;
+static int mas_reciente = NINGUNA, menos_reciente = NINGUNA;
+
+static atomic_int sucios = 0;
+
+// Estadísticas
+static unsigned long long aciertos = 0, fallos = 0;
+static unsigned long long desalojos = 0, desalojos_sucios = 0, vaciados = 0;
+
+int cache_iniciar() {
+    int cubetas_total = 1;
+
+    if (cache_capacidad <= 0) return 1; // Sin caché: todo va al plato
+
+    // Potencia de dos con al menos dos cubetas por entrada
+    while (cubetas_total < cache_capacidad * 2) cubetas_total <<= 1;
+
+    entradas = calloc(cache_capacidad, sizeof(EntradaCache_t));
+    cubetas = malloc(cubetas_total * sizeof(int));
+    if (entradas == NULL || cubetas == NULL) {
+        LOG_ERROR("[CACHE] Error: No hay memoria para %d sectores\n", cache_capacidad);
+        cache_liberar();
+        return 0;
+    }
+    for (int i = 0; i < cubetas_total; i++) cubetas[i] = NINGUNA;
+    mascara_hash = cubetas_total - 1;
+    usadas = 0;
+    mas_reciente = menos_reciente = NINGUNA;
+    atomic_store(&sucios, 0);
+    aciertos = fallos = desalojos = desalojos_sucios = vaciados = 0;
+
+    logger_log("[CACHE] Cache de sectores: %d entradas, vaciado cada %d ms\n",
+        cache_capacidad, cache_periodo_ms);
+    return 1;
+}
+
+void cache_liberar() {
+    free(entradas);
+    free(cubetas);
+    entradas = NULL;
+    cubetas = NULL;
+}
+
+int cache_sucios() {
+    return atomic_load_explicit(&sucios, memory_order_relaxed);
+}
+
+static int hash(long indice) {
+    // Multiplicativo de Knuth: sectores vecinos caen en cubetas distintas
+    return (int)(((unsigned long)indice * 2654435761UL) >> 7) & mascara_hash;
+}
+
+// --- ACCESO DIRECTO AL PLATO (paga el modelo mecánico) ---
+static long long plato_leer(long primero, Sector_t *valores, int cantidad) {
+    for (int i = 0; i < cantidad; i++) valores[i] = disco.plato[primero + i];
+    return pd_servir((primero / disco.sectores) % disco.cilindros,
+                     primero % disco.sectores, cantidad);
+}
+
+static long long plato_escribir(long primero, const Sector_t *valores, int cantidad) {
+    for (int i = 0; i < cantidad; i++) disco.plato[primero + i] = valores[i];
+    checkpoint_marcar_disco(primero, cantidad);
+    return pd_servir((primero / disco.sectores) % disco.cilindros,
+                     primero % disco.sectores, cantidad);
+}
+
+// --- LISTA LRU ---
+static void desenlazar(int e) {
+    EntradaCache_t *x = &entradas[e];
+
+    if (x->anterior != NINGUNA) entradas[x->anterior].siguiente = x->siguiente;
+    else mas_reciente = x->siguiente;
+    if (x->siguiente != NINGUNA) entradas[x->siguiente].anterior = x->anterior;
+    else menos_reciente = x->anterior;
+}
+
+static void al_frente(int e) {
+    entradas[e].anterior = NINGUNA;
+    entradas[e].siguiente = mas_reciente;
+    if (mas_reciente != NINGUNA) entradas[mas_reciente].anterior = e;
+    mas_reciente = e;
+    if (menos_reciente == NINGUNA) menos_reciente = e;
+}
+
+// --- TABLA HASH ---
+static int buscar(long indice) {
+    for (int e = cubetas[hash(indice)]; e != NINGUNA; e = entradas[e].siguiente_hash) {
+        if (entradas[e].indice == indice) return e;
+    }
+    return NINGUNA;
+}
+
+static void quitar_de_hash(int e) {
+    int *enlace = &cubetas[hash(entradas[e].indice)];
+
+    while (*enlace != e) enlace = &entradas[*enlace].siguiente_hash;
+    *enlace = entradas[e].siguiente_hash;
+}
+
+// Entrada libre para 'indice': una sin usar o la menos reciente. Un
+// desalojo sucio se escribe en el plato y suma su tiempo a *tiempo.
+static int reservar(long indice, long long *tiempo) {
+    int e;
+
+    if (usadas < cache_capacidad) {
+        e = usadas++;
+    } else {
+        e = menos_reciente;
+        desenlazar(e);
+        quitar_de_hash(e);
+        desalojos++;
+        if (entradas[e].sucio) {
+            *tiempo += plato_escribir(entradas[e].indice, &entradas[e].valor, 1);
+            atomic_fetch_sub_explicit(&sucios, 1, memory_order_relaxed);
+            desalojos_sucios++;
+        }
+    }
+
+    entradas[e].indice = indice;
+    entradas[e].sucio = 0;
+    entradas[e].siguiente_hash = cubetas[hash(indice)];
+    cubetas[hash(indice)] = e;
+    al_frente(e);
+    return e;
+}
+
+long long cache_leer(long primero, Sector_t *valores, int cantidad) {
+    long long tiempo = 0;
+    int i = 0;
+
+    if (entradas == NULL) return plato_leer(primero, valores, cantidad);
+
+    while (i < cantidad) {
+        int e = buscar(primero + i);
+        int tramo = 0;
+
+        if (e != NINGUNA) { // Acierto: sin demora mecánica
+            valores[i] = entradas[e].valor;
+            desenlazar(e);
+            al_frente(e);
+            aciertos++;
+            i++;
+            continue;
+        }
+
+        // Los fallos consecutivos se leen del plato en una sola ráfaga
+        while (i + tramo < cantidad && buscar(primero + i + tramo) == NINGUNA) tramo++;
+        tiempo += plato_leer(primero + i, &valores[i], tramo);
+        for (int k = 0; k < tramo; k++) {
+            e = reservar(primero + i + k, &tiempo);
+            entradas[e].valor = valores[i + k];
+        }
+        fallos += tramo;
+        i += tramo;
+    }
+    return tiempo;
+}
+
+long long cache_escribir(long primero, const Sector_t *valores, int cantidad) {
+    long long tiempo = 0;
+
+    if (entradas == NULL) return plato_escribir(primero, valores, cantidad);
+
+    // Escritura diferida: el sector completo se reemplaza, no hace falta leerlo
+    for (int i = 0; i < cantidad; i++) {
+        int e = buscar(primero + i);
+
+        if (e != NINGUNA) {
+            desenlazar(e);
+            al_frente(e);
+            aciertos++;
+        } else {
+            e = reservar(primero + i, &tiempo);
+            fallos++;
+        }
+        entradas[e].valor = valores[i];
+        if (!entradas[e].sucio) {
+            entradas[e].sucio = 1;
+            atomic_fetch_add_explicit(&sucios, 1, memory_order_relaxed);
+        }
+    }
+    return tiempo;
+}
+
+static int comparar_indices(const void *a, const void *b) {
+    long x = entradas[*(const int *)a].indice, y = entradas[*(const int *)b].indice;
+    return (x > y) - (x < y);
+}
+
+long long cache_vaciar() {
+    long long tiempo = 0;
+    int *orden, total = 0;
+
+    if (entradas == NULL || cache_sucios() == 0) return 0;
+
+    orden = malloc(usadas * sizeof(int));
+    if (orden == NULL) return 0;
+    for (int e = 0; e < usadas; e++) {
+        if (entradas[e].sucio) orden[total++] = e;
+    }
+
+    // En orden de disco, agrupando sectores contiguos en una sola ráfaga
+    qsort(orden, total, sizeof(int), comparar_indices);
+    for (int i = 0; i < total; ) {
+        int tramo = 1;
+        Sector_t valores[64];
+
+        valores[0] = entradas[orden[i]].valor;
+        while (i + tramo < total && tramo < 64 &&
+               entradas[orden[i + tramo]].indice == entradas[orden[i]].indice + tramo) {
+            valores[tramo] = entradas[orden[i + tramo]].valor;
+            tramo++;
+        }
+        tiempo += plato_escribir(entradas[orden[i]].indice, valores, tramo);
+        for (int k = 0; k < tramo; k++) entradas[orden[i + k]].sucio = 0;
+        i += tramo;
+    }
+
+    atomic_fetch_sub_explicit(&sucios, total, memory_order_relaxed);
+    vaciados += total;
+    free(orden);
+
+    LOG_DEBUG("[CACHE] Vaciado: %d sectores sucios al plato (%lld us)\n", total, tiempo);
+    return tiempo;
+}
+
+void cache_reporte() {
+    unsigned long long accesos = aciertos + fallos;
+
+    if (entradas == NULL || accesos == 0) return;
+
+    logger_log("[CACHE] %llu accesos: %llu aciertos (%.1f%%), %llu fallos\n",
+        accesos, aciertos, 100.0 * aciertos / accesos, fallos);
+    logger_log("[CACHE] %llu desalojos (%llu sucios), %llu sectores escritos por el vaciado\n",
+        desalojos, desalojos_sucios, vaciados);
+}
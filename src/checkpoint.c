@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/checkpoint.h"
+#include "../include/cpu.h"
+#include "../include/disco.h"
+#include "../include/procesos.h"
+#include "../include/planificador_disco.h"
+#include "../include/logger.h"
+#include "../include/mmu.h"
+#include "../include/arena.h"
+
+unsigned long long checkpoint_cada = CHECKPOINT_CADA_DEFECTO;
+unsigned char *checkpoint_memoria_sucia = NULL;
+static long bloques_memoria = 0;
+
+// Solo existe mientras se graban fotos: sin checkpoint marcar el disco no cuesta nada
+static unsigned char *disco_sucio = NULL;
+static long bloques_disco = 0;
+
+static FILE *archivo = NULL;
+static uint32_t numero_foto = 0;
+static unsigned long long proxima = 0;   // cpu.instrucciones de la próxima foto
+
+void checkpoint_marcar_disco(long primero, int cantidad) {
+    if (disco_sucio == NULL || cantidad <= 0) return;
+    for (long b = primero / BLOQUE_DISCO; b <= (primero + cantidad - 1) / BLOQUE_DISCO; b++) {
+        disco_sucio[b] = 1;
+    }
+}
+
+int checkpoint_reservar(int palabras) {
+    arena_liberar(checkpoint_memoria_sucia, bloques_memoria);
+    bloques_memoria = (palabras + BLOQUE_MEMORIA - 1) / BLOQUE_MEMORIA;
+    checkpoint_memoria_sucia = arena_reservar(bloques_memoria);
+    return checkpoint_memoria_sucia != NULL;
+}
+
+// Palabras del bloque 'b' (el último puede quedar corto)
+static int largo_memoria(long b) {
+    long resto = maquina.tamano_memoria - b * BLOQUE_MEMORIA;
+    return (int)(resto < BLOQUE_MEMORIA ? resto : BLOQUE_MEMORIA);
+}
+
+static int memoria_en_cero(long b) {
+    const int *m = &maquina.memoria[b * BLOQUE_MEMORIA];
+
+    for (int i = 0; i < largo_memoria(b); i++) {
+        if (m[i] != 0) return 0;
+    }
+    return 1;
+}
+
+static int largo_disco(long b) {
+    long resto = disco.total_sectores - b * BLOQUE_DISCO;
+    return (int)(resto < BLOQUE_DISCO ? resto : BLOQUE_DISCO);
+}
+
+static int disco_en_cero(long b) {
+    const Sector_t *s = &disco.plato[b * BLOQUE_DISCO];
+
+    for (int i = 0; i < largo_disco(b); i++) {
+        if (s[i] != 0) return 0;
+    }
+    return 1;
+}
+
+static void limpiar_marcas() {
+    memset(checkpoint_memoria_sucia, 0, bloques_memoria);
+    if (disco_sucio != NULL) memset(disco_sucio, 0, bloques_disco);
+}
+
+int checkpoint_abrir(const char *ruta) {
+    CabeceraCheckpoint_t c;
+
+    archivo = fopen(ruta, "wb");
+    if (archivo == NULL) {
+        perror("[ERROR] No se pudo crear el checkpoint");
+        return 0;
+    }
+
+    memset(&c, 0, sizeof(c));
+    memcpy(c.magico, CHECKPOINT_MAGICO, sizeof(c.magico));
+    c.version = CHECKPOINT_VERSION;
+    c.tamano_cpu = sizeof(CPU_t);
+    c.tamano_pcb = sizeof(PCB_t);
+    c.tamano_memoria = maquina.tamano_memoria;
+    c.pistas = disco.pistas;
+    c.cilindros = disco.cilindros;
+    c.sectores = disco.sectores;
+    if (fwrite(&c, sizeof(c), 1, archivo) != 1) {
+        perror("[ERROR] No se pudo escribir el checkpoint");
+        fclose(archivo);
+        archivo = NULL;
+        return 0;
+    }
+
+    bloques_disco = (disco.total_sectores + BLOQUE_DISCO - 1) / BLOQUE_DISCO;
+    disco_sucio = calloc(bloques_disco, 1);
+    numero_foto = 0;
+    proxima = cpu.instrucciones;   // La foto completa se toma al arrancar
+    return disco_sucio != NULL;
+}
+
+int checkpoint_toca() {
+    return archivo != NULL && cpu.instrucciones >= proxima;
+}
+
+int checkpoint_recortar(int cantidad) {
+    if (archivo != NULL && proxima - cpu.instrucciones < (unsigned long long)cantidad) {
+        return (int)(proxima - cpu.instrucciones);
+    }
+    return cantidad;
+}
+
+// Registros, DMA, timer, procesos y brazo del disco
+static int guardar_estado(FILE *f) {
+    int periodo = atomic_load_explicit(&maquina.timer_periodo, memory_order_relaxed);
+    int estado = atomic_load_explicit(&dma_controlador.estado, memory_order_acquire);
+
+    return fwrite(&cpu, sizeof(cpu), 1, f) == 1 &&
+           fwrite(&dma, sizeof(dma), 1, f) == 1 &&
+           fwrite(&estado, sizeof(estado), 1, f) == 1 &&
+           fwrite(&periodo, sizeof(periodo), 1, f) == 1 &&
+           procesos_guardar(f) &&
+           pd_guardar(f);
+}
+
+static int restaurar_estado(FILE *f) {
+    int periodo, estado;
+
+    if (fread(&cpu, sizeof(cpu), 1, f) != 1 ||
+        fread(&dma, sizeof(dma), 1, f) != 1 ||
+        fread(&estado, sizeof(estado), 1, f) != 1 ||
+        fread(&periodo, sizeof(periodo), 1, f) != 1) {
+        return 0;
+    }
+    // La cola del DMA estaba vacía al tomar la foto: el controlador queda inactivo
+    atomic_store_explicit(&dma_controlador.estado, estado, memory_order_relaxed);
+    atomic_store_explicit(&maquina.timer_periodo, periodo, memory_order_relaxed);
+    return procesos_restaurar(f) && pd_restaurar(f);
+}
+
+int checkpoint_tomar() {
+    FotoCheckpoint_t foto;
+    int completa = (numero_foto == 0);
+    long desde = ftell(archivo);
+    int exito;
+
+    memset(&foto, 0, sizeof(foto));
+    foto.numero = numero_foto;
+    foto.instrucciones = cpu.instrucciones;
+    for (long b = 0; b < bloques_memoria; b++) {
+        // Como en el disco, la completa lleva lo que no esté en cero
+        if (completa) checkpoint_memoria_sucia[b] = !memoria_en_cero(b);
+        if (checkpoint_memoria_sucia[b]) foto.bloques_memoria++;
+    }
+    for (long b = 0; b < bloques_disco; b++) {
+        // Marcadas con checkpoint_marcar_disco; la completa lleva lo que no esté en cero
+        if (completa ? !disco_en_cero(b) : disco_sucio[b]) {
+            disco_sucio[b] = 1;
+            foto.bloques_disco++;
+        }
+    }
+
+    exito = fwrite(&foto, sizeof(foto), 1, archivo) == 1 && guardar_estado(archivo);
+    for (uint32_t b = 0; exito && b < bloques_memoria; b++) {
+        if (!checkpoint_memoria_sucia[b]) continue;
+        exito = fwrite(&b, sizeof(b), 1, archivo) == 1 &&
+                fwrite(&maquina.memoria[b * BLOQUE_MEMORIA], sizeof(int), largo_memoria(b), archivo) ==
+                    (size_t)largo_memoria(b);
+    }
+    for (uint32_t b = 0; exito && b < bloques_disco; b++) {
+        if (!disco_sucio[b]) continue;
+        exito = fwrite(&b, sizeof(b), 1, archivo) == 1 &&
+                fwrite(&disco.plato[(long)b * BLOQUE_DISCO], TAMANO_SECTOR, largo_disco(b), archivo) ==
+                    (size_t)largo_disco(b);
+    }
+    if (!exito || fflush(archivo) != 0) {
+        LOG_ERROR("[ERROR] No se pudo escribir la foto %u del checkpoint.\n", numero_foto);
+        checkpoint_cerrar();
+        return 0;
+    }
+
+    logger_log("[CHECKPOINT] Foto %u (%s) en la instruccion %llu: %u bloques de RAM, %u de disco, %ld bytes\n",
+        foto.numero, completa ? "completa" : "incremental", foto.instrucciones,
+        foto.bloques_memoria, foto.bloques_disco, ftell(archivo) - desde);
+
+    limpiar_marcas();
+    numero_foto++;
+    proxima = cpu.instrucciones + checkpoint_cada;
+    return 1;
+}
+
+void checkpoint_cerrar() {
+    if (archivo != NULL) fclose(archivo);
+    archivo = NULL;
+    free(disco_sucio);
+    disco_sucio = NULL;
+}
+
+// --- RESTAURACIÓN ---
+
+// Abre el archivo y valida su cabecera. Retorna NULL si no sirve
+static FILE *abrir_para_leer(const char *ruta, CabeceraCheckpoint_t *c) {
+    FILE *f = fopen(ruta, "rb");
+
+    if (f == NULL) {
+        perror("[ERROR] No se pudo abrir el checkpoint");
+        return NULL;
+    }
+    if (fread(c, sizeof(*c), 1, f) != 1 || memcmp(c->magico, CHECKPOINT_MAGICO, sizeof(c->magico)) != 0) {
+        LOG_ERROR("[ERROR] %s no es un checkpoint.\n", ruta);
+        fclose(f);
+        return NULL;
+    }
+    if (c->version != CHECKPOINT_VERSION || c->tamano_cpu != sizeof(CPU_t) ||
+        c->tamano_pcb != sizeof(PCB_t)) {
+        LOG_ERROR("[ERROR] %s fue grabado por otra version del simulador.\n", ruta);
+        fclose(f);
+        return NULL;
+    }
+
+    return f;
+}
+
+int checkpoint_leer_geometria(const char *ruta, int *pistas, int *cilindros, int *sectores, int *palabras) {
+    CabeceraCheckpoint_t c;
+    FILE *f = abrir_para_leer(ruta, &c);
+
+    if (f == NULL) return 0;
+    *palabras = c.tamano_memoria;
+    *pistas = c.pistas;
+    *cilindros = c.cilindros;
+    *sectores = c.sectores;
+    fclose(f);
+    return 1;
+}
+
+// Aplica los bloques de una foto ya leída su cabecera y su estado
+static int aplicar_bloques(FILE *f, const FotoCheckpoint_t *foto) {
+    int valores[BLOQUE_MEMORIA];
+    uint32_t b;
+
+    // La completa parte de una RAM en cero: se limpia lo que no traiga
+    if (foto->numero == 0) {
+        memset(valores, 0, sizeof(valores));
+        for (long m = 0; m < bloques_memoria; m++) {
+            if (!memoria_en_cero(m)) escribir_bloque(m * BLOQUE_MEMORIA, valores, largo_memoria(m));
+        }
+    }
+    for (uint32_t i = 0; i < foto->bloques_memoria; i++) {
+        if (fread(&b, sizeof(b), 1, f) != 1 || b >= bloques_memoria ||
+            fread(valores, sizeof(int), largo_memoria(b), f) != (size_t)largo_memoria(b)) {
+            return 0;
+        }
+        escribir_bloque(b * BLOQUE_MEMORIA, valores, largo_memoria(b));
+    }
+
+    // La completa parte de un disco en cero: se limpia lo que no traiga
+    if (foto->numero == 0) {
+        for (long d = 0; d < (disco.total_sectores + BLOQUE_DISCO - 1) / BLOQUE_DISCO; d++) {
+            if (!disco_en_cero(d)) memset(&disco.plato[d * BLOQUE_DISCO], 0, largo_disco(d) * TAMANO_SECTOR);
+        }
+    }
+    for (uint32_t i = 0; i < foto->bloques_disco; i++) {
+        if (fread(&b, sizeof(b), 1, f) != 1 || (long)b * BLOQUE_DISCO >= disco.total_sectores ||
+            fread(&disco.plato[(long)b * BLOQUE_DISCO], TAMANO_SECTOR, largo_disco(b), f) !=
+                (size_t)largo_disco(b)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int checkpoint_restaurar(const char *ruta, int fotos) {
+    CabeceraCheckpoint_t c;
+    FotoCheckpoint_t foto;
+    FILE *f = abrir_para_leer(ruta, &c);
+    uint32_t aplicadas = 0;
+
+    if (f == NULL) return 0;
+    if ((int)c.pistas != disco.pistas || (int)c.cilindros != disco.cilindros ||
+        (int)c.sectores != disco.sectores) {
+        LOG_ERROR("[ERROR] El checkpoint es de un disco %ux%ux%u y el actual es %dx%dx%d.\n",
+            c.pistas, c.cilindros, c.sectores, disco.pistas, disco.cilindros, disco.sectores);
+        fclose(f);
+        return 0;
+    }
+    if ((int)c.tamano_memoria != maquina.tamano_memoria) {
+        LOG_ERROR("[ERROR] El checkpoint es de una RAM de %u palabras y la actual tiene %d.\n",
+            c.tamano_memoria, maquina.tamano_memoria);
+        fclose(f);
+        return 0;
+    }
+
+    // Foto completa y luego los incrementos, en orden, hasta 'fotos'
+    while ((fotos == 0 || aplicadas < (uint32_t)fotos) && fread(&foto, sizeof(foto), 1, f) == 1) {
+        if (foto.numero != aplicadas || !restaurar_estado(f) || !aplicar_bloques(f, &foto)) {
+            LOG_ERROR("[ERROR] %s: la foto %u esta danada.\n", ruta, aplicadas);
+            fclose(f);
+            return 0;
+        }
+        aplicadas++;
+    }
+    fclose(f);
+
+    if (aplicadas == 0 || (fotos > 0 && aplicadas < (uint32_t)fotos)) {
+        LOG_ERROR("[ERROR] %s: tiene %u foto(s).\n", ruta, aplicadas);
+        return 0;
+    }
+
+    // Las tablas de páginas volvieron con la RAM: sus marcos siguen ocupados
+    for (int pid = 1; paginacion && pid <= total_procesos; pid++) {
+        mmu_reservar_tabla(procesos_pcb(pid)->PTBR, procesos_pcb(pid)->PTLR);
+    }
+
+    limpiar_marcas();
+    logger_log("[CHECKPOINT] Restaurada la foto %u de %s (instruccion %llu, %d procesos)\n",
+        aplicadas - 1, ruta, cpu.instrucciones, total_procesos);
+    return 1;
+}
@@ -2,19 +2,81 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
 #include "../include/cpu.h" 
 #include "../include/constantes.h"
 #include "../include/logger.h"
 #include "../include/disco.h"
-#define MAX_VALOR 99999999
-#define MIN_VALOR -99999999
+#include "../include/traza.h"
+#include "../include/interrupciones.h"
+#include "../include/procesos.h"
+#include "../include/checkpoint.h"
+#include "../include/cache_disco.h"
+#include "../include/estadisticas.h"
+#include "../include/perfil.h"
+#include "../include/mmu.h"
+#include "../include/arena.h"
+
+// 1. Instanciamos la máquina compartida y los registros de cada núcleo
+// (uno por hilo)
+Maquina_t maquina;
+__thread CPU_t cpu;
+
+// Caché de instrucciones ya decodificadas (paralela a maquina.memoria)
+Decodificada_t *cache_decodificada = NULL;
+
+// Palabras que tienen reservadas las dos arenas de arriba
+static int reservadas = 0;
+
+// Motor de ejecución elegido al arrancar
+int motor_cpu = MOTOR_CLASICO;
+
+// Modo de ejecución (DEMO = paso a paso visible, TURBO = sin frenos)
+int modo_ejecucion = MODO_DEMO;
+int quantum_turbo = QUANTUM_TURBO_DEFECTO;
+unsigned long long instrucciones_totales = 0;
+double ms_ejecucion = 0;
+
+int inicializar_cpu() {
+    if (maquina.tamano_memoria <= 0) maquina.tamano_memoria = TAMANO_MEMORIA;
+    if (maquina.nucleos < 1) maquina.nucleos = 1;
+
+    // Limpiar toda la memoria a 0 sin recorrerla: las arenas devuelven sus
+    // páginas y el kernel las repone en cero cuando se vuelven a tocar.
+    // La caché en cero también vale: cada entrada se decodifica al usarla
+    if (reservadas == maquina.tamano_memoria) {
+        arena_limpiar(maquina.memoria, (size_t)reservadas * sizeof(int));
+        arena_limpiar(cache_decodificada, (size_t)reservadas * sizeof(Decodificada_t));
+    } else {
+        arena_liberar(maquina.memoria, (size_t)reservadas * sizeof(int));
+        arena_liberar(cache_decodificada, (size_t)reservadas * sizeof(Decodificada_t));
+        reservadas = maquina.tamano_memoria;
+        maquina.memoria = arena_reservar((size_t)reservadas * sizeof(int));
+        cache_decodificada = arena_reservar((size_t)reservadas * sizeof(Decodificada_t));
+        if (maquina.memoria == NULL || cache_decodificada == NULL) {
+            LOG_ERROR("[ERROR] No se pudo reservar una memoria de %d palabras\n", reservadas);
+            return 0;
+        }
+    }
+    if (!bloques_reservar(maquina.tamano_memoria) || !checkpoint_reservar(maquina.tamano_memoria)) {
+        LOG_ERROR("[ERROR] No se pudieron reservar las tablas de %d palabras\n", maquina.tamano_memoria);
+        return 0;
+    }
+
+    // Bandera para el bucle principal
+    atomic_store(&maquina.ejecutando, 1);
 
-// 1. Instanciamos la variable global real (La máquina)
-CPU_t cpu;
+    inicializar_nucleo(0);
 
-void inicializar_cpu() {
-    // Limpiar toda la memoria y registros a 0
+    logger_log("[INFO] CPU Inicializada. Modo Kernel. Memoria limpia (0-%d). %d nucleo(s).\n",
+        maquina.tamano_memoria - 1, maquina.nucleos);
+    return 1;
+}
+
+void inicializar_nucleo(int nucleo) {
+    // Registros a 0
     memset(&cpu, 0, sizeof(CPU_t));
+    cpu.nucleo = nucleo;
 
     // Configuración inicial según PDF
     cpu.psw.modo_operacion = 1;      // Arranca en modo Kernel (1)
@@ -30,31 +92,41 @@ void inicializar_cpu() {
     
     // Inicializar registros de protección (Todo el espacio de usuario)
     cpu.RB = INICIO_USUARIO;
-    cpu.RL = TAMANO_MEMORIA - 1;
+    cpu.RL = maquina.tamano_memoria - 1;
     cpu.SP = cpu.RL - cpu.RB;
-    
-    // Bandera para el bucle principal
-    cpu.ejecutando = 1;
 
-    logger_log("[INFO] CPU Inicializada. Modo Kernel. Memoria limpia (0-1999).\n");
+    // Sin tabla de páginas hasta que se despache un proceso paginado
+    cpu.PTBR = -1;
+    cpu.PTLR = 0;
 }
 
 void dump_cpu() {
     // Esta función nos servirá para ver qué pasa dentro (Debugger)
-    logger_log("\n=== ESTADO CPU ===\n");
-    logger_log("PC: %04d | IR: %08d | AC: %08d\n", cpu.psw.pc, cpu.IR, cpu.AC);
-    logger_log("MAR: %04d | MDR: %08d\n", cpu.MAR, cpu.MDR);
-    logger_log("PSW: CC=%d Mode=%d Int=%d\n", 
+    if (LOG_NIVEL_DEBUG < logger_nivel) return; // Nivel DEBUG apagado: ni formatear
+    LOG_DEBUG("\n=== ESTADO CPU %d ===\n", cpu.nucleo);
+    LOG_DEBUG("PC: %04d | IR: %08d | AC: %08d\n", cpu.psw.pc, cpu.IR, cpu.AC);
+    LOG_DEBUG("MAR: %04d | MDR: %08d\n", cpu.MAR, cpu.MDR);
+    LOG_DEBUG("PSW: CC=%d Mode=%d Int=%d\n", 
            cpu.psw.codigo_condicion, cpu.psw.modo_operacion, cpu.psw.interrupciones);
-    logger_log("Stack: SP=%d RX=%d\n", cpu.SP, cpu.RX);
+    LOG_DEBUG("Stack: SP=%d RX=%d\n", cpu.SP, cpu.RX);
     // Agregamos RB (Base) y RL (Limite) para ver la "cancha" de memoria
-    logger_log("Stack: SP=%d | RB=%d | RL=%d\n", cpu.SP, cpu.RB, cpu.RL);
-    logger_log("==================\n");
+    LOG_DEBUG("Stack: SP=%d | RB=%d | RL=%d\n", cpu.SP, cpu.RB, cpu.RL);
+    LOG_DEBUG("DMA: ESTADOdma=%d Activo=%d\n",
+           atomic_load_explicit(&dma_controlador.estado, memory_order_acquire),
+           atomic_load_explicit(&dma_controlador.activo, memory_order_relaxed));
+    LOG_DEBUG("==================\n");
 }
 
 // Valida si una dirección física es legal para el proceso actual
 // Retorna 1 si es válida, 0 si es ilegal (y dispara interrupción)
 int validar_direccion(int dir_fisica) {
+    // Ni el Modo Kernel puede salirse de la RAM física
+    if (dir_fisica < 0 || dir_fisica >= maquina.tamano_memoria) {
+        LOG_ERROR("[INT] Direccion %d fuera de la memoria fisica\n", dir_fisica);
+        ESTAD_SUMAR(&contadores->fallas_proteccion, 1);
+        return 0;
+    }
+
     // Si estamos en Modo Kernel (1), todo está permitido
     if (cpu.psw.modo_operacion == 1) {
         return 1;
@@ -62,8 +134,9 @@ int validar_direccion(int dir_fisica) {
 
     // En Modo Usuario (0), verificamos los límites
     if (dir_fisica < cpu.RB || dir_fisica > cpu.RL) {
-        logger_log("[INT] Violacion de segmento: Dir %d fuera de rango (%d-%d)\n", 
+        LOG_ERROR("[INT] Violacion de segmento: Dir %d fuera de rango (%d-%d)\n", 
                dir_fisica, cpu.RB, cpu.RL);
+        ESTAD_SUMAR(&contadores->fallas_proteccion, 1);
         // Aquí deberíamos disparar la interrupción INT_DIR_INVALIDA
         return 0;
     }
@@ -83,10 +156,10 @@ int obtener_valor_operando(int modo, int operando) {
             break;
             
         case DIR_DIRECTO: // Modo 0
-            // Calculamos dirección física
-            direccion_final = operando + cpu.RB; 
-            if (validar_direccion(direccion_final)) {
-                valor = cpu.memoria[direccion_final];
+            // Calculamos dirección física (con paginación la traduce la MMU)
+            direccion_final = traducir_direccion(operando + cpu.RB);
+            if (direccion_final >= 0) {
+                valor = maquina.memoria[direccion_final];
             }
             break;
             
@@ -96,602 +169,841 @@ int obtener_valor_operando(int modo, int operando) {
             // PERO también existen registros RX. Usualmente Indexado es con RX.
             // Asumamos RX por lógica común, o AC si somos estrictos con el texto "a partir del acumulador".
             // Vamos a usar RX que es lo estándar para índices:
-            direccion_final = operando + cpu.RX + cpu.RB;
-             if (validar_direccion(direccion_final)) {
-                valor = cpu.memoria[direccion_final];
+            direccion_final = traducir_direccion(operando + cpu.RX + cpu.RB);
+            if (direccion_final >= 0) {
+                valor = maquina.memoria[direccion_final];
             }
             break;
     }
     return valor;
 }
 
+// Postea una interrupción de la CPU en el controlador (la atiende
+// ejecutar_cpu) y corta el lote actual para que se atienda antes de seguir.
+void lanzar_interrupcion(int codigo) {
+    ic_postear(codigo);
+    cpu.corte_quantum = 1;
+}
+
+// Actualiza el código de condición según el valor actual de AC
+void actualizar_codigo_condicion() {
+    if (cpu.AC == 0) cpu.psw.codigo_condicion = 0;
+    else if (cpu.AC < 0) cpu.psw.codigo_condicion = 1;
+    else cpu.psw.codigo_condicion = 2;
+}
+
+// Guarda en AC el resultado de una operación aritmética.
+// Si se sale del rango de 8 dígitos dispara Overflow/Underflow (CC=3).
+void guardar_resultado(long long resultado_temp) {
+    if (resultado_temp > MAX_VALOR) {
+        lanzar_interrupcion(INT_OVERFLOW);
+        cpu.psw.codigo_condicion = 3;
+    } else if (resultado_temp < MIN_VALOR) {
+        lanzar_interrupcion(INT_UNDERFLOW);
+        cpu.psw.codigo_condicion = 3;
+    } else {
+        cpu.AC = (int)resultado_temp;
+        actualizar_codigo_condicion();
+    }
+}
+
+// Calcula la dirección física destino de un Store (STR/STRRX).
+// Retorna -1 si el modo no tiene sentido para guardar (Inmediato)
+// o si la dirección es ilegal.
+static int direccion_destino(int modo, int operando) {
+    if (modo == DIR_DIRECTO) {
+        return traducir_direccion(operando + cpu.RB);
+    } else if (modo == DIR_INDEXADO) {
+        return traducir_direccion(operando + cpu.RB + cpu.RX);
+    }
+    return -1;
+}
+
+// La pila ya se validó contra RB..RL (SP) y sin paginación es física.
+// Con paginación SP es lógico y lo traduce la MMU (con memoria virtual
+// operando_presente ya trajo la página). RB y RL los puede mover el
+// kernel, así que igual se acota a la RAM: retorna -1 si cae afuera
+static inline int dir_pila(int dir) {
+    if (paginacion) dir = mmu_traducir(dir);
+    return (dir >= 0 && dir < maquina.tamano_memoria) ? dir : -1;
+}
+
+// Memoria virtual: una instrucción no puede quedar a medias, así que antes
+// de ejecutarla se pide la página del dato que va a tocar. Retorna 0 si
+// falta (INT_FALLO_PAGINA posteada: el PC no avanza y se reintenta)
+static int operando_presente(const Decodificada_t *inst) {
+    int dir;
+
+    switch (inst->opcode) {
+        case OP_SUM: case OP_RES: case OP_MULT: case OP_DIVI:
+        case OP_LOAD: case OP_LOADRX: case OP_COMP:
+        case OP_STR: case OP_STRRX:
+            if (inst->modo == DIR_DIRECTO) dir = inst->operando + cpu.RB;
+            else if (inst->modo == DIR_INDEXADO) dir = inst->operando + cpu.RB + cpu.RX;
+            else return 1;
+            return mmu_acceso(dir, inst->opcode == OP_STR || inst->opcode == OP_STRRX);
+        case OP_PSH:
+            return cpu.SP < 0 ? 1 : mmu_acceso(cpu.RB + cpu.SP, 1);
+        case OP_POP: case OP_RETRN:
+            return cpu.SP >= cpu.RL - cpu.RB ? 1 : mmu_acceso(cpu.RB + cpu.SP + 1, 0);
+    }
+    return 1;
+}
+
+// ====================================================
+// MANEJADORES DE INSTRUCCIONES (Etapa EXECUTE)
+// ====================================================
+// Cada opcode tiene su rutina. La caché de decodificación guarda
+// un puntero a la rutina correspondiente, así paso_cpu no necesita
+// volver a preguntar "¿qué instrucción es?" en cada ciclo.
+
+// --- ARITMÉTICA CON DETECCIÓN DE DESBORDAMIENTO (CC=3) ---
+
+static void ejecutar_sum(int modo, int operando) { // 00 - Sumar
+    // Lógica: AC = AC + Valor
+    int val = obtener_valor_operando(modo, operando);
+    guardar_resultado((long long)cpu.AC + val); // Usamos long long para ver si se pasa
+}
+
+static void ejecutar_res(int modo, int operando) { // 01 - Restar
+    // Lógica: AC = AC - Valor
+    int val = obtener_valor_operando(modo, operando);
+    guardar_resultado((long long)cpu.AC - val);
+}
+
+static void ejecutar_mult(int modo, int operando) { // 02 - Multiplicar
+    // Lógica: AC = AC * Valor
+    int val = obtener_valor_operando(modo, operando);
+    guardar_resultado((long long)cpu.AC * val);
+}
+
+static void ejecutar_divi(int modo, int operando) { // 03 - Dividir
+    // Lógica: AC = AC / Valor
+    int val = obtener_valor_operando(modo, operando);
+    if (val != 0) {
+        cpu.AC /= val;
+        actualizar_codigo_condicion();
+    } else {
+        cpu.psw.codigo_condicion = 3; // Podemos usar el 3 también para Error Matemático
+        lanzar_interrupcion(INT_OVERFLOW);
+    }
+}
+
+// --- TRANSFERENCIA DE DATOS ---
+
+static void ejecutar_load(int modo, int operando) { // 04 - Cargar en AC
+    // Lógica: AC = Valor
+    cpu.AC = obtener_valor_operando(modo, operando);
+}
+
+static void ejecutar_str(int modo, int operando) { // 05 - Guardar AC en Memoria
+    // Lógica: Memoria[Operando] = AC
+    int dir_destino = direccion_destino(modo, operando);
+
+    // Solo escribimos si la dirección es válida (y no es -1)
+    if (dir_destino >= 0) {
+        escribir_memoria(dir_destino, cpu.AC);
+        LOG_TRAZA("      -> Guardado %d en Mem[%d]\n", cpu.AC, dir_destino);
+    } else {
+        lanzar_interrupcion(INT_DIR_INVALIDA);
+    }
+}
+
+static void ejecutar_loadrx(int modo, int operando) { // 06 - Cargar en RX
+    // Lógica: RX = Valor
+    cpu.RX = obtener_valor_operando(modo, operando);
+}
+
+static void ejecutar_strrx(int modo, int operando) { // 07 - Guardar RX en Memoria
+    // Igual que STR, pero la fuente es RX
+    int dir_destino = direccion_destino(modo, operando);
+
+    if (dir_destino >= 0) {
+        escribir_memoria(dir_destino, cpu.RX);
+        LOG_TRAZA("      -> Guardado RX (%d) en Mem[%d]\n", cpu.RX, dir_destino);
+    } else {
+        lanzar_interrupcion(INT_DIR_INVALIDA);
+    }
+}
+
+// --- COMPARACIÓN Y SALTOS ---
+
+// Destino de un salto. El operando llega a RB + 99999; en modo indexado
+// se le suma RX (salto ancho), así el código alcanza toda una memoria grande
+static inline int destino_salto(int modo, int operando) {
+    return cpu.RB + operando + (modo == DIR_INDEXADO ? cpu.RX : 0);
+}
+
+static void ejecutar_comp(int modo, int operando) { // 08 - Comparar
+    int val = obtener_valor_operando(modo, operando);
+    if (cpu.AC == val) {
+        cpu.psw.codigo_condicion = 0; // Iguales
+    } else if (cpu.AC < val) {
+        cpu.psw.codigo_condicion = 1; // Menor
+    } else {
+        cpu.psw.codigo_condicion = 2; // Mayor
+    }
+}
+
+static void ejecutar_jmpe(int modo, int operando) { // 09 - Jump Equal (Si CC == 0)
+    if (cpu.psw.codigo_condicion == 0) {
+        cpu.psw.pc = destino_salto(modo, operando);
+    }
+}
+
+static void ejecutar_jmpne(int modo, int operando) { // 10 - Jump Not Equal (Si CC != 0)
+    if (cpu.psw.codigo_condicion != 0) {
+        cpu.psw.pc = destino_salto(modo, operando);
+    }
+}
+
+static void ejecutar_jmplt(int modo, int operando) { // 11 - Jump Less Than (Si CC == 1)
+    if (cpu.psw.codigo_condicion == 1) {
+        cpu.psw.pc = destino_salto(modo, operando);
+    }
+}
+
+static void ejecutar_jmplgt(int modo, int operando) { // 12 - Jump Greater Than (Si CC == 2)
+    if (cpu.psw.codigo_condicion == 2) {
+        cpu.psw.pc = destino_salto(modo, operando);
+    }
+}
+
+// --- SISTEMA Y CONTROL (13-18) ---
+
+static void ejecutar_svc(int modo, int operando) { // Código 13: System Call (Llamada al Sistema)
+    // Se usa para solicitar servicios al Kernel (como E/S o terminar).
+    // Si AC=0 el proceso pide terminar; la máquina se apaga cuando no queda ninguno.
+    lanzar_interrupcion(INT_SYSCALL); // Llamada al sistema
+
+    LOG_TRAZA("      -> [SVC] Llamada al sistema detectada. Codigo en AC: %d\n", cpu.AC);
+    if (cpu.AC == 0) {
+        LOG_TRAZA("      -> [INFO] SVC 0: Solicitud de fin de programa.\n");
+        procesos_terminar_actual();
+    }
+}
+
+static void ejecutar_retrn(int modo, int operando) { // Código 14: Return (Retorno de Subrutina)
+    // Recupera el valor del PC que estaba guardado en el tope de la Pila.
+    // Esto permite volver al lugar donde se llamó a la función.
+    // El tope de la pila es el final de la partición (RL - RB, relativo a RB).
+    int dir_fisica = (cpu.SP < cpu.RL - cpu.RB) ? dir_pila(cpu.SP + 1 + cpu.RB) : -1;
+    if (dir_fisica >= 0) {
+        cpu.SP++; // Pasamos de la posicion vacia a la llena
+        cpu.psw.pc = maquina.memoria[dir_fisica]; // Leemos la dirección de retorno
+        LOG_TRAZA("      -> [RETRN] Retornando a la direccion %d (Stack[%d])\n", cpu.psw.pc, cpu.SP);
+    } else {
+        lanzar_interrupcion(INT_UNDERFLOW);
+    }
+}
+
+static void ejecutar_hab(int modo, int operando) { // Código 15: Habilitar Interrupciones
+    cpu.psw.interrupciones = 1;
+    LOG_TRAZA("      -> [HAB] Interrupciones HABILITADAS.\n");
+}
+
+static void ejecutar_dhab(int modo, int operando) { // Código 16: Deshabilitar Interrupciones
+    cpu.psw.interrupciones = 0;
+    LOG_TRAZA("      -> [DHAB] Interrupciones DESHABILITADAS.\n");
+}
+
+static void ejecutar_tti(int modo, int operando) { // 17 - Configurar Timer
+    // El hilo del timer lo toma en su próxima vuelta; no hace falta el bus
+    atomic_store_explicit(&maquina.timer_periodo, operando, memory_order_relaxed);
+
+    LOG_TRAZA("      -> [TTI] Timer configurado a %d ciclos (aprox %d ms).\n",
+        operando, operando * 10);
+}
+
+static void ejecutar_chmod(int modo, int operando) { // 18
+    if (cpu.psw.modo_operacion == 0) {
+        // [PDF] Privilegio -> Instrucción Inválida (5) o podemos definir una nueva.
+        // Usaremos 5 (Instrucción Invalida para este modo)
+        lanzar_interrupcion(INT_INST_ILLEGAL);
+        LOG_TRAZA("      -> [ERROR] Violacion de Privilegios\n");
+    } else if (operando == 0 || operando == 1) {
+        cpu.psw.modo_operacion = operando;
+        LOG_TRAZA("      -> [CHMOD] Modo: %d\n", operando);
+    } else {
+        lanzar_interrupcion(INT_INST_ILLEGAL); // Argumento invalido
+    }
+}
+
+// --- PROTECCIÓN DE MEMORIA (19-22) ---
+// Estos registros delimitan qué parte de la memoria puede usar el programa actual.
+
+static void ejecutar_loadrb(int modo, int operando) { // 19: Cargar Registro Base
+    cpu.AC = cpu.RB;
+    LOG_TRAZA("      -> [LOADRB] AC cargado con RB (%d)\n", cpu.RB);
+}
+
+static void ejecutar_strrb(int modo, int operando) { // 20: Guardar en Registro Base
+    // Las particiones comparten la RAM: solo el kernel mueve RB
+    if (cpu.psw.modo_operacion == 0) {
+        lanzar_interrupcion(INT_INST_ILLEGAL);
+        LOG_TRAZA("      -> [ERROR] Violacion de Privilegios\n");
+        return;
+    }
+    cpu.RB = cpu.AC;
+    LOG_TRAZA("      -> [STRRB] RB actualizado con AC (%d)\n", cpu.RB);
+}
+
+static void ejecutar_loadrl(int modo, int operando) { // 21: Cargar Registro Límite
+    cpu.AC = cpu.RL;
+    LOG_TRAZA("      -> [LOADRL] AC cargado con RL (%d)\n", cpu.RL);
+}
+
+static void ejecutar_strrl(int modo, int operando) { // 22: Guardar en Registro Límite
+    if (cpu.psw.modo_operacion == 0) {
+        lanzar_interrupcion(INT_INST_ILLEGAL);
+        LOG_TRAZA("      -> [ERROR] Violacion de Privilegios\n");
+        return;
+    }
+    cpu.RL = cpu.AC;
+    LOG_TRAZA("      -> [STRRL] RL actualizado con AC (%d)\n", cpu.RL);
+}
+
+// --- MANEJO DE PILA (STACK) (23-26) ---
+
+static void ejecutar_loadsp(int modo, int operando) { // 23: Cargar Stack Pointer a AC
+    cpu.AC = cpu.SP;
+    LOG_TRAZA("      -> [LOADSP] AC cargado con SP (%d)\n", cpu.AC);
+}
+
+static void ejecutar_strsp(int modo, int operando) { // 24: Actualizar Stack Pointer desde AC
+    cpu.SP = cpu.AC;
+    LOG_TRAZA("      -> [STRSP] SP actualizado con AC (%d)\n", cpu.SP);
+}
+
+static void ejecutar_psh(int modo, int operando) { // 25: PUSH
+    // 1. Calculamos la dirección física REAL
+    int dir_fisica = cpu.RB + cpu.SP;
+
+    // 2. Verificamos seguridad
+    //    (SP >= 0) asegura que no bajemos más allá del piso 0 relativo,
+    //    RL que no nos salgamos de la partición del proceso y dir_pila
+    //    que la palabra exista en la RAM
+    if (cpu.SP >= 0 && dir_fisica <= cpu.RL && (dir_fisica = dir_pila(dir_fisica)) >= 0) {
+
+        escribir_memoria(dir_fisica, cpu.AC);
+        LOG_TRAZA("      -> [PSH] Valor %d apilado en MemFisica[%d] (SP Logico: %d)\n",
+            cpu.AC, dir_fisica, cpu.SP);
+        // 3. RESTAMOS Para pasar de 1700 (imaginario) a 1699 (real)
+        cpu.SP--;
+    } else {
+        lanzar_interrupcion(INT_OVERFLOW);
+    }
+}
+
+static void ejecutar_pop(int modo, int operando) { // 26: POP (Desapilar)
+    // 1. VALIDAR SI HAY DATOS (Stack Underflow)
+    // El tope inicial es (cpu.RL - cpu.RB): 1699 con un solo proceso.
+    // Si SP está en el tope, significa que no hemos hecho ningún PUSH todavía.
+    // La palabra a leer tiene que existir en la RAM (RB/RL los mueve el kernel)
+    int tope = cpu.RL - cpu.RB;
+    int dir_fisica_pop = (cpu.SP < tope) ? dir_pila(cpu.RB + cpu.SP + 1) : -1;
+    if (dir_fisica_pop >= 0) {
+
+        // 2. SUMAR PRIMERO (Pre-incremento)
+        // Pasamos de la posición vacía (ej. 1698) a la llena (1699)
+        cpu.SP++;
+
+        // 3. LEER EL DATO
+        cpu.AC = maquina.memoria[dir_fisica_pop];
+
+        LOG_TRAZA("      -> [POP] Recuperado %d de MemFisica[%d] (SP Logico: %d)\n",
+            cpu.AC, dir_fisica_pop, cpu.SP);
+    } else {
+        lanzar_interrupcion(INT_UNDERFLOW);
+    }
+}
+
+static void ejecutar_j(int modo, int operando) { // 27 - Salto Incondicional (Salta siempre)
+    cpu.psw.pc = destino_salto(modo, operando);
+}
+
+// --- INSTRUCCIONES DE DISCO Y DMA (Fase 1) ---
+// Los registros del DMA solo los toca la CPU: el hilo del DMA trabaja
+// sobre la copia que encola SDMAON, así que aquí no hace falta el mutex.
+
+static void ejecutar_sdmap(int modo, int operando) { // SDMAP - Set DMA Pista
+    // Configura qué pista del disco queremos usar
+    dma.pista_seleccionada = operando;
+    LOG_TRAZA("      -> [SDMAP] Pista seleccionada: %d\n", operando);
+}
+
+static void ejecutar_sdmac(int modo, int operando) { // SDMAC - Set DMA Cilindro
+    // Configura qué cilindro
+    dma.cilindro_seleccionado = operando;
+    LOG_TRAZA("      -> [SDMAC] Cilindro seleccionado: %d\n", operando);
+}
+
+static void ejecutar_sdmas(int modo, int operando) { // SDMAS - Set DMA Sector
+    // Configura qué sector
+    dma.sector_seleccionado = operando;
+    LOG_TRAZA("      -> [SDMAS] Sector seleccionado: %d\n", operando);
+}
+
+static void ejecutar_sdmaio(int modo, int operando) { // SDMAIO - Set DMA I/O Direction
+    // Según tu tabla: "Establece si es I/O"
+    // Usaremos el operando: 1 = Escritura (RAM->Disco), 0 = Lectura (Disco->RAM)
+    dma.es_escritura = operando;
+    LOG_TRAZA("      -> [SDMAIO] Modo configurado: %s\n",
+               dma.es_escritura ? "ESCRITURA (Grabar)" : "LECTURA (Cargar)");
+}
+
+static void ejecutar_sdmam(int modo, int operando) { // SDMAM - Set DMA Memory Address
+    // Según tu tabla: "Establece la posición de memoria a ser accedida".
+    // En modo indexado se le suma RX: llega a cualquier palabra de la RAM
+    dma.direccion_memoria = operando + (modo == DIR_INDEXADO ? cpu.RX : 0);
+    LOG_TRAZA("      -> [SDMAM] Direccion de memoria RAM objetivo: %d\n", dma.direccion_memoria);
+}
+
+static void ejecutar_sdmaon(int modo, int operando) { // SDMAON - Encender DMA
+    // Esta instrucción es el "Gatillo". Encola la solicitud y
+    // ¡Despierta al hilo_dma en disco.c! El proceso espera su INT_IO_FIN.
+    // Se bloquea antes de encolar: el fin de E/S puede llegar a otro núcleo enseguida
+    procesos_bloquear_actual();
+    dma_encolar(proceso_actual());
+    LOG_TRAZA("      -> [SDMAON] ¡DMA ACTIVADO! Transferencia iniciada...\n");
+}
+
+static void ejecutar_sdmacnt(int modo, int operando) { // SDMACNT - Set DMA Cantidad
+    // Cuántos sectores consecutivos (y palabras de RAM) mueve la próxima ráfaga
+    dma.cantidad = operando;
+    LOG_TRAZA("      -> [SDMACNT] Rafaga de %d sectores\n", operando);
+}
+
+static void ejecutar_sdmacad(int modo, int operando) { // SDMACAD - Cadena de descriptores
+    // Arranca una cadena de descriptores guardada en Mem[operando] (más
+    // RX en modo indexado). Toda la cadena termina con una sola
+    // interrupción de fin de E/S.
+    int direccion = operando + (modo == DIR_INDEXADO ? cpu.RX : 0);
+
+    procesos_bloquear_actual();
+    dma_encolar_cadena(direccion, proceso_actual());
+    LOG_TRAZA("      -> [SDMACAD] Cadena de descriptores en Mem[%d] iniciada...\n", direccion);
+}
+
+static void ejecutar_invalida(int modo, int operando) { // Opcode desconocido
+    lanzar_interrupcion(INT_INST_ILLEGAL);
+}
+
+// Tabla OPCODE -> Manejador (el índice es el código de operación)
+static const manejador_t tabla_manejadores[OP_MAXIMO + 1] = {
+    [OP_SUM]    = ejecutar_sum,    [OP_RES]    = ejecutar_res,
+    [OP_MULT]   = ejecutar_mult,   [OP_DIVI]   = ejecutar_divi,
+    [OP_LOAD]   = ejecutar_load,   [OP_STR]    = ejecutar_str,
+    [OP_LOADRX] = ejecutar_loadrx, [OP_STRRX]  = ejecutar_strrx,
+    [OP_COMP]   = ejecutar_comp,   [OP_JMPE]   = ejecutar_jmpe,
+    [OP_JMPNE]  = ejecutar_jmpne,  [OP_JMPLT]  = ejecutar_jmplt,
+    [OP_JMPLGT] = ejecutar_jmplgt, [OP_SVC]    = ejecutar_svc,
+    [OP_RETRN]  = ejecutar_retrn,  [OP_HAB]    = ejecutar_hab,
+    [OP_DHAB]   = ejecutar_dhab,   [OP_TTI]    = ejecutar_tti,
+    [OP_CHMOD]  = ejecutar_chmod,  [OP_LOADRB] = ejecutar_loadrb,
+    [OP_STRRB]  = ejecutar_strrb,  [OP_LOADRL] = ejecutar_loadrl,
+    [OP_STRRL]  = ejecutar_strrl,  [OP_LOADSP] = ejecutar_loadsp,
+    [OP_STRSP]  = ejecutar_strsp,  [OP_PSH]    = ejecutar_psh,
+    [OP_POP]    = ejecutar_pop,    [OP_J]      = ejecutar_j,
+    [OP_SDMAP]  = ejecutar_sdmap,  [OP_SDMAC]  = ejecutar_sdmac,
+    [OP_SDMAS]  = ejecutar_sdmas,  [OP_SDMAIO] = ejecutar_sdmaio,
+    [OP_SDMAM]  = ejecutar_sdmam,  [OP_SDMAON] = ejecutar_sdmaon,
+    [OP_SDMACNT] = ejecutar_sdmacnt, [OP_SDMACAD] = ejecutar_sdmacad,
+};
+
+// ====================================================
+// CACHÉ DE DECODIFICACIÓN
+// ====================================================
+
+// Decodifica la palabra Mem[dir] y la guarda en la caché.
+// Formato: OPCODE (2) | MODO (1) | OPERANDO (5)
+void decodificar_palabra(int dir) {
+    int instruccion = maquina.memoria[dir];
+    Decodificada_t *d = &cache_decodificada[dir];
+
+    // Matemáticas para separar los dígitos:
+    d->opcode = (instruccion / 1000000);     // Los primeros 2 dígitos
+    d->modo = (instruccion / 100000) % 10;   // El 3er dígito
+    d->operando = (instruccion % 100000);    // Los últimos 5 dígitos
+
+    if (d->opcode >= 0 && d->opcode <= OP_MAXIMO) {
+        d->manejador = tabla_manejadores[d->opcode];
+    } else {
+        d->manejador = ejecutar_invalida;
+    }
+
+    // Rutina especializada para el motor hilado
+    d->indice = indice_hilado(d->opcode, d->modo);
+    d->etiqueta = etiquetas_hilado ? etiquetas_hilado[d->indice] : NULL;
+    d->contador = estad_indice(d->opcode, d->modo);
+}
+
+// Único camino para escribir en RAM: mantiene la caché sincronizada
+void escribir_memoria(int dir, int valor) {
+    maquina.memoria[dir] = valor;
+    decodificar_palabra(dir);
+    bloques_invalidar(dir, 1);
+    checkpoint_marcar_memoria(dir);
+    if (traza_activa) traza_anotar_escritura(dir, valor);
+}
+
+void escribir_bloque(int dir, const int *valores, int cantidad) {
+    memcpy(&maquina.memoria[dir], valores, cantidad * sizeof(int));
+    for (int i = 0; i < cantidad; i++) {
+        decodificar_palabra(dir + i);
+        checkpoint_marcar_memoria(dir + i);
+    }
+    if (cantidad > 0) bloques_invalidar(dir, cantidad);
+}
+
 int paso_cpu() {
-    int instruccion, opcode, modo, operando;
+    Decodificada_t *inst;
 
     // --- 1. FETCH (Búsqueda) ---
     // a. MAR <- PC
     cpu.MAR = cpu.psw.pc;
     
-    // b. Validar acceso a memoria (Fetch)
-    if (!validar_direccion(cpu.MAR)) return 0;
+    // b. Validar acceso a memoria (Fetch). Con paginación el PC es
+    //    lógico y MAR queda con la dirección física de la instrucción.
+    //    Un fallo de página no es un error: la instrucción se reintenta
+    if (paginacion) {
+        int fisica = mmu_traducir(cpu.MAR);
+        if (fisica == MMU_FALLO) return 1;
+        if (fisica < 0) return 0;
+        cpu.MAR = fisica;
+    } else if (!validar_direccion(cpu.MAR)) {
+        return 0;
+    }
+
+    // En modo Kernel no hay límites, pero la RAM física sí los tiene
+    if (cpu.MAR < 0 || cpu.MAR >= maquina.tamano_memoria) {
+        LOG_ERROR("[CPU] PC fuera de la memoria fisica (%d)\n", cpu.MAR);
+        return 0;
+    }
 
     // c. MDR <- Memoria[MAR]
-    cpu.MDR = cpu.memoria[cpu.MAR];
+    cpu.MDR = maquina.memoria[cpu.MAR];
 
     // d. IR <- MDR
     cpu.IR = cpu.MDR;
 
+    inst = decodificada(cpu.MAR);
+    if (memoria_virtual && !operando_presente(inst)) return 1;
+
     // e. PC++ (Apunta a la siguiente instrucción)
     cpu.psw.pc++;
+    cpu.instrucciones++;
 
     // --- 2. DECODE (Decodificación) ---
-    // Formato: OPCODE (2) | MODO (1) | OPERANDO (5)
-    instruccion = cpu.IR;
-    
-    // Matemáticas para separar los dígitos:
-    opcode = (instruccion / 1000000);     // Los primeros 2 dígitos
-    modo = (instruccion / 100000) % 10;   // El 3er dígito
-    operando = (instruccion % 100000);    // Los últimos 5 dígitos
+    // Ya se hizo al cargar/escribir la palabra (o recién, si nadie la
+    // escribió): inst es su entrada en la caché.
+    ESTAD_SUMAR(&contadores->instrucciones[inst->contador], 1);
+    if (perfil_exacto) perfil_retirar(cpu.MAR);
     
     // Debugging visual
-    logger_log("[CPU] PC:%04d | IR:%08d -> OP:%02d M:%d VAL:%05d\n", 
-        cpu.MAR, instruccion, opcode, modo, operando);
+    LOG_TRAZA("[CPU] PC:%04d | IR:%08d -> OP:%02d M:%d VAL:%05d\n", 
+        cpu.MAR, cpu.IR, inst->opcode, inst->modo, inst->operando);
         
     // --- 3. EXECUTE (Ejecución) ---
-    switch (opcode) {
-
-        // --- ARITMÉTICA CON DETECCIÓN DE DESBORDAMIENTO (CC=3) ---
-        case OP_SUM: // 00 - Sumar
-        {
-            // Lógica: AC = AC + Valor
-            int val = obtener_valor_operando(modo, operando);
-            long long resultado_temp = (long long)cpu.AC + val; // Usamos long long para ver si se pasa
-
-            if (resultado_temp > MAX_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 8;
-                cpu.psw.codigo_condicion = 3;
-            } else if (resultado_temp < MIN_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 7;
-                cpu.psw.codigo_condicion = 3;
-            } else {
-                cpu.AC = (int)resultado_temp;
-                // Actualizamos CC normal (Opcional, algunos CPUs lo hacen)
-                if (cpu.AC == 0) cpu.psw.codigo_condicion = 0;
-                else if (cpu.AC < 0) cpu.psw.codigo_condicion = 1;
-                else cpu.psw.codigo_condicion = 2;
-            }
-            break;
-        }    
-
-        case OP_RES: // 01 - Restar
-        {
-            // Lógica: AC = AC - Valor
-            int val = obtener_valor_operando(modo, operando);
-            long long resultado_temp = (long long)cpu.AC - val;
-
-            if (resultado_temp > MAX_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 8;
-                cpu.psw.codigo_condicion = 3;
-            } else if (resultado_temp < MIN_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 7;
-                cpu.psw.codigo_condicion = 3;
-            } else {
-                cpu.AC = (int)resultado_temp;
-                // Actualizar CC normal
-                if (cpu.AC == 0) cpu.psw.codigo_condicion = 0;
-                else if (cpu.AC < 0) cpu.psw.codigo_condicion = 1;
-                else cpu.psw.codigo_condicion = 2;
-            }
-            break;
-        }
-            
-        case OP_MULT: // 02 - Multiplicar
-        {
-            // Lógica: AC = AC * Valor
-            int val = obtener_valor_operando(modo, operando);
-            long long resultado_temp = (long long)cpu.AC * val;
-
-            if (resultado_temp > MAX_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 8;
-                cpu.psw.codigo_condicion = 3;
-            } else if (resultado_temp < MIN_VALOR) {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 7;
-                cpu.psw.codigo_condicion = 3;
-            } else {
-                cpu.AC = (int)resultado_temp;
-                if (cpu.AC == 0) cpu.psw.codigo_condicion = 0;
-                else if (cpu.AC < 0) cpu.psw.codigo_condicion = 1;
-                else cpu.psw.codigo_condicion = 2;
-            }
-            break;
-        }
+    inst->manejador(inst->modo, inst->operando);
 
-        case OP_DIVI: // 03 - Dividir
-        {
-            // Lógica: AC = AC / Valor
-            int val = obtener_valor_operando(modo, operando);
-            if (val != 0) {
-                cpu.AC /= val;
-                if (cpu.AC == 0) cpu.psw.codigo_condicion = 0;
-                else if (cpu.AC < 0) cpu.psw.codigo_condicion = 1;
-                else cpu.psw.codigo_condicion = 2;
-            } else {
-                cpu.psw.codigo_condicion = 3; // Podemos usar el 3 también para Error Matemático
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 8;
-            }
-            break;
-        }
-            
-        case OP_LOAD: // 04 - Cargar en AC
-        {
-            // Lógica: AC = Valor
-            cpu.AC = obtener_valor_operando(modo, operando);
-            break;
-        }
-            
-        case OP_STR: // 05 - Guardar AC en Memoria
-        {
-            // Lógica: Memoria[Operando] = AC
-            int dir_destino = -1;
-            if (modo == DIR_DIRECTO) {
-                dir_destino = operando + cpu.RB;
-            } else if (modo == DIR_INDEXADO) {
-                dir_destino = operando + cpu.RB + cpu.RX;
-            }
-
-            // Solo escribimos si la dirección es válida (y no es -1)
-            if (dir_destino != -1 && validar_direccion(dir_destino)) {
-                cpu.memoria[dir_destino] = cpu.AC;
-                logger_log("      -> Guardado %d en Mem[%d]\n", cpu.AC, dir_destino);
-            } else {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 6;
-            }
-            break;
-        }
-
-        case OP_LOADRX: // 06 - Cargar en RX
-        {
-            // Lógica: RX = Valor
-            cpu.RX = obtener_valor_operando(modo, operando);
-            break;
-        }
+    if (traza_activa) {
+        traza_retirar(cpu.MAR, cpu.IR, cpu.AC, cpu.psw.codigo_condicion, inst->opcode, inst->modo);
+    }
+    
+    return 1; // Continuar ejecutando
+}
 
-        case OP_STRRX: // 07 - Guardar RX en Memoria
-        {
-            // Igual que STR, pero la fuente es RX
-            int dir_destino = -1;
-            if (modo == DIR_DIRECTO) {
-                dir_destino = operando + cpu.RB;
-            } else if (modo == DIR_INDEXADO) {
-                dir_destino = operando + cpu.RB + cpu.RX;
-            }
+// Duerme 'us' microsegundos en tramos de 1 ms: al apagarse la máquina el
+// timer sale enseguida en lugar de terminar su periodo
+static void dormir_timer(Maquina_t *maq, long us) {
+    while (us > 0 && atomic_load_explicit(&maq->ejecutando, memory_order_relaxed)) {
+        long tramo = us < 1000 ? us : 1000;
+        usleep(tramo);
+        us -= tramo;
+    }
+}
 
-            if (dir_destino != -1 && validar_direccion(dir_destino)) {
-                cpu.memoria[dir_destino] = cpu.RX;
-                logger_log("      -> Guardado RX (%d) en Mem[%d]\n", cpu.RX, dir_destino);
-            } else {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 6;
-            }
-            break;
-        }
+// --- HILO DEL TIMER ---
+// Este código corre en paralelo a la CPU. El reloj es uno solo para toda
+// la máquina y su tick llega a todos los núcleos.
+void *hilo_timer(void *arg) {
+    Maquina_t *maq = (Maquina_t *)arg;
 
-        case OP_COMP: // 08 - Comparar
-        {
-            int val = obtener_valor_operando(modo, operando);
-            if (cpu.AC == val) {
-                cpu.psw.codigo_condicion = 0; // Iguales
-            } else if (cpu.AC < val) {
-                cpu.psw.codigo_condicion = 1; // Menor
-            } else {
-                cpu.psw.codigo_condicion = 2; // Mayor
-            }
-            break;
-        }
+    estadisticas_hilo();
+    while (atomic_load_explicit(&maq->ejecutando, memory_order_relaxed)) {
+        int periodo = atomic_load_explicit(&maq->timer_periodo, memory_order_relaxed);
 
-        // --- SALTOS (JUMPS) ---
-        case OP_JMPE: // 09 - Jump Equal (Si CC == 0)
-        {
-            if (cpu.psw.codigo_condicion == 0) {
-                cpu.psw.pc = cpu.RB + operando;
-            }
-            break;
-        }
+        // 1. Si el timer está configurado (valor > 0)
+        if (periodo > 0) {
+            
+            // SIMULACION DE TIEMPO:
+            // Para que sea visible al ojo humano, usaremos usleep.
+            // Digamos que 1 ciclo simulado = 10 milisegundos.
+            // Si TTI es 50, dormimos 500ms.
+            dormir_timer(maq, periodo * 10000L);
+            if (!atomic_load_explicit(&maq->ejecutando, memory_order_relaxed)) break;
 
-        case OP_JMPNE: // 10 - Jump Not Equal (Si CC != 0)
-        {
-            if (cpu.psw.codigo_condicion != 0) {
-                cpu.psw.pc = cpu.RB + operando;
-            }
-            break;
-        }
+            // 2. DISPARAR INTERRUPCIÓN
+            // El controlador la encola con un OR atómico: si la CPU aún no
+            // atendió el tick anterior, este no se pierde.
+            ic_difundir(INT_RELOJ); // Código 3 = Reloj (según PDF)
 
-        case OP_JMPLT: // 11 - Jump Less Than (Si CC == 1)
-        {
-            if (cpu.psw.codigo_condicion == 1) {
-                cpu.psw.pc = cpu.RB + operando;
-            }
-            break;
-        }
-            
-        case OP_JMPLGT: // 12 - Jump Greater Than (Si CC == 2)
-        {
-            if (cpu.psw.codigo_condicion == 2) {
-                cpu.psw.pc = cpu.RB + operando;
-            }
-            break;
+        } else {
+            // Si el timer está apagado (0), solo dormimos un poco para no quemar CPU
+            dormir_timer(maq, 100000);
         }
+    }
+    return NULL;
+}
 
-        // --- SISTEMA Y CONTROL (13-18) ---
-        
-        case OP_SVC: // Código 13: System Call (Llamada al Sistema)
-        {
-            // Se usa para solicitar servicios al Kernel (como E/S o terminar).
-            // En esta Fase 1, si AC=0 asumimos que se pide terminar la simulación.
-            cpu.interrupcion_pendiente = 1;
-            cpu.codigo_interrupcion = 2; // Llamada al sistema
-
-            logger_log("      -> [SVC] Llamada al sistema detectada. Codigo en AC: %d\n", cpu.AC);
-            if (cpu.AC == 0) {
-                logger_log("      -> [INFO] SVC 0: Solicitud de fin de programa.\n");
-                cpu.ejecutando = 0; // Detiene el bucle principal
-            }
-            break;
-        }
-        
-        case OP_RETRN: 
-        {
-            // Código 14: Return (Retorno de Subrutina)
-            // Recupera el valor del PC que estaba guardado en el tope de la Pila.
-            // Esto permite volver al lugar donde se llamó a la función.
-            if (cpu.SP < (TAMANO_MEMORIA - INICIO_USUARIO - 1)) {
-                cpu.SP++; // Pasamos de la posicion vacia a la llena
-                cpu.psw.pc = cpu.memoria[cpu.SP + cpu.RB]; // Leemos la dirección de retorno
-                logger_log("      -> [RETRN] Retornando a la direccion %d (Stack[%d])\n", cpu.psw.pc, cpu.SP);
-            } else {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 7;
-            }
-            break;
-        }
+// Atiende una interrupción sacada del controlador
+static void atender_interrupcion(int codigo) {
+    // Tabla de Interrupciones. Un error fatal termina al proceso que lo
+    // causó; la máquina se apaga cuando ya no queda ninguno vivo.
+    switch (codigo) {
         
-        case OP_HAB: // Código 15: Habilitar Interrupciones
-        {
-            cpu.psw.interrupciones = 1;
-            logger_log("      -> [HAB] Interrupciones HABILITADAS.\n");
-            break;
-        }
-        
-        case OP_DHAB: // Código 16: Deshabilitar Interrupciones
-        {
-            cpu.psw.interrupciones = 0;
-            logger_log("      -> [DHAB] Interrupciones DESHABILITADAS.\n");
-            break;
-        }
-        
-        case OP_TTI: // 17 - Configurar Timer
-        {
-            // Ahora sí guardamos el valor para que el hilo lo lea
-            pthread_mutex_lock(&cpu.mutex); // Protegemos el cambio
-            cpu.timer_periodo = operando;
-            pthread_mutex_unlock(&cpu.mutex);
-            
-            logger_log("      -> [TTI] Timer configurado a %d ciclos (aprox %d ms).\n", 
-                operando, operando * 10);
-            break;
-        }
-            
-        case OP_CHMOD: // 18
-        {
-            if (cpu.psw.modo_operacion == 0) {
-                // [PDF] Privilegio -> Instrucción Inválida (5) o podemos definir una nueva.
-                // Usaremos 5 (Instrucción Invalida para este modo)
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 5; 
-                logger_log("      -> [ERROR] Violacion de Privilegios\n");
-            } else if (operando == 0 || operando == 1) {
-                cpu.psw.modo_operacion = operando;
-                logger_log("      -> [CHMOD] Modo: %d\n", operando);
-            } else {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 5; // Argumento invalido
+        case 0: // SVC Inválido
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Codigo SVC invalido (Cod 0) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
+            break;
+        case 1: // Int Inválida
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Codigo INT invalido (Cod 1) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
+            break;
+        case 2: // SVC (Llamada al Sistema)
+            logger_log("\n>>> [INT] SYSTEM CALL: Solicitud al Kernel (Cod 2) <<<\n");
+            // Nota: Si es SVC 0 (Fin), el switch de opcode ya puso ejecutando=0.
+            // Si es otro servicio (Fase 2), aquí NO apagamos.
+            break;
+        case 3: // Reloj
+            logger_log("\n>>> [INT] HARDWARE: Reloj (Cod 3) <<<\n");
+            // ¡NO APAGAR! El reloj es vida: reparte los turnos (Round-Robin).
+            procesos_tick();
+            break;
+        case 4: // Fin E/S (DMA)
+            // ESTADOdma se publicó antes del posteo: es el de esta transferencia o uno posterior
+            logger_log("\n>>> [INT] HARDWARE: Fin DMA (Cod 4, ESTADOdma=%d) <<<\n",
+                atomic_load_explicit(&dma_controlador.estado, memory_order_acquire));
+            // ¡NO APAGAR! El disco sigue girando. Desbloquea al dueño
+            // (y suelta los marcos si era la cadena de un fallo de página).
+            {
+                int pid = dma_siguiente_completada();
+                mmu_fin_io(pid);
+                procesos_io_fin(pid);
             }
             break;
-        }
-            
-        // --- PROTECCIÓN DE MEMORIA (19-22) ---
-        // Estos registros delimitan qué parte de la memoria puede usar el programa actual.
-            
-        case OP_LOADRB: // 19: Cargar Registro Base
-        {
-            cpu.AC = cpu.RB; 
-            logger_log("      -> [LOADRB] AC cargado con RB (%d)\n", cpu.RB);
+        case 5: // Instrucción Inválida
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Instruccion Desconocida (Cod 5) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
             break;
-        }
-        
-        case OP_STRRB:  // 20: Guardar en Registro Base
-        {
-            cpu.RB = cpu.AC; 
-            logger_log("      -> [STRRB] RB actualizado con AC (%d)\n", cpu.RB);
+        case 6: // Dir Inválida
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Violacion de Acceso a Memoria (Cod 6) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
             break;
-        }
-        
-        case OP_LOADRL: // 21: Cargar Registro Límite
-        {
-            cpu.AC = cpu.RL; 
-            logger_log("      -> [LOADRL] AC cargado con RL (%d)\n", cpu.RL);
+        case 7: // Underflow
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Stack/Math Underflow (Cod 7) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
             break;
-        }
-        
-        case OP_STRRL:  // 22: Guardar en Registro Límite
-        {
-            cpu.RL = cpu.AC; 
-            logger_log("      -> [STRRL] RL actualizado con AC (%d)\n", cpu.RL);
+        case 8: // Overflow
+            LOG_ERROR("\n>>> [INT] ERROR FATAL: Stack/Math Overflow (Cod 8) <<<\n");
+            procesos_abortar_actual(codigo); // <--- APAGAMOS EL PROCESO
             break;
-        }
-        
-        // --- MANEJO DE PILA (STACK) (23-26) ---
-        
-        case OP_LOADSP: // 23: Cargar Stack Pointer a AC
-        {
-            cpu.AC = cpu.SP;
-            logger_log("      -> [LOADSP] AC cargado con SP (%d)\n", cpu.AC);
+        case 9: // Entre núcleos
+            LOG_DEBUG("\n>>> [INT] IPI: Nucleo %d despertado (Cod 9) <<<\n", cpu.nucleo);
+            // Solo despierta al núcleo: el despacho que sigue toma el proceso listo
             break;
-        }
-        
-        case OP_STRSP:  // 24: Actualizar Stack Pointer desde AC
-        {
-            cpu.SP = cpu.AC;
-            logger_log("      -> [STRSP] SP actualizado con AC (%d)\n", cpu.SP);
-            break;
-        }
-        
-        case OP_PSH: // 25: PUSH
-        {
-            // 1. Calculamos la dirección física REAL
-            int dir_fisica = cpu.RB + cpu.SP;
-            
-            // 2. Verificamos seguridad
-            //    (SP >= 0) asegura que no bajemos más allá del piso 0 relativo
-            if (cpu.SP >= 0 && dir_fisica < TAMANO_MEMORIA) {
-                
-                cpu.memoria[dir_fisica] = cpu.AC; 
-                logger_log("      -> [PSH] Valor %d apilado en MemFisica[%d] (SP Logico: %d)\n", 
-                cpu.AC, dir_fisica, cpu.SP);
-                // 3. RESTAMOS Para pasar de 1700 (imaginario) a 1699 (real)
-                cpu.SP--;
-            } else {
-                cpu.interrupcion_pendiente = 1;
-                cpu.codigo_interrupcion = 8;
-            }
-            break;
-        }
-        
-        case OP_POP: // 26: POP (Desapilar)
-        {
-            // 1. VALIDAR SI HAY DATOS (Stack Underflow)
-            // Tu tope inicial calculado es (cpu.RL - cpu.RB) = 1699.
-            // Si SP = 1699, significa que no hemos hecho ningún PUSH todavía.
-            int tope = TAMANO_MEMORIA - INICIO_USUARIO - 1;
-            if (cpu.SP < tope) { 
-                
-                // 2. SUMAR PRIMERO (Pre-incremento)
-                // Pasamos de la posición vacía (ej. 1698) a la llena (1699)
-                cpu.SP++; 
-                
-                // 3. CALCULAR DIRECCIÓN FÍSICA
-                int dir_fisica_pop = cpu.RB + cpu.SP;
-                
-                // 4. LEER EL DATO
-                cpu.AC = cpu.memoria[dir_fisica_pop];
-                
-                logger_log("      -> [POP] Recuperado %d de MemFisica[%d] (SP Logico: %d)\n", 
-                    cpu.AC, dir_fisica_pop, cpu.SP);
-                    
-                } else {
-                    cpu.interrupcion_pendiente = 1;
-                    cpu.codigo_interrupcion = 7;
-                }
-            break;
-        }
-            
-        case OP_J: // 27 - Salto Incondicional (Salta siempre)
-        {
-            cpu.psw.pc = cpu.RB + operando;
+        case 10: // Fallo de página
+            LOG_DEBUG("\n>>> [INT] MMU: Fallo de pagina (Cod 10) <<<\n");
+            // El proceso se bloquea hasta que el DMA suba la página
+            mmu_atender_fallo();
             break;
+        default:
+            LOG_ERROR("\n>>> [INT] DESCONOCIDO: Codigo %d <<<\n", codigo);
+    }
+}
+
+// Atiende todo lo pendiente, en orden de prioridad
+static void atender_pendientes() {
+    int codigo;
+
+    while ((codigo = ic_siguiente()) >= 0) {
+        atender_interrupcion(codigo);
+    }
+}
+
+// Foto de la máquina quieta: sin transferencias en vuelo, con sus INT_IO_FIN
+// ya entregadas a la tabla de procesos y con el plato al día
+static void tomar_checkpoint() {
+    dma_pausar();
+    atender_pendientes();
+    cache_vaciar();
+    checkpoint_tomar();
+    dma_reanudar();
+}
+
+// Ejecuta un lote de hasta 'cantidad' instrucciones con el motor elegido.
+// El lote termina antes si una instrucción dispara una interrupción.
+static int ejecutar_lote(int cantidad) {
+    int exito = 1;
+
+    // El perfil no une el último salto de un lote con el primero del siguiente
+    perfil_anterior = -1;
+    perfil_en_lote = 1;
+    if (motor_cpu == MOTOR_HILADO) {
+        exito = ejecutar_hilado(cantidad);
+    } else if (motor_cpu == MOTOR_BLOQUES || motor_cpu == MOTOR_JIT) {
+        exito = ejecutar_bloques(cantidad);
+    } else {
+        for (int i = 0; i < cantidad && !cpu.corte_quantum && exito; i++) {
+            exito = paso_cpu();
         }
+    }
+    perfil_en_lote = 0;
+    return exito;
+}
 
-        // --- INSTRUCCIONES DE DISCO Y DMA (Fase 1) ---
-            
-        case OP_SDMAP: // SDMAP - Set DMA Pista
-        {
-            // Configura qué pista del disco queremos usar
-            pthread_mutex_lock(&cpu.mutex); // Protegemos el hardware
-            dma.pista_seleccionada = operando;
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAP] Pista seleccionada: %d\n", operando);
-            break;
+// Modo DEMO: una instrucción, volcado del estado y pausa de 100ms
+static void ejecutar_demo() {
+    int cantidad;
+
+    while (atomic_load_explicit(&maquina.ejecutando, memory_order_relaxed)) {
+        if (checkpoint_toca()) {
+            tomar_checkpoint();
         }
 
-        case OP_SDMAC: // SDMAC - Set DMA Cilindro
-        {
-            // Configura qué cilindro
-            pthread_mutex_lock(&cpu.mutex);
-            dma.cilindro_seleccionado = operando;
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAC] Cilindro seleccionado: %d\n", operando);
-            break;
+        // ====================================================
+        // 1. FASE DE VERIFICACIÓN DE INTERRUPCIONES
+        // ====================================================
+        if (ic_hay_pendientes()) {
+            atender_pendientes();
         }
 
-        case OP_SDMAS: // SDMAS - Set DMA Sector
-        {
-            // Configura qué sector
-            pthread_mutex_lock(&cpu.mutex);
-            dma.sector_seleccionado = operando;
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAS] Sector seleccionado: %d\n", operando);
-            break;
+        // ====================================================
+        // 2. PLANIFICACIÓN (Round-Robin)
+        // ====================================================
+        if (!procesos_despachar()) {
+            procesos_ocioso(); // Todos bloqueados: esperamos al DMA
+            continue;
         }
 
-        case OP_SDMAIO: // SDMAIO - Set DMA I/O Direction
-        {
-            // Según tu tabla: "Establece si es I/O"
-            // Usaremos el operando: 1 = Escritura (RAM->Disco), 0 = Lectura (Disco->RAM)
-            pthread_mutex_lock(&cpu.mutex);
-            dma.es_escritura = operando; 
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAIO] Modo configurado: %s\n", 
-                       dma.es_escritura ? "ESCRITURA (Grabar)" : "LECTURA (Cargar)");
-            break;
+        // ====================================================
+        // 3. FASE DE EJECUCIÓN
+        // ====================================================
+        cantidad = procesos_presupuesto(1);
+        cpu.corte_quantum = 0;
+        if (cantidad == 0) {
+            procesos_abortar_actual(SALIDA_LIMITE); // Agotó su límite de instrucciones
+        } else if (!ejecutar_lote(cantidad)) {
+            // Si paso_cpu devuelve 0 el proceso no puede seguir (PC ilegal)
+            procesos_abortar_actual(INT_DIR_INVALIDA);
         }
 
-        case OP_SDMAM: // SDMAM - Set DMA Memory Address
-        {
-            // Según tu tabla: "Establece la posición de memoria a ser accedida"
-            pthread_mutex_lock(&cpu.mutex);
-            dma.direccion_memoria = operando;
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAM] Direccion de memoria RAM objetivo: %d\n", operando);
-            break;
+        dump_cpu(); 
+        usleep(100000); // 100ms
+    }
+}
+
+// Modo TURBO: sin volcados ni pausas. Se ejecutan lotes de quantum_turbo
+// instrucciones y solo entre lotes se miran las interrupciones, con una
+// lectura relajada de la máscara del controlador.
+static void ejecutar_turbo() {
+    int cantidad;
+
+    while (atomic_load_explicit(&maquina.ejecutando, memory_order_relaxed)) {
+        if (checkpoint_toca()) {
+            tomar_checkpoint();
+        }
+        if (ic_hay_pendientes()) {
+            atender_pendientes();
         }
 
-        case OP_SDMAON: // SDMAON - Encender DMA
-        {
-            // Esta instrucción es el "Gatillo". Arranca el hilo del DMA.
-            pthread_mutex_lock(&cpu.mutex);
-            dma.activo = 1; // ¡Despierta al hilo_dma en disco.c!
-            pthread_mutex_unlock(&cpu.mutex);
-            logger_log("      -> [SDMAON] ¡DMA ACTIVADO! Transferencia iniciada...\n");
-            break;
+        if (!procesos_despachar()) {
+            procesos_ocioso();
+            continue;
         }
 
-        default:
-        {
-            cpu.interrupcion_pendiente = 1;
-            cpu.codigo_interrupcion = 5;
+        // El lote termina justo donde toca la próxima foto
+        cantidad = checkpoint_recortar(procesos_presupuesto(quantum_turbo));
+        cpu.corte_quantum = 0;
+        if (cantidad == 0) {
+            procesos_abortar_actual(SALIDA_LIMITE);
+        } else if (!ejecutar_lote(cantidad)) {
+            procesos_abortar_actual(INT_DIR_INVALIDA);
         }
     }
-    
-    return 1; // Continuar ejecutando
+
+    // Una interrupción disparada por la última instrucción (p.ej. SVC 0)
+    atender_pendientes();
 }
 
-// --- HILO DEL TIMER ---
-// Este código corre en paralelo a la CPU
-void *hilo_timer(void *arg) {
-    CPU_t *cpu = (CPU_t *)arg;
+// Corre un núcleo hasta que se apague la máquina
+static void correr_nucleo() {
+    if (modo_ejecucion == MODO_TURBO) {
+        ejecutar_turbo();
+    } else {
+        ejecutar_demo();
+    }
+}
 
-    while (cpu->ejecutando) {
-        // 1. Si el timer está configurado (valor > 0)
-        if (cpu->timer_periodo > 0) {
-            
-            // SIMULACION DE TIEMPO:
-            // Para que sea visible al ojo humano, usaremos usleep.
-            // Digamos que 1 ciclo simulado = 10 milisegundos.
-            // Si TTI es 50, dormimos 500ms.
-            usleep(cpu->timer_periodo * 10000); 
+// Instrucciones retiradas por cada núcleo (las deja su hilo al terminar)
+static unsigned long long instrucciones_nucleo[MAX_NUCLEOS];
 
-            // 2. DISPARAR INTERRUPCIÓN
-            // Usamos Mutex para proteger la escritura
-            pthread_mutex_lock(&cpu->mutex);
-            
-            if (cpu->interrupcion_pendiente == 0) { // Si no hay otra pendiente
-                cpu->interrupcion_pendiente = 1;
-                cpu->codigo_interrupcion = 3; // Código 3 = Reloj (según PDF)
-            }
-            
-            pthread_mutex_unlock(&cpu->mutex);
+// Hilo de los núcleos 1..N-1 (el 0 corre en el hilo principal)
+static void *hilo_nucleo(void *arg) {
+    int nucleo = (int)(long)arg;
 
-        } else {
-            // Si el timer está apagado (0), solo dormimos un poco para no quemar CPU
-            usleep(100000); 
-        }
-    }
+    estadisticas_hilo();
+    inicializar_nucleo(nucleo);
+    correr_nucleo();
+    bloques_liberar();
+    instrucciones_nucleo[nucleo] = cpu.instrucciones;
     return NULL;
 }
 
 void ejecutar_cpu() {
+    struct timespec inicio, fin;
+    pthread_t hilos[MAX_NUCLEOS];
+    unsigned long long total = 0;
+    double ms;
+    int lanzados = 1;
+    unsigned long long previas = cpu.instrucciones;   // > 0 si se restauró un checkpoint
+
     logger_log("--- INICIANDO EJECUCION ---\n");
-    
-    while (cpu.ejecutando) {
-        
-        // ====================================================
-        // 1. FASE DE VERIFICACIÓN DE INTERRUPCIONES
-        // ====================================================
-        pthread_mutex_lock(&cpu.mutex); // 🔒
-        
-        if (cpu.interrupcion_pendiente) {
-            
-            // Tabla de Interrupciones
-            switch (cpu.codigo_interrupcion) {
-                
-                case 0: // SVC Inválido
-                    logger_log("\n>>> [INT] ERROR FATAL: Codigo SVC invalido (Cod 0) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                case 1: // Int Inválida
-                    logger_log("\n>>> [INT] ERROR FATAL: Codigo INT invalido (Cod 1) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                case 2: // SVC (Llamada al Sistema)
-                    logger_log("\n>>> [INT] SYSTEM CALL: Solicitud al Kernel (Cod 2) <<<\n");
-                    // Nota: Si es SVC 0 (Fin), el switch de opcode ya puso ejecutando=0.
-                    // Si es otro servicio (Fase 2), aquí NO apagamos.
-                    break;
-                case 3: // Reloj
-                    logger_log("\n>>> [INT] HARDWARE: Reloj (Cod 3) <<<\n");
-                    // ¡NO APAGAR! El reloj es vida.
-                    break;
-                case 4: // Fin E/S (DMA)
-                    logger_log("\n>>> [INT] HARDWARE: Fin DMA (Cod 4) <<<\n");
-                    // ¡NO APAGAR! El disco sigue girando.
-                    break;
-                case 5: // Instrucción Inválida
-                    logger_log("\n>>> [INT] ERROR FATAL: Instruccion Desconocida (Cod 5) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                case 6: // Dir Inválida
-                    logger_log("\n>>> [INT] ERROR FATAL: Violacion de Acceso a Memoria (Cod 6) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                case 7: // Underflow
-                    logger_log("\n>>> [INT] ERROR FATAL: Stack/Math Underflow (Cod 7) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                case 8: // Overflow
-                    logger_log("\n>>> [INT] ERROR FATAL: Stack/Math Overflow (Cod 8) <<<\n");
-                    cpu.ejecutando = 0; // <--- APAGAMOS
-                    break;
-                default:
-                    logger_log("\n>>> [INT] DESCONOCIDO: Codigo %d <<<\n", cpu.codigo_interrupcion);
-            }
-            
-            cpu.interrupcion_pendiente = 0; 
-        }
-        
-        pthread_mutex_unlock(&cpu.mutex); // 🔓
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
 
-        // ====================================================
-        // 2. FASE DE EJECUCIÓN
-        // ====================================================
-        // Solo ejecutamos si seguimos vivos
-        if (cpu.ejecutando) {
-            if (!paso_cpu()) {
-                // Si paso_cpu devuelve 0, es una redundancia de seguridad
-                cpu.ejecutando = 0; 
-            }
-            
-            dump_cpu(); 
-            usleep(100000); // 100ms
+    for (int n = 1; n < maquina.nucleos; n++) {
+        if (pthread_create(&hilos[n], NULL, hilo_nucleo, (void *)(long)n) != 0) {
+            LOG_ERROR("[CPU] No se pudo crear el hilo del nucleo %d\n", n);
+            break;
         }
+        lanzados++;
     }
-    
+
+    correr_nucleo();
+    bloques_liberar();
+    instrucciones_nucleo[0] = cpu.instrucciones - previas;
+
+    for (int n = 1; n < lanzados; n++) {
+        pthread_join(hilos[n], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    ms = (fin.tv_sec - inicio.tv_sec) * 1000.0 + (fin.tv_nsec - inicio.tv_nsec) / 1e6;
+
     logger_log("--- EJECUCION FINALIZADA ---\n");
-}
\ No newline at end of file
+    for (int n = 0; n < lanzados; n++) {
+        total += instrucciones_nucleo[n];
+        if (lanzados > 1) {
+            logger_log("[INFO] Nucleo %d: %llu instrucciones\n", n, instrucciones_nucleo[n]);
+        }
+    }
+    logger_log("[INFO] %llu instrucciones en %.3f ms (%.2f MIPS)\n",
+        total, ms, ms > 0 ? total / (ms * 1000.0) : 0.0);
+    instrucciones_totales = total;
+    ms_ejecucion = ms;
+    ic_reporte();
+    bloques_reporte();
+    mmu_reporte();
+    procesos_reporte();
+}
@@ -1,100 +1,563 @@
 #include <stdio.h>
-#include <stdlib.h> // Para atoi y rand
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "disco.h"
-#include "cpu.h"    
-#include "logger.h" 
+#include "cpu.h"
+#include "logger.h"
+#include "interrupciones.h"
+#include "planificador_disco.h"
+#include "cache_disco.h"
+#include "estadisticas.h"
+#include "checkpoint.h"
 
 // Definición de las variables globales
 Disco_t disco;
-DMA_t dma;
+__thread DMA_t dma;
+EstadoDMA_t dma_controlador;
 
-void inicializar_disco() {
-    // Llenamos el disco de ceros para limpiar basura
+// Dormir o no el tiempo de servicio del disco (ver disco.h)
+int dma_tiempo_real = 1;
+
+// --- COLA DE SOLICITUDES DEL DMA ---
+// SDMAON copia los registros del DMA en esta cola y despierta al hilo.
+// Se guarda en orden de llegada; el planificador elige cuál atender.
+static SolicitudDMA_t cola_dma[DMA_MAX_SOLICITUDES];
+static int cola_cantidad = 0;
+static int dma_detener = 0;
+static pthread_mutex_t dma_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dma_hay_trabajo = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dma_hay_espacio = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dma_despertar_vaciado = PTHREAD_COND_INITIALIZER;
+static int vaciado_pendiente = 0;   // Hay un vaciado de la caché en la cola
+
+// Pausa para tomar un checkpoint: el hilo no saca trabajo nuevo
+static int dma_ocupado = 0;         // El hilo está atendiendo una solicitud
+static int dma_pausado = 0;
+static pthread_cond_t dma_inactivo = PTHREAD_COND_INITIALIZER;
+
+// Dueños de las transferencias terminadas, en el orden de sus INT_IO_FIN
+static int completadas[DMA_MAX_SOLICITUDES];
+static int completadas_inicio = 0, completadas_cantidad = 0;
+
+// Estadísticas
+static unsigned long long dma_completadas = 0;
+static struct timespec dma_arranque;
+
+static void dma_reporte();
+
+// Valida la cabecera de una imagen existente y adopta su geometría
+static int leer_cabecera(const CabeceraDisco_t *cab, off_t tamano_archivo) {
+    long total;
+
+    if (memcmp(cab->magico, DISCO_MAGICO, sizeof(DISCO_MAGICO)) != 0 ||
+        cab->version != DISCO_VERSION || cab->tamano_sector != TAMANO_SECTOR) {
+        LOG_ERROR("[DISCO] Error: La imagen no es un disco valido (version %d)\n", DISCO_VERSION);
+        return 0;
+    }
+    if (cab->pistas == 0 || cab->cilindros == 0 || cab->sectores == 0 ||
+        cab->pistas > INT32_MAX || cab->cilindros > INT32_MAX || cab->sectores > INT32_MAX) {
+        LOG_ERROR("[DISCO] Error: Geometria invalida en la cabecera\n");
+        return 0;
+    }
+
+    total = (long)cab->pistas * cab->cilindros * cab->sectores;
+    if (tamano_archivo < DISCO_CABECERA + total * TAMANO_SECTOR) {
+        LOG_ERROR("[DISCO] Error: Imagen truncada (%ld bytes, se esperaban %ld)\n",
+            (long)tamano_archivo, DISCO_CABECERA + total * TAMANO_SECTOR);
+        return 0;
+    }
+
+    disco.pistas = cab->pistas;
+    disco.cilindros = cab->cilindros;
+    disco.sectores = cab->sectores;
+    return 1;
+}
+
+// Abre (o crea) la imagen y deja en disco.fd el descriptor y la geometría
+static int abrir_imagen(const char *ruta, int pistas, int cilindros, int sectores) {
+    struct stat info;
+    CabeceraDisco_t cab;
+    long total;
+
+    disco.fd = open(ruta, O_RDWR | O_CREAT, 0644);
+    if (disco.fd < 0 || fstat(disco.fd, &info) != 0) {
+        perror("[ERROR] No se pudo abrir la imagen de disco");
+        return 0;
+    }
+
+    // Imagen existente: manda la geometría de la cabecera
+    if (info.st_size > 0) {
+        if (pread(disco.fd, &cab, sizeof(cab), 0) != sizeof(cab)) {
+            LOG_ERROR("[DISCO] Error: No se pudo leer la cabecera de %s\n", ruta);
+            return 0;
+        }
+        if (!leer_cabecera(&cab, info.st_size)) return 0;
+        if (disco.pistas != pistas || disco.cilindros != cilindros || disco.sectores != sectores) {
+            logger_log("[DISCO] Se usa la geometria de la imagen (%dx%dx%d)\n",
+                disco.pistas, disco.cilindros, disco.sectores);
+        }
+        return 1;
+    }
+
+    // Imagen nueva: se agranda con ftruncate, así queda dispersa: los
+    // sectores que nunca se escriben no ocupan espacio y se leen como cero
+    total = (long)pistas * cilindros * sectores;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magico, DISCO_MAGICO, sizeof(DISCO_MAGICO));
+    cab.version = DISCO_VERSION;
+    cab.tamano_sector = TAMANO_SECTOR;
+    cab.pistas = pistas;
+    cab.cilindros = cilindros;
+    cab.sectores = sectores;
+
+    if (ftruncate(disco.fd, DISCO_CABECERA + total * TAMANO_SECTOR) != 0 ||
+        pwrite(disco.fd, &cab, sizeof(cab), 0) != sizeof(cab)) {
+        perror("[ERROR] No se pudo crear la imagen de disco");
+        return 0;
+    }
+
+    disco.pistas = pistas;
+    disco.cilindros = cilindros;
+    disco.sectores = sectores;
+    logger_log("[DISCO] Imagen nueva creada: %s\n", ruta);
+    return 1;
+}
+
+int inicializar_disco(const char *ruta, int pistas, int cilindros, int sectores) {
     memset(&disco, 0, sizeof(Disco_t));
-    
+    disco.fd = -1;
+
+    if (pistas <= 0 || cilindros <= 0 || sectores <= 0) {
+        LOG_ERROR("[DISCO] Error: Geometria invalida (%dx%dx%d)\n", pistas, cilindros, sectores);
+        return 0;
+    }
+
+    if (ruta != NULL) {
+        if (!abrir_imagen(ruta, pistas, cilindros, sectores)) {
+            cerrar_disco();
+            return 0;
+        }
+    } else {
+        disco.pistas = pistas;
+        disco.cilindros = cilindros;
+        disco.sectores = sectores;
+    }
+    disco.total_sectores = (long)disco.pistas * disco.cilindros * disco.sectores;
+
+    // Un solo mmap: arrancar contra una imagen grande no lee nada del
+    // archivo, las páginas se traen cuando el DMA las toca. El disco
+    // volátil es un mapeo anónimo (el kernel lo entrega en ceros).
+    disco.tamano_mapa = DISCO_CABECERA + disco.total_sectores * TAMANO_SECTOR;
+    if (disco.fd >= 0) {
+        disco.mapa = mmap(NULL, disco.tamano_mapa, PROT_READ | PROT_WRITE, MAP_SHARED, disco.fd, 0);
+    } else {
+        disco.mapa = mmap(NULL, disco.tamano_mapa, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+    if (disco.mapa == MAP_FAILED) {
+        perror("[ERROR] No se pudo mapear el disco");
+        disco.mapa = NULL;
+        cerrar_disco();
+        return 0;
+    }
+    disco.plato = (Sector_t *)((char *)disco.mapa + DISCO_CABECERA);
+
+    if (!cache_iniciar()) {
+        cerrar_disco();
+        return 0;
+    }
+
     // Inicializamos el DMA
     dma.pista_seleccionada = 0;
     dma.cilindro_seleccionado = 0;
     dma.sector_seleccionado = 0;
     dma.direccion_memoria = 0;
     dma.es_escritura = 0;
-    dma.estado = 0; // 0 = Éxito por defecto
-    dma.activo = 0;
-    
-    logger_log("[DISCO] Hardware inicializado (10 pistas, 10 cilindros, 100 sectores).\n");
+    dma.cantidad = 1;   // Una palabra por transferencia, como en la Fase 1
+    atomic_store_explicit(&dma_controlador.estado, 0, memory_order_relaxed); // 0 = Éxito por defecto
+    atomic_store_explicit(&dma_controlador.activo, 0, memory_order_relaxed);
+
+    cola_cantidad = 0;
+    dma_detener = 0;
+    dma_ocupado = dma_pausado = 0;
+    vaciado_pendiente = 0;
+    completadas_inicio = completadas_cantidad = 0;
+    dma_completadas = 0;
+    clock_gettime(CLOCK_MONOTONIC, &dma_arranque);
+    pd_reiniciar();
+
+    logger_log("[DISCO] Hardware inicializado (%d pistas, %d cilindros, %d sectores, %s).\n",
+        disco.pistas, disco.cilindros, disco.sectores, ruta != NULL ? ruta : "volatil");
+    return 1;
+}
+
+void cerrar_disco() {
+    cache_liberar();
+    if (disco.mapa != NULL) {
+        // Solo se escriben las páginas que el DMA ensució
+        if (disco.fd >= 0) msync(disco.mapa, disco.tamano_mapa, MS_SYNC);
+        munmap(disco.mapa, disco.tamano_mapa);
+    }
+    if (disco.fd >= 0) close(disco.fd);
+
+    disco.mapa = NULL;
+    disco.plato = NULL;
+    disco.fd = -1;
+}
+
+void disco_escribir_directo(long primero, const Sector_t *valores, int cantidad) {
+    if (valores != NULL) memcpy(&disco.plato[primero], valores, cantidad * sizeof(Sector_t));
+    else memset(&disco.plato[primero], 0, cantidad * sizeof(Sector_t));
+    checkpoint_marcar_disco(primero, cantidad);
+}
+
+// Mete una solicitud en la cola y despierta al hilo del DMA
+static void encolar_solicitud(const SolicitudDMA_t *nueva) {
+    pthread_mutex_lock(&dma_mutex);
+
+    // Cola llena: la CPU espera a que el DMA libere un lugar (como un bus ocupado)
+    while (cola_cantidad == DMA_MAX_SOLICITUDES && !dma_detener) {
+        pthread_cond_wait(&dma_hay_espacio, &dma_mutex);
+    }
+    if (cola_cantidad == DMA_MAX_SOLICITUDES) { // Apagando: se descarta
+        pthread_mutex_unlock(&dma_mutex);
+        return;
+    }
+
+    cola_dma[cola_cantidad] = *nueva;
+    cola_dma[cola_cantidad].llegada_us = pd_ahora_us();
+    cola_cantidad++;
+    if (nueva->cadena == DMA_VACIADO) vaciado_pendiente = 1;
+    else atomic_store_explicit(&dma_controlador.activo, 1, memory_order_relaxed);
+
+    pthread_cond_signal(&dma_hay_trabajo);
+    pthread_mutex_unlock(&dma_mutex);
+}
+
+// Lo llama SDMAON: toma una foto de los registros y la encola
+void dma_encolar(int pid) {
+    SolicitudDMA_t s;
+
+    s.pista = dma.pista_seleccionada;
+    s.cilindro = dma.cilindro_seleccionado;
+    s.sector = dma.sector_seleccionado;
+    s.direccion_memoria = dma.direccion_memoria;
+    s.es_escritura = dma.es_escritura;
+    s.cantidad = dma.cantidad;
+    s.cadena = -1;
+    s.pid = pid;
+    encolar_solicitud(&s);
+}
+
+// Lo llama SDMACAD: el hilo leerá los descriptores desde Mem[direccion]
+void dma_encolar_cadena(int direccion, int pid) {
+    SolicitudDMA_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.cadena = direccion;
+    s.pid = pid;
+    encolar_solicitud(&s);
+}
+
+int dma_siguiente_completada() {
+    int pid = -1;
+
+    pthread_mutex_lock(&dma_mutex);
+    if (completadas_cantidad > 0) {
+        pid = completadas[completadas_inicio];
+        completadas_inicio = (completadas_inicio + 1) % DMA_MAX_SOLICITUDES;
+        completadas_cantidad--;
+    }
+    pthread_mutex_unlock(&dma_mutex);
+    return pid;
+}
+
+void dma_pausar() {
+    pthread_mutex_lock(&dma_mutex);
+    while ((cola_cantidad > 0 || dma_ocupado) && !dma_detener) {
+        pthread_cond_wait(&dma_inactivo, &dma_mutex);
+    }
+    dma_pausado = 1;
+    pthread_mutex_unlock(&dma_mutex);
+}
+
+void dma_reanudar() {
+    pthread_mutex_lock(&dma_mutex);
+    dma_pausado = 0;
+    pthread_cond_signal(&dma_hay_trabajo);
+    pthread_mutex_unlock(&dma_mutex);
+}
+
+// Pide al hilo del DMA que termine cuando vacíe la cola
+void detener_dma() {
+    pthread_mutex_lock(&dma_mutex);
+    dma_detener = 1;
+    pthread_cond_broadcast(&dma_inactivo);
+    pthread_cond_broadcast(&dma_hay_trabajo);
+    pthread_cond_broadcast(&dma_hay_espacio);
+    pthread_cond_broadcast(&dma_despertar_vaciado);
+    pthread_mutex_unlock(&dma_mutex);
+}
+
+// --- HILO DE VACIADO ---
+// Cada cache_periodo_ms encola un vaciado de los sectores sucios. El
+// vaciado lo hace el hilo del DMA, que es el único que toca el disco.
+void *hilo_vaciado(void *arg) {
+    SolicitudDMA_t s;
+    struct timespec limite;
+
+    memset(&s, 0, sizeof(s));
+    s.cadena = DMA_VACIADO;
+
+    if (cache_capacidad <= 0) return NULL;
+
+    pthread_mutex_lock(&dma_mutex);
+    while (!dma_detener) {
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_sec += cache_periodo_ms / 1000;
+        limite.tv_nsec += (cache_periodo_ms % 1000) * 1000000L;
+        if (limite.tv_nsec >= 1000000000L) {
+            limite.tv_sec++;
+            limite.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&dma_despertar_vaciado, &dma_mutex, &limite);
+
+        if (dma_detener || vaciado_pendiente || cache_sucios() == 0) continue;
+        pthread_mutex_unlock(&dma_mutex);
+        encolar_solicitud(&s);
+        pthread_mutex_lock(&dma_mutex);
+    }
+    pthread_mutex_unlock(&dma_mutex);
+    return NULL;
+}
+
+// El hilo del DMA espera el tiempo mecánico si el disco corre en tiempo real
+static void esperar_disco(long long servicio) {
+    if (dma_tiempo_real && servicio > 0) {
+        usleep(servicio);
+    }
+}
+
+// Mueve 'cantidad' sectores consecutivos desde/hacia RAM[dir..].
+// Retorna el estado para ESTADOdma (0 = éxito, 1 = error).
+static int transferir_rafaga(Maquina_t *maq, int pista, int cilindro, int sector,
+                             int dir, int cantidad, int es_escritura) {
+    long primero, ultimo;
+    Sector_t valores[TAMANO_MEMORIA];   // Una ráfaga más larga se mueve en tramos de este tamaño
+
+    // Verificación de coordenadas (Simulación de hardware): la ráfaga
+    // completa tiene que caber en el disco
+    primero = DISCO_INDICE(pista, cilindro, sector);
+    ultimo = primero + cantidad - 1;
+    if (pista < 0 || pista >= disco.pistas ||
+        cilindro < 0 || cilindro >= disco.cilindros ||
+        sector < 0 || sector >= disco.sectores || cantidad < 1 ||
+        ultimo >= disco.total_sectores) {
+
+        // Requisito PDF: "ESTADOdma... 1=error"
+        LOG_ERROR("[DMA] Error: Coordenadas invalidas (%d, %d, %d) x %d sectores\n",
+            pista, cilindro, sector, cantidad);
+        return 1;
+    }
+
+    // Requisito PDF: Validar direccionamiento de memoria (Protección)
+    // Aunque el DMA suele saltarse esto, para el simulador es bueno validar que 'dir' existe.
+    if (dir < 0 || (long)dir + cantidad > maq->tamano_memoria) {
+        LOG_ERROR("[DMA] Error: Direccion de RAM invalida (%d) x %d palabras\n", dir, cantidad);
+        return 1;
+    }
+
+    // Requisito PDF: Comunicación con el disco se deja al diseñador.
+    // El disco se accede a través de la caché de sectores; el modelo
+    // mecánico solo cobra lo que llega al plato (seek + rotación + lectura).
+    for (int hecho = 0, tramo; hecho < cantidad; hecho += tramo) {
+        tramo = (cantidad - hecho < TAMANO_MEMORIA) ? cantidad - hecho : TAMANO_MEMORIA;
+
+        if (es_escritura == 1) { // 1 = Escribir (RAM -> DISCO)
+            // Sección Crítica: Acceso a Memoria (Arbitraje del Bus)
+            // Requisito PDF: "Debe haber algún tipo de arbitraje"
+            pthread_mutex_lock(&maq->mutex);
+            for (int i = 0; i < tramo; i++) valores[i] = maq->memoria[dir + hecho + i];
+            pthread_mutex_unlock(&maq->mutex);
+
+            esperar_disco(cache_escribir(primero + hecho, valores, tramo));
+        } else { // 0 = Leer (DISCO -> RAM)
+            esperar_disco(cache_leer(primero + hecho, valores, tramo));
+
+            pthread_mutex_lock(&maq->mutex);
+            for (int i = 0; i < tramo; i++) escribir_memoria(dir + hecho + i, valores[i]);
+            pthread_mutex_unlock(&maq->mutex);
+        }
+    }
+
+    if (es_escritura == 1) {
+        ESTAD_SUMAR(&contadores->dma_escrituras, 1);
+        ESTAD_SUMAR(&contadores->dma_sectores_escritos, cantidad);
+        logger_log("[DMA] WRITE: RAM[%d..%d] -> Disco[%d][%d][%d] (%d sectores)\n",
+            dir, dir + cantidad - 1, pista, cilindro, sector, cantidad);
+    } else {
+        ESTAD_SUMAR(&contadores->dma_lecturas, 1);
+        ESTAD_SUMAR(&contadores->dma_sectores_leidos, cantidad);
+        logger_log("[DMA] READ: Disco[%d][%d][%d] (%d sectores) -> RAM[%d..%d]\n",
+            pista, cilindro, sector, cantidad, dir, dir + cantidad - 1);
+    }
+    return 0;
+}
+
+// Recorre una cadena de descriptores en RAM. Cada descriptor es una ráfaga.
+static int transferir_cadena(Maquina_t *maq, int direccion) {
+    int desc[DESC_PALABRAS];
+    int procesados = 0;
+
+    for (int k = 0; k < DMA_MAX_DESCRIPTORES; k++) {
+        int dir = direccion + k * DESC_PALABRAS;
+
+        if (dir < 0 || dir + DESC_PALABRAS > maq->tamano_memoria) {
+            LOG_ERROR("[DMA] Error: Descriptor fuera de la RAM (%d)\n", dir);
+            return 1;
+        }
+
+        // Copiamos el descriptor con el bus tomado (la CPU puede estar escribiéndolo)
+        pthread_mutex_lock(&maq->mutex);
+        memcpy(desc, &maq->memoria[dir], sizeof(desc));
+        pthread_mutex_unlock(&maq->mutex);
+
+        if (desc[DESC_CANTIDAD] == 0) { // Fin de la cadena
+            logger_log("[DMA] Cadena en Mem[%d] completada (%d descriptores)\n", direccion, procesados);
+            return 0;
+        }
+
+        if (transferir_rafaga(maq, desc[DESC_PISTA], desc[DESC_CILINDRO], desc[DESC_SECTOR],
+                              desc[DESC_MEMORIA], desc[DESC_CANTIDAD], desc[DESC_ESCRITURA])) {
+            return 1; // Un descriptor malo aborta el resto de la cadena
+        }
+        procesados++;
+    }
+
+    LOG_ERROR("[DMA] Error: Cadena en Mem[%d] sin terminador (mas de %d descriptores)\n",
+        direccion, DMA_MAX_DESCRIPTORES);
+    return 1;
+}
+
+// Ejecuta una solicitud: una ráfaga simple o una cadena de descriptores
+static void procesar_solicitud(Maquina_t *maq, SolicitudDMA_t *s) {
+    int estado;
+
+    pd_iniciar(s);
+    if (s->cadena >= 0) {
+        estado = transferir_cadena(maq, s->cadena);
+    } else {
+        estado = transferir_rafaga(maq, s->pista, s->cilindro, s->sector,
+                                   s->direccion_memoria, s->cantidad, s->es_escritura);
+    }
+
+    pd_terminar(s);
+    if (estado != 0) ESTAD_SUMAR(&contadores->dma_errores, 1);
+
+    // Requisito PDF: "ESTADOdma... 0=éxito, 1=error"
+    atomic_store_explicit(&dma_controlador.estado, estado, memory_order_release);
 }
 
 // --- HILO DEL DMA ---
+// Duerme en una variable de condición hasta que SDMAON encole trabajo
 void *hilo_dma(void *arg) {
-    CPU_t *cpu_ptr = (CPU_t *)arg;
-
-    while (cpu_ptr->ejecutando) {
-        
-        // 1. Polling: Esperamos a que la instrucción SDMAON active la bandera
-        if (dma.activo) {
-            
-            // Requisito PDF: Comunicación con el disco se deja al diseñador.
-            // Simulamos latencia mecánica (50ms).
-            usleep(50000); 
-
-            // 2. Sección Crítica: Acceso a Memoria (Arbitraje del Bus)
-            // Requisito PDF: "Debe haber algún tipo de arbitraje"
-            pthread_mutex_lock(&cpu_ptr->mutex);
-
-            // Verificación de coordenadas (Simulación de hardware)
-            if (dma.pista_seleccionada >= DISCO_PISTAS || 
-                dma.cilindro_seleccionado >= DISCO_CILINDROS || 
-                dma.sector_seleccionado >= DISCO_SECTORES) {
-                    
-                // Requisito PDF: "ESTADOdma... 1=error"
-                dma.estado = 1; 
-                logger_log("[DMA] Error: Coordenadas invalidas (%d, %d, %d)\n", 
-                    dma.pista_seleccionada, dma.cilindro_seleccionado, dma.sector_seleccionado);
-            } else {
-                // Requisito PDF: "ESTADOdma... 0=éxito"
-                dma.estado = 0;
-
-                // Puntero al sector físico
-                Sector_t *sector = &disco.plato[dma.pista_seleccionada][dma.cilindro_seleccionado][dma.sector_seleccionado];
-                int dir = dma.direccion_memoria;
-
-                // Requisito PDF: Validar direccionamiento de memoria (Protección)
-                // Aunque el DMA suele saltarse esto, para el simulador es bueno validar que 'dir' existe.
-                if (dir < 0 || dir >= TAMANO_MEMORIA) {
-                     dma.estado = 1;
-                     logger_log("[DMA] Error: Direccion de RAM invalida (%d)\n", dir);
-                } else {
-                    if (dma.es_escritura == 1) { // 1 = Escribir (RAM -> DISCO)
-                        snprintf(sector->datos, TAMANO_SECTOR, "%d", cpu_ptr->memoria[dir]);
-                        logger_log("[DMA] WRITE: RAM[%d] (%d) -> Disco[%d][%d][%d]\n",
-                            dir, cpu_ptr->memoria[dir], dma.pista_seleccionada, dma.cilindro_seleccionado, dma.sector_seleccionado);
-                    } else { // 0 = Leer (DISCO -> RAM)
-                        // Convertimos el string del sector a entero
-                        int valor = atoi(sector->datos);
-                        cpu_ptr->memoria[dir] = valor;
-                        logger_log("[DMA] READ: Disco[%d][%d][%d] ('%s') -> RAM[%d] (%d)\n",
-                            dma.pista_seleccionada, dma.cilindro_seleccionado, dma.sector_seleccionado, sector->datos, dir, valor);
-                    }
-                }
-            }
+    Maquina_t *maq = (Maquina_t *)arg;
+    SolicitudDMA_t s;
+    uint64_t espera_us;
+    int elegida;
 
-            // 3. Requisito PDF: "Luego, interrumpe al procesador" (Código 4)
-            // Usamos la bandera que ya tienes implementada en cpu.c
-            if (cpu_ptr->interrupcion_pendiente == 0) {
-                cpu_ptr->interrupcion_pendiente = 1;
-                cpu_ptr->codigo_interrupcion = 4; // 4 = Fin de E/S
+    estadisticas_hilo();
+    while (1) {
+        pthread_mutex_lock(&dma_mutex);
+        while ((cola_cantidad == 0 || dma_pausado) && !dma_detener) {
+            pthread_cond_wait(&dma_hay_trabajo, &dma_mutex);
+        }
+        if (cola_cantidad == 0) { // Detenido y sin trabajo pendiente
+            pthread_mutex_unlock(&dma_mutex);
+            break;
+        }
+        // El planificador decide; el resto de la cola conserva su orden
+        elegida = pd_elegir(cola_dma, cola_cantidad);
+        s = cola_dma[elegida];
+        cola_cantidad--;
+        memmove(&cola_dma[elegida], &cola_dma[elegida + 1],
+                (cola_cantidad - elegida) * sizeof(SolicitudDMA_t));
+        pthread_cond_signal(&dma_hay_espacio);
+        dma_ocupado = 1;
+        pthread_mutex_unlock(&dma_mutex);
+
+        if (s.cadena == DMA_VACIADO) {
+            // Escritura diferida de la caché: no la pidió la CPU, no interrumpe
+            esperar_disco(cache_vaciar());
+            pthread_mutex_lock(&dma_mutex);
+            vaciado_pendiente = 0;
+            dma_ocupado = 0;
+            if (cola_cantidad == 0) {
+                atomic_store_explicit(&dma_controlador.activo, 0, memory_order_relaxed);
+                pthread_cond_broadcast(&dma_inactivo);
             }
+            pthread_mutex_unlock(&dma_mutex);
+            continue;
+        }
 
-            dma.activo = 0; // Apagamos el DMA y liberamos el bus
-            pthread_mutex_unlock(&cpu_ptr->mutex);
-        
-        } else {
-            // Ahorro de CPU mientras espera
-            usleep(10000); 
+        procesar_solicitud(maq, &s);
+
+        // Desde que la CPU la encoló hasta su INT_IO_FIN (cola incluida)
+        espera_us = pd_ahora_us() > s.llegada_us ? (uint64_t)(pd_ahora_us() - s.llegada_us) : 0;
+        ESTAD_SUMAR(&contadores->io_cuenta, 1);
+        ESTAD_SUMAR(&contadores->io_suma_us, espera_us);
+        estad_maximo(&contadores->io_max_us, espera_us);
+
+        pthread_mutex_lock(&dma_mutex);
+        dma_completadas++;
+        if (cola_cantidad == 0) atomic_store_explicit(&dma_controlador.activo, 0, memory_order_relaxed); // Apagamos el DMA
+        // Cada solicitud en vuelo tiene un proceso bloqueado, así que
+        // nunca hay más completadas sin atender que lugares en la cola
+        if (completadas_cantidad < DMA_MAX_SOLICITUDES) {
+            completadas[(completadas_inicio + completadas_cantidad) % DMA_MAX_SOLICITUDES] = s.pid;
+            completadas_cantidad++;
         }
+
+        // Requisito PDF: "Luego, interrumpe al procesador" (Código 4)
+        // El controlador la encola aunque haya otra pendiente
+        // Con varios núcleos la atiende siempre el 0, que despierta a otro si hace falta
+        ic_postear_nucleo(0, INT_IO_FIN); // 4 = Fin de E/S
+
+        // Recién ahora está inactivo: un checkpoint ya ve la interrupción posteada
+        dma_ocupado = 0;
+        if (cola_cantidad == 0) pthread_cond_broadcast(&dma_inactivo);
+        pthread_mutex_unlock(&dma_mutex);
     }
+
+    // Al apagar, lo que quedó sucio en la caché baja al plato
+    cache_vaciar();
+    dma_reporte();
+    pd_reporte();
+    cache_reporte();
     return NULL;
-}
\ No newline at end of file
+}
+
+unsigned long long dma_transferencias() {
+    unsigned long long total;
+
+    pthread_mutex_lock(&dma_mutex);
+    total = dma_completadas;
+    pthread_mutex_unlock(&dma_mutex);
+    return total;
+}
+
+static void dma_reporte() {
+    struct timespec ahora;
+    double segundos;
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    segundos = (ahora.tv_sec - dma_arranque.tv_sec) + (ahora.tv_nsec - dma_arranque.tv_nsec) / 1e9;
+    logger_log("[DMA] %llu transferencias completadas (%.1f por segundo)\n",
+        dma_completadas, segundos > 0 ? dma_completadas / segundos : 0.0);
+}
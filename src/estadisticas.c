@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "../include/estadisticas.h"
+#include "../include/cpu.h"
+#include "../include/logger.h"
+
+#define MAX_BLOQUES 64   // Hilos con bloque propio
+
+int estadisticas_periodo_ms = ESTAD_PERIODO_DEFECTO;
+
+// Bloque de los hilos que todavía no pidieron el suyo
+static Contadores_t bloque_comun;
+__thread Contadores_t *contadores = &bloque_comun;
+
+// Bloques entregados (nunca se liberan: un hilo que terminó sigue sumando)
+static _Atomic(Contadores_t *) bloques[MAX_BLOQUES];
+static atomic_int total_bloques = 0;
+
+static char ruta_exportar[1024] = "";
+static struct timespec arranque;
+
+static const char *OPCODES[OP_MAXIMO + 1] = {
+    "SUM", "RES", "MULT", "DIVI", "LOAD", "STR", "LOADRX", "STRRX",
+    "COMP", "JMPE", "JMPNE", "JMPLT", "JMPLGT", "SVC", "RETRN", "HAB",
+    "DHAB", "TTI", "CHMOD", "LOADRB", "STRRB", "LOADRL", "STRRL", "LOADSP",
+    "STRSP", "PSH", "POP", "J", "SDMAP", "SDMAC", "SDMAS", "SDMAIO",
+    "SDMAM", "SDMAON", "SDMACNT", "SDMACAD"
+};
+
+static const char *MODOS[ESTAD_MODOS] = { "directo", "inmediato", "indexado" };
+
+void estadisticas_hilo() {
+    Contadores_t *c;
+    int n;
+
+    if (contadores != &bloque_comun) return;
+    n = atomic_fetch_add(&total_bloques, 1);
+    if (n >= MAX_BLOQUES) return; // Sin lugar: sigue en el bloque común
+
+    c = aligned_alloc(64, sizeof(Contadores_t));
+    if (c == NULL) return;
+    memset(c, 0, sizeof(*c));
+    contadores = c;
+    atomic_store(&bloques[n], c);
+}
+
+uint64_t estadisticas_total(size_t desplazamiento) {
+    int n = atomic_load(&total_bloques);
+    uint64_t total = atomic_load_explicit((Contador_t *)((char *)&bloque_comun + desplazamiento),
+                                          memory_order_relaxed);
+
+    if (n > MAX_BLOQUES) n = MAX_BLOQUES;
+    for (int i = 0; i < n; i++) {
+        Contadores_t *c = atomic_load(&bloques[i]);
+        if (c == NULL) continue; // Reservado pero aún sin asignar
+        total += atomic_load_explicit((Contador_t *)((char *)c + desplazamiento), memory_order_relaxed);
+    }
+    return total;
+}
+
+// El máximo de un contador entre todos los bloques
+static uint64_t maximo(size_t desplazamiento) {
+    int n = atomic_load(&total_bloques);
+    uint64_t max = atomic_load_explicit((Contador_t *)((char *)&bloque_comun + desplazamiento),
+                                        memory_order_relaxed);
+
+    if (n > MAX_BLOQUES) n = MAX_BLOQUES;
+    for (int i = 0; i < n; i++) {
+        Contadores_t *c = atomic_load(&bloques[i]);
+        uint64_t v;
+
+        if (c == NULL) continue;
+        v = atomic_load_explicit((Contador_t *)((char *)c + desplazamiento), memory_order_relaxed);
+        if (v > max) max = v;
+    }
+    return max;
+}
+
+#define TOTAL(campo) estadisticas_total(offsetof(Contadores_t, campo))
+
+int estadisticas_abrir(const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+
+    if (f == NULL) {
+        perror("[ERROR] No se pudo crear el archivo de estadisticas");
+        return 0;
+    }
+    fclose(f);
+    snprintf(ruta_exportar, sizeof(ruta_exportar), "%s", ruta);
+    clock_gettime(CLOCK_MONOTONIC, &arranque);
+    return 1;
+}
+
+// Una línea clave=valor por contador. Los pares (opcode, modo) solo
+// aparecen si ocurrieron; los totales siempre
+static void escribir(FILE *f) {
+    struct timespec ahora;
+    uint64_t total = 0, por_modo[ESTAD_MODOS] = { 0 }, io = TOTAL(io_cuenta);
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    fprintf(f, "tiempo_ms=%.0f\n",
+        (ahora.tv_sec - arranque.tv_sec) * 1000.0 + (ahora.tv_nsec - arranque.tv_nsec) / 1e6);
+
+    for (int op = 0; op <= OP_MAXIMO; op++) {
+        uint64_t por_opcode = 0;
+
+        for (int m = 0; m < ESTAD_MODOS; m++) {
+            uint64_t v = TOTAL(instrucciones[op * ESTAD_MODOS + m]);
+            if (v == 0) continue;
+            fprintf(f, "instrucciones.%s.%s=%llu\n", OPCODES[op], MODOS[m], (unsigned long long)v);
+            por_opcode += v;
+            por_modo[m] += v;
+        }
+        fprintf(f, "instrucciones.%s=%llu\n", OPCODES[op], (unsigned long long)por_opcode);
+        total += por_opcode;
+    }
+    fprintf(f, "instrucciones.invalidas=%llu\n", (unsigned long long)TOTAL(instrucciones[ESTAD_INVALIDA]));
+    for (int m = 0; m < ESTAD_MODOS; m++) {
+        fprintf(f, "instrucciones.modo.%s=%llu\n", MODOS[m], (unsigned long long)por_modo[m]);
+    }
+    fprintf(f, "instrucciones=%llu\n", (unsigned long long)(total + TOTAL(instrucciones[ESTAD_INVALIDA])));
+
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+        fprintf(f, "interrupciones.%s.posteadas=%llu\n", ic_nombre(i),
+            (unsigned long long)TOTAL(int_posteadas[i]));
+        fprintf(f, "interrupciones.%s.atendidas=%llu\n", ic_nombre(i),
+            (unsigned long long)TOTAL(int_atendidas[i]));
+    }
+
+    fprintf(f, "cpu.fallas_proteccion=%llu\n", (unsigned long long)TOTAL(fallas_proteccion));
+    fprintf(f, "mmu.tlb_aciertos=%llu\n", (unsigned long long)TOTAL(tlb_aciertos));
+    fprintf(f, "mmu.tlb_fallos=%llu\n", (unsigned long long)TOTAL(tlb_fallos));
+    fprintf(f, "mmu.fallos_pagina=%llu\n", (unsigned long long)TOTAL(fallos_pagina));
+    fprintf(f, "mmu.swap_paginas_leidas=%llu\n", (unsigned long long)TOTAL(swap_paginas_leidas));
+    fprintf(f, "mmu.swap_paginas_escritas=%llu\n", (unsigned long long)TOTAL(swap_paginas_escritas));
+    fprintf(f, "mmu.prefetch=%llu\n", (unsigned long long)TOTAL(prefetch_paginas));
+    fprintf(f, "dma.lecturas=%llu\n", (unsigned long long)TOTAL(dma_lecturas));
+    fprintf(f, "dma.escrituras=%llu\n", (unsigned long long)TOTAL(dma_escrituras));
+    fprintf(f, "dma.sectores_leidos=%llu\n", (unsigned long long)TOTAL(dma_sectores_leidos));
+    fprintf(f, "dma.sectores_escritos=%llu\n", (unsigned long long)TOTAL(dma_sectores_escritos));
+    fprintf(f, "dma.errores=%llu\n", (unsigned long long)TOTAL(dma_errores));
+    fprintf(f, "dma.io.cuenta=%llu\n", (unsigned long long)io);
+    fprintf(f, "dma.io.media_us=%.1f\n", io > 0 ? (double)TOTAL(io_suma_us) / io : 0.0);
+    fprintf(f, "dma.io.max_us=%llu\n", (unsigned long long)maximo(offsetof(Contadores_t, io_max_us)));
+}
+
+int estadisticas_exportar() {
+    char temporal[1100];
+    FILE *f;
+
+    if (ruta_exportar[0] == '\0') return 1;
+
+    // Se escribe aparte y se renombra: quien lo lea nunca ve un archivo a medias
+    snprintf(temporal, sizeof(temporal), "%s.tmp", ruta_exportar);
+    f = fopen(temporal, "w");
+    if (f == NULL) return 0;
+    escribir(f);
+    if (fclose(f) != 0 || rename(temporal, ruta_exportar) != 0) {
+        LOG_ERROR("[ERROR] No se pudo exportar %s\n", ruta_exportar);
+        return 0;
+    }
+    return 1;
+}
+
+// --- HILO EXPORTADOR ---
+void *hilo_estadisticas(void *arg) {
+    Maquina_t *maq = (Maquina_t *)arg;
+
+    while (atomic_load_explicit(&maq->ejecutando, memory_order_relaxed)) {
+        // Tramos de 10 ms: al apagarse la máquina sale enseguida
+        for (int ms = 0; ms < estadisticas_periodo_ms && atomic_load_explicit(&maq->ejecutando, memory_order_relaxed); ms += 10) {
+            usleep(10000);
+        }
+        if (atomic_load_explicit(&maq->ejecutando, memory_order_relaxed)) estadisticas_exportar();
+    }
+    return NULL;
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/imagen.h"
+
+// Sin logger: este módulo también lo enlaza bin/asm2img
+
+// --- PARSER DE TEXTO (una sola pasada) ---
+
+static int es_digito(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int es_espacio(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Lee un entero con signo opcional en [*i, fin). Retorna 1 si había uno
+static int leer_entero(const char *t, size_t *i, size_t fin, int *valor) {
+    long long v = 0;
+    int negativo = 0;
+    size_t k = *i;
+
+    if (k < fin && (t[k] == '-' || t[k] == '+')) {
+        negativo = (t[k] == '-');
+        k++;
+    }
+    if (k >= fin || !es_digito(t[k])) return 0;
+    while (k < fin && es_digito(t[k])) {
+        v = v * 10 + (t[k] - '0');
+        if (v > 2147483647LL) return 0;
+        k++;
+    }
+    *valor = (int)(negativo ? -v : v);
+    *i = k;
+    return 1;
+}
+
+// 1 si la línea [i, fin) empieza con 'directiva' seguida de un espacio
+static int es_directiva(const char *t, size_t i, size_t fin, const char *directiva) {
+    size_t largo = strlen(directiva);
+
+    return fin - i > largo && memcmp(t + i, directiva, largo) == 0 && es_espacio(t[i + largo]);
+}
+
+static void saltar_espacios(const char *t, size_t *i, size_t fin) {
+    while (*i < fin && es_espacio(t[*i])) (*i)++;
+}
+
+// Agrega una palabra y su línea (los arreglos crecen al doble)
+static int agregar(Programa_t *p, int *capacidad, int valor, int linea) {
+    if (p->palabras == *capacidad) {
+        int32_t *nuevo;
+        int *lineas;
+        *capacidad = *capacidad ? *capacidad * 2 : 256;
+        nuevo = realloc(p->valores, *capacidad * sizeof(int32_t));
+        if (nuevo == NULL) return 0;
+        p->valores = nuevo;
+        lineas = realloc(p->lineas, *capacidad * sizeof(int));
+        if (lineas == NULL) return 0;
+        p->lineas = lineas;
+    }
+    p->lineas[p->palabras] = linea;
+    p->valores[p->palabras++] = valor;
+    return 1;
+}
+
+int imagen_parsear_texto(const char *texto, size_t largo, Programa_t *p) {
+    size_t i = 0;
+    int linea = 0, linea_start = 0, capacidad = 0;
+
+    memset(p, 0, sizeof(*p));
+    p->declaradas = -1;
+
+    while (i < largo) {
+        size_t fin = i;
+        int valor;
+
+        // La línea es [i, fin)
+        while (fin < largo && texto[fin] != '\n') fin++;
+        linea++;
+        saltar_espacios(texto, &i, fin);
+
+        if (i < fin && (es_digito(texto[i]) ||
+                        ((texto[i] == '-' || texto[i] == '+') && i + 1 < fin && es_digito(texto[i + 1])))) {
+            if (!leer_entero(texto, &i, fin, &valor)) {
+                p->linea_error = linea;
+                return 0;
+            }
+            if (!agregar(p, &capacidad, valor, linea)) {
+                p->linea_error = linea;
+                return 0;
+            }
+        } else if (es_directiva(texto, i, fin, "_start")) {
+            i += 6;
+            saltar_espacios(texto, &i, fin);
+            if (!leer_entero(texto, &i, fin, &p->entrada)) {
+                p->linea_error = linea;
+                return 0;
+            }
+            linea_start = linea;
+        } else if (es_directiva(texto, i, fin, ".NumeroPalabras")) {
+            i += 15;
+            saltar_espacios(texto, &i, fin);
+            if (!leer_entero(texto, &i, fin, &p->declaradas)) {
+                p->linea_error = linea;
+                return 0;
+            }
+        } else if (es_directiva(texto, i, fin, ".NombreProg")) {
+            size_t desde, hasta = fin;
+            i += 11;
+            saltar_espacios(texto, &i, fin);
+            desde = i;
+            while (hasta > desde && es_espacio(texto[hasta - 1])) hasta--;
+            if (hasta - desde >= IMAGEN_NOMBRE) hasta = desde + IMAGEN_NOMBRE - 1;
+            memcpy(p->nombre, texto + desde, hasta - desde);
+            p->nombre[hasta - desde] = '\0';
+        }
+        // Cualquier otra cosa (comentarios, líneas vacías) se ignora
+
+        i = fin + 1;
+    }
+
+    // La entrada tiene que caer dentro del programa
+    if (p->entrada < 0 || (p->palabras > 0 && p->entrada >= p->palabras)) {
+        p->linea_error = linea_start;
+        return 0;
+    }
+    return 1;
+}
+
+void imagen_liberar(Programa_t *p) {
+    free(p->valores);
+    free(p->lineas);
+    p->valores = NULL;
+    p->lineas = NULL;
+    p->palabras = 0;
+}
+
+// --- IMAGEN BINARIA ---
+
+uint32_t imagen_suma(const int32_t *valores, int palabras) {
+    const unsigned char *b = (const unsigned char *)valores;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < (size_t)palabras * sizeof(int32_t); i++) {
+        h = (h ^ b[i]) * 16777619u;
+    }
+    return h;
+}
+
+int imagen_es_binaria(const void *datos, size_t largo) {
+    return largo >= 8 && memcmp(datos, IMAGEN_MAGICO, 8) == 0;
+}
+
+const char *imagen_validar(const void *datos, size_t largo) {
+    const CabeceraImagen_t *c = datos;
+
+    if (largo < sizeof(CabeceraImagen_t) || !imagen_es_binaria(datos, largo)) {
+        return "no es una imagen";
+    }
+    if (c->version != IMAGEN_VERSION || c->tamano_cabecera != sizeof(CabeceraImagen_t)) {
+        return "version de imagen no soportada";
+    }
+    if (c->palabras < 0 ||
+        largo - sizeof(CabeceraImagen_t) < (size_t)c->palabras * sizeof(int32_t)) {
+        return "imagen truncada";
+    }
+    if (c->base < 0 || c->entrada < 0 || (c->palabras > 0 && c->entrada >= c->palabras)) {
+        return "base o entrada fuera del programa";
+    }
+    if (imagen_suma((const int32_t *)((const char *)datos + c->tamano_cabecera), c->palabras) != c->suma) {
+        return "suma de verificacion incorrecta";
+    }
+    return NULL;
+}
+
+int imagen_escribir(const char *ruta, const Programa_t *p, int base) {
+    CabeceraImagen_t c;
+    FILE *f = fopen(ruta, "wb");
+    int exito;
+
+    if (f == NULL) return 0;
+
+    memset(&c, 0, sizeof(c));
+    memcpy(c.magico, IMAGEN_MAGICO, sizeof(c.magico));
+    c.version = IMAGEN_VERSION;
+    c.tamano_cabecera = sizeof(c);
+    memcpy(c.nombre, p->nombre, sizeof(c.nombre));
+    c.entrada = p->entrada;
+    c.palabras = p->palabras;
+    c.base = base;
+    c.suma = imagen_suma(p->valores, p->palabras);
+
+    exito = fwrite(&c, sizeof(c), 1, f) == 1 &&
+            (p->palabras == 0 || fwrite(p->valores, sizeof(int32_t), p->palabras, f) == (size_t)p->palabras);
+    return fclose(f) == 0 && exito;
+}
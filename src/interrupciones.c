@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <time.h>
+#include "../include/interrupciones.h"
+#include "../include/logger.h"
+#include "../include/estadisticas.h"
+
+PendientesNucleo_t ic_pendientes[MAX_NUCLEOS];
+
+// Los contadores por fuente (posteadas / atendidas) van en el bloque de
+// estadísticas del hilo que postea o atiende
+
+// Latencia posteo -> despacho. Se mide la ocurrencia que levanta el bit
+// (su marca va en PendientesNucleo_t): las que llegan con el bit ya arriba
+// se atienden en la misma pasada
+static atomic_ullong latencia_cuenta[TOTAL_INTERRUPCIONES];
+static atomic_ullong latencia_suma_ns[TOTAL_INTERRUPCIONES];
+static atomic_ullong latencia_max_ns[TOTAL_INTERRUPCIONES];
+
+static long long ahora_ns() {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+// Prioridad fija: primero los errores (detienen la máquina), luego las
+// llamadas al sistema y por último los dispositivos.
+static const int PRIORIDAD[TOTAL_INTERRUPCIONES] = {
+    INT_DIR_INVALIDA,
+    INT_INST_ILLEGAL,
+    INT_OVERFLOW,
+    INT_UNDERFLOW,
+    INT_COD_INVALIDO,
+    INT_SVC_INVALIDO,
+    INT_SYSCALL,
+    INT_FALLO_PAGINA,
+    INT_IO_FIN,
+    INT_IPI,
+    INT_RELOJ,
+};
+
+static const char *NOMBRES[TOTAL_INTERRUPCIONES] = {
+    "SVC_INVALIDO", "COD_INVALIDO", "SYSCALL", "RELOJ", "IO_FIN",
+    "INST_ILLEGAL", "DIR_INVALIDA", "UNDERFLOW", "OVERFLOW", "IPI",
+    "FALLO_PAGINA",
+};
+
+void ic_reiniciar() {
+    for (int n = 0; n < MAX_NUCLEOS; n++) {
+        atomic_store(&ic_pendientes[n].mascara, 0);
+        for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+            atomic_store(&ic_pendientes[n].cuenta[i], 0);
+            atomic_store(&ic_pendientes[n].posteada_ns[i], 0);
+        }
+    }
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+        atomic_store(&latencia_cuenta[i], 0);
+        atomic_store(&latencia_suma_ns[i], 0);
+        atomic_store(&latencia_max_ns[i], 0);
+    }
+}
+
+void ic_postear_nucleo(int nucleo, int codigo) {
+    PendientesNucleo_t *p = &ic_pendientes[nucleo];
+
+    if (codigo < 0 || codigo >= TOTAL_INTERRUPCIONES) {
+        codigo = INT_COD_INVALIDO;
+    }
+
+    ESTAD_SUMAR(&contadores->int_posteadas[codigo], 1);
+    // La marca va antes que el bit: el núcleo que lo vea ya la encuentra
+    if (!(atomic_load_explicit(&p->mascara, memory_order_relaxed) & (1u << codigo))) {
+        atomic_store_explicit(&p->posteada_ns[codigo], ahora_ns(), memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&p->cuenta[codigo], 1, memory_order_relaxed);
+    // release: lo que el dispositivo escribió antes (p.ej. la RAM del DMA)
+    // queda visible para la CPU cuando vea el bit
+    atomic_fetch_or_explicit(&p->mascara, 1u << codigo, memory_order_release);
+}
+
+void ic_postear(int codigo) {
+    ic_postear_nucleo(cpu.nucleo, codigo);
+}
+
+void ic_difundir(int codigo) {
+    for (int n = 0; n < maquina.nucleos; n++) {
+        ic_postear_nucleo(n, codigo);
+    }
+}
+
+static void registrar_latencia(int codigo) {
+    long long desde = atomic_exchange_explicit(&ic_pendientes[cpu.nucleo].posteada_ns[codigo], 0, memory_order_relaxed);
+    unsigned long long ns, max;
+
+    if (desde == 0) return;
+    ns = ahora_ns() - desde;
+    atomic_fetch_add_explicit(&latencia_cuenta[codigo], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&latencia_suma_ns[codigo], ns, memory_order_relaxed);
+    max = atomic_load_explicit(&latencia_max_ns[codigo], memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak(&latencia_max_ns[codigo], &max, ns)) {
+        // Otro núcleo subió el máximo: 'max' ya trae el valor nuevo
+    }
+}
+
+int ic_siguiente() {
+    atomic_uint *pendientes = &ic_pendientes[cpu.nucleo].mascara;
+    atomic_uint *cuenta = ic_pendientes[cpu.nucleo].cuenta;
+    unsigned int mascara = atomic_load_explicit(pendientes, memory_order_acquire);
+
+    if (mascara == 0) return -1;
+
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+        int codigo = PRIORIDAD[i];
+        unsigned int bit = 1u << codigo;
+
+        if (!(mascara & bit)) continue;
+
+        if (atomic_fetch_sub_explicit(&cuenta[codigo], 1, memory_order_acq_rel) == 1) {
+            // Era la última ocurrencia: bajamos el bit. Si un dispositivo
+            // posteó justo en medio, la cuenta ya no es 0 y lo volvemos a subir.
+            atomic_fetch_and_explicit(pendientes, ~bit, memory_order_acq_rel);
+            if (atomic_load_explicit(&cuenta[codigo], memory_order_acquire) > 0) {
+                atomic_fetch_or_explicit(pendientes, bit, memory_order_release);
+            }
+        }
+        ESTAD_SUMAR(&contadores->int_atendidas[codigo], 1);
+        registrar_latencia(codigo);
+        return codigo;
+    }
+    return -1;
+}
+
+unsigned long long ic_posteadas(int codigo) {
+    return estadisticas_total(offsetof(Contadores_t, int_posteadas[codigo]));
+}
+
+unsigned long long ic_atendidas(int codigo) {
+    return estadisticas_total(offsetof(Contadores_t, int_atendidas[codigo]));
+}
+
+unsigned long long ic_latencia(int codigo, double *media_us, double *max_us) {
+    unsigned long long cuenta = 0, suma = 0, max = 0;
+
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+        if (codigo >= 0 && i != codigo) continue;
+        cuenta += atomic_load_explicit(&latencia_cuenta[i], memory_order_relaxed);
+        suma += atomic_load_explicit(&latencia_suma_ns[i], memory_order_relaxed);
+        if (atomic_load_explicit(&latencia_max_ns[i], memory_order_relaxed) > max) {
+            max = atomic_load_explicit(&latencia_max_ns[i], memory_order_relaxed);
+        }
+    }
+    *media_us = cuenta > 0 ? suma / 1000.0 / cuenta : 0;
+    *max_us = max / 1000.0;
+    return cuenta;
+}
+
+const char *ic_nombre(int codigo) {
+    if (codigo < 0 || codigo >= TOTAL_INTERRUPCIONES) return "?";
+    return NOMBRES[codigo];
+}
+
+void ic_reporte() {
+    logger_log("[INT] Interrupciones por fuente (posteadas / atendidas):\n");
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) {
+        unsigned long long p = ic_posteadas(i);
+        double media, max;
+
+        if (p == 0) continue;
+        ic_latencia(i, &media, &max);
+        logger_log("[INT]   %-12s (Cod %d): %llu / %llu, latencia media %.1f us, maxima %.1f us\n",
+            NOMBRES[i], i, p, ic_atendidas(i), media, max);
+    }
+}
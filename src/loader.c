@@ -1,53 +1,130 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "../include/cpu.h"
 #include "../include/constantes.h"
 #include "../include/loader.h"
+#include "../include/imagen.h"
 #include "../include/logger.h"
+#include "../include/perfil.h"
+#include "../include/mmu.h"
 
-int cargar_programa(const char *nombre_archivo) {
-    FILE *archivo;
-    char linea[256];
-    int direccion_actual = INICIO_USUARIO; // Empezamos a cargar desde la 300
-    int instruccion;
+// Copia las palabras a Mem[base + desplazamiento..] si caben en la partición
+// y le avisa al perfilador de dónde salieron. Con una tabla de páginas
+// (tabla >= 0) base..limite es lógico y se copia de a una página
+static int copiar_a_memoria(const char *nombre_archivo, const int32_t *valores, const int *lineas,
+                            int palabras, int desplazamiento, int base, int limite, int tabla) {
+    int dir = base + desplazamiento;
+
+    if (palabras > limite - base + 1 - desplazamiento) {
+        LOG_ERROR("[ERROR] El programa es demasiado grande para su particion (%d-%d).\n",
+            base, limite);
+        return 0;
+    }
+
+    // Guardamos en la RAM de nuestra CPU (y queda decodificada)
+    if (tabla < 0) {
+        if (palabras > 0) escribir_bloque(dir, valores, palabras);
+        perfil_fuente(nombre_archivo, dir, palabras, lineas);
+    } else {
+        for (int i = 0; i < palabras; ) {
+            int trozo = PAGINA - ((dir + i) & (PAGINA - 1));
+            int fisica;
+
+            if (trozo > palabras - i) trozo = palabras - i;
+            // Con memoria virtual la página va al swap y no tiene dirección física
+            fisica = mmu_escribir_logica(tabla, (limite + 1) / PAGINA, dir + i, valores + i, trozo);
+            if (fisica >= 0) perfil_fuente(nombre_archivo, fisica, trozo, lineas != NULL ? lineas + i : NULL);
+            i += trozo;
+        }
+    }
+    LOG_DEBUG("[MEM] %s: %d palabras en %04d-%04d.\n", nombre_archivo, palabras,
+        dir, dir + palabras - 1);
+    return 1;
+}
+
+// Imagen binaria: se valida la cabecera y se copia directo desde el mapeo
+static int cargar_imagen(const char *nombre_archivo, const void *datos, size_t largo,
+                         int base, int limite, int tabla, int *entrada) {
+    const CabeceraImagen_t *c = datos;
+    const char *motivo = imagen_validar(datos, largo);
+
+    if (motivo != NULL) {
+        LOG_ERROR("[ERROR] %s: %s.\n", nombre_archivo, motivo);
+        return 0;
+    }
+    if (!copiar_a_memoria(nombre_archivo, (const int32_t *)((const char *)datos + c->tamano_cabecera),
+                          NULL, c->palabras, c->base, base, limite, tabla)) {
+        return 0;
+    }
+
+    *entrada = base + c->base + c->entrada;
+    logger_log("[LOADER] Imagen %.*s cargada. %d palabras, entrada en %d.\n",
+        IMAGEN_NOMBRE, c->nombre, c->palabras, *entrada);
+    return 1;
+}
+
+// Texto .asm: una pasada del parser y una sola copia a la RAM
+static int cargar_texto(const char *nombre_archivo, const char *texto, size_t largo,
+                        int base, int limite, int tabla, int *entrada) {
+    Programa_t p;
+
+    if (!imagen_parsear_texto(texto, largo, &p)) {
+        LOG_ERROR("[ERROR] %s:%d: linea invalida.\n", nombre_archivo, p.linea_error);
+        imagen_liberar(&p);
+        return 0;
+    }
+    if (p.declaradas >= 0 && p.declaradas != p.palabras) {
+        logger_log("[LOADER] Aviso: .NumeroPalabras dice %d pero hay %d palabras.\n",
+            p.declaradas, p.palabras);
+    }
+    if (!copiar_a_memoria(nombre_archivo, p.valores, p.lineas, p.palabras, 0, base, limite, tabla)) {
+        imagen_liberar(&p);
+        return 0;
+    }
+
+    *entrada = base + p.entrada;
+    logger_log("[LOADER] Carga completada. %d instrucciones cargadas, entrada en %d.\n",
+        p.palabras, *entrada);
+    imagen_liberar(&p);
+    return 1;
+}
+
+int cargar_programa(const char *nombre_archivo, int base, int limite, int tabla, int *entrada) {
+    struct stat info;
+    void *datos = NULL;
+    int fd, exito;
 
     logger_log("[LOADER] Abriendo archivo: %s\n", nombre_archivo);
 
-    archivo = fopen(nombre_archivo, "r");
-    if (archivo == NULL) {
+    fd = open(nombre_archivo, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) != 0) {
         perror("[ERROR] No se pudo abrir el archivo");
+        if (fd >= 0) close(fd);
         return 0; // Fallo
     }
 
-    // Leemos línea por línea
-    while (fgets(linea, sizeof(linea), archivo)) {
-        // Ignoramos líneas que empiezan con punto (.) o guion bajo (_)
-        // o que están vacías
-        if (linea[0] == '.' || linea[0] == '_' || linea[0] == '\n' || linea[0] == ' ') {
-            continue;
-        }
-
-        // Intentamos leer un número decimal de 8 dígitos al inicio de la línea
-        // %d lee decimales
-        if (sscanf(linea, "%d", &instruccion) == 1) {
-            // Verificar que no desbordemos la memoria
-            if (direccion_actual >= TAMANO_MEMORIA) {
-                logger_log("[ERROR] El programa es demasiado grande para la memoria.\n");
-                break;
-            }
-
-            // Guardamos en la RAM de nuestra CPU
-            cpu.memoria[direccion_actual] = instruccion;
-            
-            logger_log("[MEM] Dir %04d: %08d cargado.\n", direccion_actual, instruccion);
-            
-            direccion_actual++;
+    // El archivo entero se mapea: ni el texto ni la imagen se copian a un buffer
+    if (info.st_size > 0) {
+        datos = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (datos == MAP_FAILED) {
+            perror("[ERROR] No se pudo mapear el archivo");
+            close(fd);
+            return 0;
         }
     }
+    close(fd);
 
-    fclose(archivo);
-    logger_log("[LOADER] Carga completada. %d instrucciones cargadas.\n", direccion_actual - INICIO_USUARIO);
+    if (imagen_es_binaria(datos, info.st_size)) {
+        exito = cargar_imagen(nombre_archivo, datos, info.st_size, base, limite, tabla, entrada);
+    } else {
+        exito = cargar_texto(nombre_archivo, datos, info.st_size, base, limite, tabla, entrada);
+    }
 
-    return 1; // Éxito
-}
\ No newline at end of file
+    if (datos != NULL) munmap(datos, info.st_size);
+    return exito; // 1 = Éxito
+}
@@ -1,41 +1,221 @@
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <stdatomic.h>
 #include "../include/logger.h"
 
+// ====================================================
+// LOGGER ASÍNCRONO
+// ====================================================
+// Cada hilo que escribe (CPU, Timer, DMA, main) tiene su propio anillo
+// de bytes. El productor formatea y copia su mensaje sin tomar ningún
+// candado (un solo productor y un solo consumidor por anillo). Un hilo
+// escritor vacía todos los anillos hacia la consola y el archivo en
+// bloques grandes, con un solo fflush por pasada.
+
+#define TAMANO_ANILLO   (64 * 1024)  // Bytes por hilo productor
+#define MAX_ANILLOS     64           // Hilos productores distintos
+#define MAX_MENSAJE     1024         // Largo máximo de un mensaje formateado
+#define ESPERA_ESCRITOR 2000000      // ns que duerme el escritor si no hay nada
+
+typedef struct {
+    char datos[TAMANO_ANILLO];
+    _Atomic size_t cabeza;  // Total de bytes escritos (solo el productor)
+    _Atomic size_t cola;    // Total de bytes consumidos (solo el escritor)
+} Anillo_t;
+
 // Puntero al archivo de log (privado para este modulo)
 static FILE *log_file = NULL;
 
+int logger_nivel = LOG_NIVEL_INFO;
+
+static _Atomic(Anillo_t *) anillos[MAX_ANILLOS];
+static _Atomic int total_anillos = 0;
+static __thread Anillo_t *anillo_local = NULL;
+
+static pthread_t hilo_escritor_id;
+static atomic_int escritor_activo = 0;
+static atomic_int detener_escritor = 0;
+
+// Camino síncrono (antes de init, después de close o sin anillo libre)
+static pthread_mutex_t mutex_directo = PTHREAD_MUTEX_INITIALIZER;
+
+static void escribir_directo(const char *texto, size_t largo) {
+    pthread_mutex_lock(&mutex_directo);
+    fwrite(texto, 1, largo, stdout);
+    if (log_file != NULL) {
+        fwrite(texto, 1, largo, log_file);
+        fflush(log_file);
+    }
+    pthread_mutex_unlock(&mutex_directo);
+}
+
+// Vacía un anillo hacia la consola y el archivo. Retorna los bytes escritos.
+static size_t drenar_anillo(Anillo_t *a) {
+    size_t cola = atomic_load_explicit(&a->cola, memory_order_relaxed);
+    size_t cabeza = atomic_load_explicit(&a->cabeza, memory_order_acquire);
+    size_t pendiente = cabeza - cola;
+    size_t inicio = cola % TAMANO_ANILLO;
+    size_t primero = pendiente;
+
+    if (pendiente == 0) return 0;
+
+    // El bloque puede dar la vuelta al final del arreglo
+    if (inicio + primero > TAMANO_ANILLO) {
+        primero = TAMANO_ANILLO - inicio;
+    }
+
+    fwrite(a->datos + inicio, 1, primero, stdout);
+    if (log_file != NULL) fwrite(a->datos + inicio, 1, primero, log_file);
+    if (pendiente > primero) {
+        fwrite(a->datos, 1, pendiente - primero, stdout);
+        if (log_file != NULL) fwrite(a->datos, 1, pendiente - primero, log_file);
+    }
+
+    atomic_store_explicit(&a->cola, cabeza, memory_order_release);
+    return pendiente;
+}
+
+static size_t drenar_todo() {
+    size_t total = 0;
+    int n = atomic_load_explicit(&total_anillos, memory_order_acquire);
+
+    for (int i = 0; i < n && i < MAX_ANILLOS; i++) {
+        Anillo_t *a = atomic_load_explicit(&anillos[i], memory_order_acquire);
+        if (a != NULL) total += drenar_anillo(a);
+    }
+    if (total > 0) {
+        fflush(stdout);
+        if (log_file != NULL) fflush(log_file);
+    }
+    return total;
+}
+
+// --- HILO ESCRITOR ---
+static void *hilo_escritor(void *arg) {
+    struct timespec espera = {0, ESPERA_ESCRITOR};
+
+    while (!atomic_load(&detener_escritor)) {
+        if (drenar_todo() == 0) {
+            nanosleep(&espera, NULL);
+        }
+    }
+    // Último vaciado: los productores ya terminaron
+    drenar_todo();
+    return NULL;
+}
+
+// Anillo del hilo actual (se crea y registra la primera vez)
+static Anillo_t *obtener_anillo() {
+    if (anillo_local == NULL) {
+        int indice = atomic_fetch_add(&total_anillos, 1);
+        if (indice >= MAX_ANILLOS) {
+            return NULL; // Sin anillos libres: este hilo escribe directo
+        }
+        Anillo_t *a = calloc(1, sizeof(Anillo_t));
+        if (a == NULL) return NULL;
+        atomic_store_explicit(&anillos[indice], a, memory_order_release);
+        anillo_local = a;
+    }
+    return anillo_local;
+}
+
+static void encolar(const char *texto, size_t largo) {
+    Anillo_t *a;
+    size_t cabeza, inicio, primero;
+
+    if (!atomic_load_explicit(&escritor_activo, memory_order_acquire) ||
+        (a = obtener_anillo()) == NULL) {
+        escribir_directo(texto, largo);
+        return;
+    }
+
+    cabeza = atomic_load_explicit(&a->cabeza, memory_order_relaxed);
+
+    // Si el anillo está lleno esperamos al escritor (no se pierden mensajes)
+    while (TAMANO_ANILLO - (cabeza - atomic_load_explicit(&a->cola, memory_order_acquire)) < largo) {
+        sched_yield();
+    }
+
+    inicio = cabeza % TAMANO_ANILLO;
+    primero = largo;
+    if (inicio + primero > TAMANO_ANILLO) {
+        primero = TAMANO_ANILLO - inicio;
+    }
+    memcpy(a->datos + inicio, texto, primero);
+    memcpy(a->datos, texto + primero, largo - primero);
+
+    atomic_store_explicit(&a->cabeza, cabeza + largo, memory_order_release);
+}
+
+static void log_va(const char *format, va_list args) {
+    char mensaje[MAX_MENSAJE];
+    int largo = vsnprintf(mensaje, sizeof(mensaje), format, args);
+
+    if (largo < 0) return;
+    if (largo >= (int)sizeof(mensaje)) largo = sizeof(mensaje) - 1; // Truncado
+    encolar(mensaje, (size_t)largo);
+}
+
 void logger_init(const char *filename) {
-    log_file = fopen(filename, "w"); 
+    log_file = fopen(filename, "w");
     if (log_file == NULL) {
         perror("Error al crear el archivo de log");
     }
+
+    atomic_store(&detener_escritor, 0);
+    if (pthread_create(&hilo_escritor_id, NULL, hilo_escritor, NULL) == 0) {
+        atomic_store_explicit(&escritor_activo, 1, memory_order_release);
+    } else {
+        perror("Error al crear el hilo del logger (se escribira de forma sincrona)");
+    }
 }
 
 void logger_log(const char *format, ...) {
     va_list args;
 
-    // 1. Escribir en la CONSOLA (Pantalla)
-    // USAMOS vprintf (Estándar de C) -> NO CAMBIAR
+    if (LOG_NIVEL_INFO < logger_nivel) return;
+
+    va_start(args, format);
+    log_va(format, args);
+    va_end(args);
+}
+
+void logger_log_nivel(int nivel, const char *format, ...) {
+    va_list args;
+
+    if (nivel < logger_nivel) return;
+
     va_start(args, format);
-    vprintf(format, args);
+    log_va(format, args);
     va_end(args);
+}
 
-    // 2. Escribir en el ARCHIVO 
-    if (log_file != NULL) {
-        // USAMOS vfprintf (Estándar de C) -> NO CAMBIAR
-        va_start(args, format);
-        vfprintf(log_file, format, args);
-        va_end(args);
-        
-        // Forzamos guardado
-        fflush(log_file);
-    }
+void logger_set_nivel(int nivel) {
+    logger_nivel = nivel;
+}
+
+int logger_nivel_desde_texto(const char *texto) {
+    if (strcmp(texto, "traza") == 0) return LOG_NIVEL_TRAZA;
+    if (strcmp(texto, "debug") == 0) return LOG_NIVEL_DEBUG;
+    if (strcmp(texto, "info") == 0)  return LOG_NIVEL_INFO;
+    if (strcmp(texto, "error") == 0) return LOG_NIVEL_ERROR;
+    return -1;
 }
 
+// Debe llamarse cuando los demás hilos productores ya terminaron
 void logger_close() {
+    if (atomic_exchange(&escritor_activo, 0)) {
+        atomic_store(&detener_escritor, 1);
+        pthread_join(hilo_escritor_id, NULL);
+    }
+
     if (log_file != NULL) {
         fclose(log_file);
         log_file = NULL;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "../include/lote.h"
+#include "../include/cpu.h"
+#include "../include/disco.h"
+#include "../include/procesos.h"
+#include "../include/interrupciones.h"
+#include "../include/logger.h"
+#include "../include/mmu.h"
+
+int lote_trabajadores = 0;
+
+typedef struct {
+    int direccion;
+    int valor;
+} EntradaMemoria_t;
+
+// Una línea del manifiesto
+typedef struct {
+    char programa[256];
+    int AC;
+    int RX;
+    EntradaMemoria_t memoria[LOTE_MAX_MEMORIA];
+    int total_memoria;
+    unsigned long long limite;
+} TrabajoLote_t;
+
+// Lo que deja cada instancia (vive en memoria compartida con los hijos)
+typedef struct {
+    int terminado;      // 1 = la instancia llenó este resultado
+    int codigo;         // INT_* que terminó al programa, SALIDA_LIMITE o LOTE_*
+    int AC;
+    int RX;
+    int SP;
+    int pc;
+    int cc;
+    unsigned long long instrucciones;
+    double ms;
+} ResultadoLote_t;
+
+// Zona compartida: el contador de trabajo y un resultado por programa
+typedef struct {
+    atomic_int siguiente;
+    ResultadoLote_t resultados[];
+} Compartido_t;
+
+static double ms_desde(const struct timespec *inicio) {
+    struct timespec ahora;
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (ahora.tv_sec - inicio->tv_sec) * 1000.0 + (ahora.tv_nsec - inicio->tv_nsec) / 1e6;
+}
+
+// --- MANIFIESTO ---
+// Lee una línea "programa [AC=n] [RX=n] [M<dir>=n] [LIMITE=n]".
+// Retorna 1 si tuvo éxito, 0 si falló
+static int leer_trabajo(char *linea, int numero, TrabajoLote_t *t) {
+    char *token = strtok(linea, " \t\r\n");
+
+    memset(t, 0, sizeof(*t));
+    t->limite = limite_instrucciones ? limite_instrucciones : LOTE_LIMITE_DEFECTO; // --limite
+    snprintf(t->programa, sizeof(t->programa), "%s", token);
+
+    while ((token = strtok(NULL, " \t\r\n")) != NULL) {
+        int dir, valor;
+        unsigned long long limite;
+
+        if (sscanf(token, "AC=%d", &valor) == 1) {
+            t->AC = valor;
+        } else if (sscanf(token, "RX=%d", &valor) == 1) {
+            t->RX = valor;
+        } else if (sscanf(token, "LIMITE=%llu", &limite) == 1) {
+            t->limite = limite;
+        } else if (sscanf(token, "M%d=%d", &dir, &valor) == 2 && t->total_memoria < LOTE_MAX_MEMORIA) {
+            t->memoria[t->total_memoria].direccion = dir;
+            t->memoria[t->total_memoria].valor = valor;
+            t->total_memoria++;
+        } else {
+            LOG_ERROR("[LOTE] Linea %d: entrada invalida '%s'\n", numero, token);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Carga todo el manifiesto en *trabajos. Retorna la cantidad (-1 si falló)
+static int leer_manifiesto(const char *ruta, TrabajoLote_t **trabajos) {
+    FILE *archivo = fopen(ruta, "r");
+    char linea[1024];
+    int total = 0, capacidad = 0, numero = 0;
+
+    *trabajos = NULL;
+    if (archivo == NULL) {
+        LOG_ERROR("[LOTE] No se pudo abrir el manifiesto %s\n", ruta);
+        return -1;
+    }
+
+    while (fgets(linea, sizeof(linea), archivo)) {
+        char *inicio = linea + strspn(linea, " \t");
+
+        numero++;
+        if (*inicio == '#' || *inicio == '\n' || *inicio == '\r' || *inicio == '\0') continue;
+
+        if (total == LOTE_MAX_PROGRAMAS) {
+            LOG_ERROR("[LOTE] Maximo %d programas por manifiesto\n", LOTE_MAX_PROGRAMAS);
+            break;
+        }
+        if (total == capacidad) {
+            TrabajoLote_t *nuevo;
+            capacidad = capacidad ? capacidad * 2 : 64;
+            nuevo = realloc(*trabajos, capacidad * sizeof(TrabajoLote_t));
+            if (nuevo == NULL) {
+                LOG_ERROR("[LOTE] No hay memoria para el manifiesto\n");
+                total = -1;
+                break;
+            }
+            *trabajos = nuevo;
+        }
+        if (!leer_trabajo(inicio, numero, &(*trabajos)[total])) {
+            total = -1;
+            break;
+        }
+        total++;
+    }
+
+    fclose(archivo);
+    if (total < 0) {
+        free(*trabajos);
+        *trabajos = NULL;
+    }
+    return total;
+}
+
+// --- UNA INSTANCIA ---
+// Corre en un proceso hijo recién creado: los globales de la máquina son
+// su propia copia y nada de lo que haga se ve en las demás instancias.
+static void correr_instancia(const TrabajoLote_t *t, ResultadoLote_t *r) {
+    pthread_t timer, dma_id, vaciado;
+    struct timespec inicio;
+    PCB_t *p;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    r->codigo = LOTE_ERROR_CARGA;
+
+    logger_set_nivel(LOG_NIVEL_SILENCIO);
+    modo_ejecucion = MODO_TURBO;
+    dma_tiempo_real = 0;
+    maquina.nucleos = 1;
+    limite_instrucciones = t->limite;
+
+    if (!inicializar_cpu()) return;
+    if (!inicializar_disco(NULL, DISCO_PISTAS, DISCO_CILINDROS, DISCO_SECTORES)) return;
+    pthread_mutex_init(&maquina.mutex, NULL);
+    atomic_store_explicit(&maquina.timer_periodo, 0, memory_order_relaxed);
+    ic_reiniciar();
+    procesos_reiniciar();
+    if (!procesos_crear(t->programa, 0, 1)) return;
+
+    // Entradas: registros iniciales y palabras de la partición
+    p = procesos_pcb(1);
+    p->AC = t->AC;
+    p->RX = t->RX;
+    for (int i = 0; i < t->total_memoria; i++) {
+        int dir = p->RB + t->memoria[i].direccion;
+        if (t->memoria[i].direccion < 0 || dir > p->RL) return;
+        if (paginacion) mmu_escribir_logica(p->PTBR, p->PTLR, dir, &t->memoria[i].valor, 1);
+        else escribir_memoria(dir, t->memoria[i].valor);
+    }
+
+    if (pthread_create(&timer, NULL, hilo_timer, &maquina) != 0) return;
+    if (pthread_create(&dma_id, NULL, hilo_dma, &maquina) != 0) return;
+    if (pthread_create(&vaciado, NULL, hilo_vaciado, NULL) != 0) return;
+
+    ejecutar_cpu();
+    detener_dma();
+    pthread_join(timer, NULL);
+    pthread_join(vaciado, NULL);
+    pthread_join(dma_id, NULL);
+    cerrar_disco();
+
+    // Registros finales: los guardó el último cambio de contexto
+    r->codigo = p->codigo_salida;
+    r->AC = p->AC;
+    r->RX = p->RX;
+    r->SP = p->SP;
+    r->pc = p->psw.pc;
+    r->cc = p->psw.codigo_condicion;
+    r->instrucciones = p->instrucciones;
+    r->ms = ms_desde(&inicio);
+}
+
+// --- TRABAJADORES ---
+// Cada trabajador toma el próximo programa del contador compartido y lo
+// corre en un hijo nuevo (así cada instancia arranca con globales limpios).
+static void trabajador(const TrabajoLote_t *trabajos, int total, Compartido_t *compartido) {
+    int i;
+
+    while ((i = atomic_fetch_add(&compartido->siguiente, 1)) < total) {
+        ResultadoLote_t *r = &compartido->resultados[i];
+        pid_t hijo = fork();
+
+        if (hijo == 0) {
+            correr_instancia(&trabajos[i], r);
+            r->terminado = 1;
+            _exit(0);
+        }
+        if (hijo > 0) waitpid(hijo, NULL, 0);
+        if (!r->terminado) r->codigo = LOTE_CAIDA; // Murió por una señal o no se pudo crear
+    }
+}
+
+static const char *nombre_salida(int codigo) {
+    switch (codigo) {
+        case SALIDA_LIMITE:     return "LIMITE";
+        case LOTE_ERROR_CARGA:  return "ERROR_CARGA";
+        case LOTE_CAIDA:        return "CAIDA";
+        default:                return ic_nombre(codigo);
+    }
+}
+
+int lote_ejecutar(const char *manifiesto) {
+    TrabajoLote_t *trabajos;
+    Compartido_t *compartido;
+    size_t tamano;
+    struct timespec inicio;
+    pid_t *trabajadores;
+    int total, lanzados = 0, correctos = 0;
+    double ms;
+
+    total = leer_manifiesto(manifiesto, &trabajos);
+    if (total < 0) return 0;
+
+    if (lote_trabajadores <= 0) lote_trabajadores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (lote_trabajadores > total) lote_trabajadores = total;
+    if (lote_trabajadores < 1) lote_trabajadores = 1;
+
+    // Compartida con todos los hijos (fork no la copia)
+    tamano = sizeof(Compartido_t) + (size_t)total * sizeof(ResultadoLote_t);
+    compartido = mmap(NULL, tamano, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    trabajadores = malloc(lote_trabajadores * sizeof(pid_t));
+    if (compartido == MAP_FAILED || trabajadores == NULL) {
+        LOG_ERROR("[LOTE] No hay memoria para %d resultados\n", total);
+        if (compartido != MAP_FAILED) munmap(compartido, tamano);
+        free(trabajadores);
+        free(trabajos);
+        return 0;
+    }
+    atomic_store(&compartido->siguiente, 0);
+
+    // Lo que quede en los buffers de stdio no debe duplicarse en los hijos
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    for (int w = 0; w < lote_trabajadores; w++) {
+        trabajadores[w] = fork();
+        if (trabajadores[w] == 0) {
+            trabajador(trabajos, total, compartido);
+            _exit(0);
+        }
+        if (trabajadores[w] < 0) {
+            LOG_ERROR("[LOTE] No se pudo crear el trabajador %d\n", w);
+            break;
+        }
+        lanzados++;
+    }
+    // Sin trabajadores el lote corre en este mismo proceso
+    if (lanzados == 0) trabajador(trabajos, total, compartido);
+    for (int w = 0; w < lanzados; w++) {
+        waitpid(trabajadores[w], NULL, 0);
+    }
+    ms = ms_desde(&inicio);
+    instrucciones_totales = 0;
+    ms_ejecucion = ms;
+
+    for (int i = 0; i < total; i++) {
+        const ResultadoLote_t *r = &compartido->resultados[i];
+
+        instrucciones_totales += r->instrucciones;
+        if (r->codigo == INT_SYSCALL) correctos++;
+        printf("%s AC=%d RX=%d SP=%d PC=%d CC=%d INT=%d SALIDA=%s INSTRUCCIONES=%llu MS=%.3f\n",
+            trabajos[i].programa, r->AC, r->RX, r->SP, r->pc, r->cc,
+            r->codigo, nombre_salida(r->codigo), r->instrucciones, r->ms);
+    }
+    printf("# %d programas (%d terminados con SVC 0) en %.1f ms con %d trabajadores (%.1f programas/s)\n",
+        total, correctos, ms, lanzados ? lanzados : 1, ms > 0 ? total / (ms / 1000.0) : 0.0);
+    fflush(stdout);
+
+    munmap(compartido, tamano);
+    free(trabajadores);
+    free(trabajos);
+    return correctos == total;
+}
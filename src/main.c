@@ -1,55 +1,468 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
 #include "../include/cpu.h"
 #include "../include/loader.h"
 #include "../include/logger.h"
 #include "../include/disco.h"
+#include "../include/planificador_disco.h"
+#include "../include/cache_disco.h"
+#include "../include/procesos.h"
+#include "../include/traza.h"
+#include "../include/interrupciones.h"
+#include "../include/lote.h"
+#include "../include/checkpoint.h"
+#include "../include/estadisticas.h"
+#include "../include/perfil.h"
+#include "../include/jit.h"
+#include "../include/mmu.h"
+
+// Una línea clave=valor con las métricas de la corrida (la lee bin/bench)
+static int escribir_resumen(const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    struct rusage uso;
+    unsigned long long atendidas = 0, dma = dma_transferencias();
+    double lat_media, lat_max, reloj_media, reloj_max, io_media, io_max;
+    double segundos = ms_ejecucion / 1000.0;
+
+    if (f == NULL) {
+        perror("[ERROR] No se pudo escribir el resumen");
+        return 0;
+    }
+    for (int i = 0; i < TOTAL_INTERRUPCIONES; i++) atendidas += ic_atendidas(i);
+    ic_latencia(-1, &lat_media, &lat_max);
+    ic_latencia(INT_RELOJ, &reloj_media, &reloj_max);
+    ic_latencia(INT_IO_FIN, &io_media, &io_max);
+    getrusage(RUSAGE_SELF, &uso);
+
+    fprintf(f, "instrucciones=%llu ms=%.3f mips=%.3f interrupciones=%llu "
+               "lat_int_media_us=%.2f lat_int_max_us=%.2f lat_reloj_media_us=%.2f lat_io_fin_media_us=%.2f "
+               "dma_transferencias=%llu dma_por_s=%.1f rss_max_kb=%ld\n",
+        instrucciones_totales, ms_ejecucion, segundos > 0 ? instrucciones_totales / segundos / 1e6 : 0.0,
+        atendidas, lat_media, lat_max, reloj_media, io_media,
+        dma, segundos > 0 ? dma / segundos : 0.0, uso.ru_maxrss);
+    return fclose(f) == 0;
+}
 
 int main(int argc, char *argv[]) {
+    const char *programas[MAX_PROCESOS];
+    int total_programas = 0;
+    int reloj = -1;
+    int nivel_log = -1;
+    int tiempo_real_dma = -1;
+    const char *ruta_traza = NULL;
+    const char *ruta_disco = NULL;
+    const char *ruta_lote = NULL;
+    const char *ruta_checkpoint = NULL;
+    const char *ruta_resumen = NULL;
+    const char *ruta_estadisticas = NULL;
+    const char *ruta_perfil = NULL;
+    int modo_perfil = PERFIL_MUESTREO;
+    char ruta_restaurar[1024] = "";
+    int fotos_restaurar = 0;
+    int pistas = DISCO_PISTAS, cilindros = DISCO_CILINDROS, sectores = DISCO_SECTORES;
+
     logger_init("logs/simulador.log");
     logger_log("--- INICIO DEL SIMULADOR ---\n");
+    estadisticas_hilo(); // El núcleo 0 corre en este hilo
+
+    // 0. Opciones de línea de comandos
+    //    simulador [--motor=clasico|hilado|bloques|jit] [--modo=demo|turbo] [--quantum=N]
+    //              [--log=traza|debug|info|error] [--traza=archivo.bin]
+    //              [--dma-tiempo=real|simulado] [--disco=imagen.img] [--geometria=PxCxS]
+    //              [--planificador=fcfs|sstf|scan|cscan] [--disco-modelo=BASE,CIL,ROT]
+    //              [--cache=SECTORES] [--cache-periodo=MS]
+    //              [--reloj=CICLOS] [--quantum-rr=TICKS] [--nucleos=N] [--memoria=PALABRAS]
+    //              [--paginacion] [--paginas=N]
+    //              [--memoria-virtual] [--marcos=N] [--prefetch=N]
+    //              [--limite=INSTRUCCIONES] [--lote=manifiesto.txt] [--trabajadores=N]
+    //              [--checkpoint=archivo.snap] [--checkpoint-cada=N] [--restaurar=archivo.snap[:K]]
+    //              [--resumen=archivo.txt] [--estadisticas=archivo.txt] [--estadisticas-periodo=MS]
+    //              [--perfil=archivo.txt] [--perfil-modo=muestreo|exacto] [--perfil-periodo=US]
+    //              [programa.asm ...]   (cada programa es un proceso)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--motor=clasico") == 0) {
+            motor_cpu = MOTOR_CLASICO;
+        } else if (strcmp(argv[i], "--motor=hilado") == 0) {
+            motor_cpu = MOTOR_HILADO;
+        } else if (strcmp(argv[i], "--motor=bloques") == 0) {
+            motor_cpu = MOTOR_BLOQUES;
+        } else if (strcmp(argv[i], "--motor=jit") == 0) {
+            motor_cpu = MOTOR_JIT;
+        } else if (strcmp(argv[i], "--modo=demo") == 0) {
+            modo_ejecucion = MODO_DEMO;
+        } else if (strcmp(argv[i], "--modo=turbo") == 0) {
+            modo_ejecucion = MODO_TURBO;
+        } else if (strncmp(argv[i], "--quantum=", 10) == 0) {
+            quantum_turbo = atoi(argv[i] + 10);
+            if (quantum_turbo <= 0) {
+                LOG_ERROR("[ERROR] Quantum invalido: %s\n", argv[i] + 10);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--log=", 6) == 0) {
+            nivel_log = logger_nivel_desde_texto(argv[i] + 6);
+            if (nivel_log < 0) {
+                LOG_ERROR("[ERROR] Nivel de log invalido: %s\n", argv[i] + 6);
+                logger_close();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--dma-tiempo=real") == 0) {
+            tiempo_real_dma = 1;
+        } else if (strcmp(argv[i], "--dma-tiempo=simulado") == 0) {
+            tiempo_real_dma = 0;
+        } else if (strncmp(argv[i], "--planificador=", 15) == 0) {
+            pd_politica = pd_politica_desde_texto(argv[i] + 15);
+            if (pd_politica < 0) {
+                LOG_ERROR("[ERROR] Planificador de disco invalido: %s\n", argv[i] + 15);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--disco-modelo=", 15) == 0) {
+            if (!pd_modelo_desde_texto(argv[i] + 15)) {
+                LOG_ERROR("[ERROR] Modelo de disco invalido: %s (se espera BASE,CIL,ROT en us)\n", argv[i] + 15);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--disco=", 8) == 0) {
+            ruta_disco = argv[i] + 8;
+        } else if (strncmp(argv[i], "--geometria=", 12) == 0) {
+            if (sscanf(argv[i] + 12, "%dx%dx%d", &pistas, &cilindros, &sectores) != 3) {
+                LOG_ERROR("[ERROR] Geometria invalida: %s (se espera PxCxS)\n", argv[i] + 12);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            cache_capacidad = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--cache-periodo=", 16) == 0) {
+            cache_periodo_ms = atoi(argv[i] + 16);
+            if (cache_periodo_ms <= 0) {
+                LOG_ERROR("[ERROR] Periodo de vaciado invalido: %s\n", argv[i] + 16);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--reloj=", 8) == 0) {
+            reloj = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--quantum-rr=", 13) == 0) {
+            quantum_rr = atoi(argv[i] + 13);
+            if (quantum_rr <= 0) {
+                LOG_ERROR("[ERROR] Quantum de Round-Robin invalido: %s\n", argv[i] + 13);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--nucleos=", 10) == 0) {
+            maquina.nucleos = atoi(argv[i] + 10);
+            if (maquina.nucleos < 1 || maquina.nucleos > MAX_NUCLEOS) {
+                LOG_ERROR("[ERROR] Cantidad de nucleos invalida: %s (1-%d)\n", argv[i] + 10, MAX_NUCLEOS);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--memoria=", 10) == 0) {
+            maquina.tamano_memoria = atoi(argv[i] + 10);
+            if (maquina.tamano_memoria <= INICIO_USUARIO || maquina.tamano_memoria > MEMORIA_MAXIMA) {
+                LOG_ERROR("[ERROR] Tamano de memoria invalido: %s (%d-%d palabras)\n",
+                    argv[i] + 10, INICIO_USUARIO + 1, MEMORIA_MAXIMA);
+                logger_close();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--paginacion") == 0) {
+            paginacion = 1;
+        } else if (strncmp(argv[i], "--paginas=", 10) == 0) {
+            paginacion = 1;
+            paginas_proceso = atoi(argv[i] + 10);
+            // El máximo lo pone la creación: con memoria virtual pueden ser más que los marcos
+            if (paginas_proceso <= 0) {
+                LOG_ERROR("[ERROR] Cantidad de paginas invalida: %s\n", argv[i] + 10);
+                logger_close();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--memoria-virtual") == 0) {
+            paginacion = 1;
+            memoria_virtual = 1;
+        } else if (strncmp(argv[i], "--marcos=", 9) == 0) {
+            paginacion = 1;
+            marcos_usuario = atoi(argv[i] + 9);
+            if (marcos_usuario < 1 || marcos_usuario > MARCOS - PRIMER_MARCO) {
+                LOG_ERROR("[ERROR] Cantidad de marcos invalida: %s (1-%d)\n", argv[i] + 9, MARCOS - PRIMER_MARCO);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--prefetch=", 11) == 0) {
+            prefetch_paginas = atoi(argv[i] + 11);
+            if (prefetch_paginas < 0 || prefetch_paginas > PREFETCH_MAX) {
+                LOG_ERROR("[ERROR] Prefetch invalido: %s (0-%d)\n", argv[i] + 11, PREFETCH_MAX);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--limite=", 9) == 0) {
+            limite_instrucciones = strtoull(argv[i] + 9, NULL, 10);
+        } else if (strncmp(argv[i], "--lote=", 7) == 0) {
+            ruta_lote = argv[i] + 7;
+        } else if (strncmp(argv[i], "--trabajadores=", 15) == 0) {
+            lote_trabajadores = atoi(argv[i] + 15);
+            if (lote_trabajadores <= 0) {
+                LOG_ERROR("[ERROR] Cantidad de trabajadores invalida: %s\n", argv[i] + 15);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+            ruta_checkpoint = argv[i] + 13;
+        } else if (strncmp(argv[i], "--checkpoint-cada=", 18) == 0) {
+            checkpoint_cada = strtoull(argv[i] + 18, NULL, 10);
+            if (checkpoint_cada == 0) {
+                LOG_ERROR("[ERROR] Intervalo de checkpoint invalido: %s\n", argv[i] + 18);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--restaurar=", 12) == 0) {
+            // archivo.snap:K aplica solo las primeras K fotos
+            const char *dos_puntos = strrchr(argv[i] + 12, ':');
+            int largo = (int)strlen(argv[i] + 12);
+
+            if (dos_puntos != NULL && dos_puntos[1] != '\0' &&
+                strspn(dos_puntos + 1, "0123456789") == strlen(dos_puntos + 1)) {
+                fotos_restaurar = atoi(dos_puntos + 1);
+                largo = (int)(dos_puntos - (argv[i] + 12));
+            }
+            snprintf(ruta_restaurar, sizeof(ruta_restaurar), "%.*s", largo, argv[i] + 12);
+        } else if (strncmp(argv[i], "--resumen=", 10) == 0) {
+            ruta_resumen = argv[i] + 10;
+        } else if (strncmp(argv[i], "--estadisticas=", 15) == 0) {
+            ruta_estadisticas = argv[i] + 15;
+        } else if (strncmp(argv[i], "--estadisticas-periodo=", 23) == 0) {
+            estadisticas_periodo_ms = atoi(argv[i] + 23);
+            if (estadisticas_periodo_ms <= 0) {
+                LOG_ERROR("[ERROR] Periodo de estadisticas invalido: %s\n", argv[i] + 23);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--perfil=", 9) == 0) {
+            ruta_perfil = argv[i] + 9;
+        } else if (strcmp(argv[i], "--perfil-modo=muestreo") == 0) {
+            modo_perfil = PERFIL_MUESTREO;
+        } else if (strcmp(argv[i], "--perfil-modo=exacto") == 0) {
+            modo_perfil = PERFIL_EXACTO;
+        } else if (strncmp(argv[i], "--perfil-periodo=", 17) == 0) {
+            perfil_periodo_us = atoi(argv[i] + 17);
+            if (perfil_periodo_us <= 0) {
+                LOG_ERROR("[ERROR] Periodo de muestreo invalido: %s\n", argv[i] + 17);
+                logger_close();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--traza=", 8) == 0) {
+            ruta_traza = argv[i] + 8;
+        } else if (argv[i][0] == '-') {
+            LOG_ERROR("[ERROR] Opcion desconocida: %s\n", argv[i]);
+            logger_close();
+            return 1;
+        } else {
+            if (total_programas == MAX_PROCESOS) {
+                LOG_ERROR("[ERROR] Maximo %d programas\n", MAX_PROCESOS);
+                logger_close();
+                return 1;
+            }
+            programas[total_programas++] = argv[i];
+        }
+    }
+    // Los motores hilado, de bloques y JIT leen la RAM con la dirección
+    // lógica tal cual: con paginación solo traduce el clásico
+    if (paginacion && motor_cpu != MOTOR_CLASICO) {
+        LOG_ERROR("[ERROR] La paginacion solo funciona con el motor clasico: se usa ese.\n");
+        motor_cpu = MOTOR_CLASICO;
+    }
+    // Una entrada de la tabla de páginas tiene 8 bits de marco y los marcos
+    // salen de TAMANO_MEMORIA: la paginación solo cubre la RAM por defecto
+    if (paginacion && maquina.tamano_memoria != 0 && maquina.tamano_memoria != TAMANO_MEMORIA) {
+        LOG_ERROR("[ERROR] La paginacion solo funciona con la memoria por defecto (%d palabras).\n", TAMANO_MEMORIA);
+        logger_close();
+        return 1;
+    }
+
+    // El motor hilado publica sus etiquetas antes de decodificar la memoria
+    // (también antes del lote: las instancias heredan la tabla)
+    if (motor_cpu == MOTOR_HILADO) {
+        ejecutar_hilado(-1);
+        logger_log("[INFO] Motor de ejecucion: HILADO (goto computado).\n");
+    } else if (motor_cpu == MOTOR_BLOQUES) {
+        logger_log("[INFO] Motor de ejecucion: BLOQUES (traduccion por bloque basico).\n");
+    } else if (motor_cpu == MOTOR_JIT) {
+        if (!jit_disponible()) {
+            LOG_ERROR("[ERROR] El JIT necesita x86-64 con Linux: se usa el motor de bloques.\n");
+            motor_cpu = MOTOR_BLOQUES;
+        }
+        logger_log("[INFO] Motor de ejecucion: %s.\n",
+            motor_cpu == MOTOR_JIT ? "JIT (bloques calientes a x86-64)" : "BLOQUES (traduccion por bloque basico)");
+    } else {
+        logger_log("[INFO] Motor de ejecucion: CLASICO.\n");
+    }
+
+    // Modo lote: cada programa del manifiesto en su propia máquina
+    if (ruta_lote != NULL) {
+        int correcto;
+
+        logger_log("[LOTE] Manifiesto %s\n", ruta_lote);
+        logger_close(); // Los hijos no heredan el hilo escritor del log
+        correcto = lote_ejecutar(ruta_lote);
+        if (ruta_resumen != NULL && !escribir_resumen(ruta_resumen)) correcto = 0;
+        return correcto ? 0 : 1;
+    }
+
+    // El checkpoint guarda el estado de un solo núcleo
+    if ((ruta_checkpoint != NULL || ruta_restaurar[0] != '\0') && maquina.nucleos > 1) {
+        LOG_ERROR("[ERROR] El checkpoint solo funciona con un nucleo.\n");
+        logger_close();
+        return 1;
+    }
+
+    // El reloj de páginas invalida solo la TLB del núcleo que atiende el
+    // fallo, y los marcos tomados por el DMA no entran en el checkpoint
+    if (memoria_virtual && (maquina.nucleos > 1 || ruta_checkpoint != NULL || ruta_restaurar[0] != '\0')) {
+        LOG_ERROR("[ERROR] La memoria virtual solo funciona con un nucleo y sin checkpoint.\n");
+        logger_close();
+        return 1;
+    }
+
+    // Al restaurar, los programas, la geometría y el tamaño de la RAM salen del checkpoint
+    if (ruta_restaurar[0] != '\0') {
+        total_programas = 0;
+        if (!checkpoint_leer_geometria(ruta_restaurar, &pistas, &cilindros, &sectores, &maquina.tamano_memoria)) {
+            logger_close();
+            return 1;
+        }
+    } else if (total_programas == 0) {
+        programas[total_programas++] = "data/programa1.asm";
+    }
+
+    // En DEMO queremos ver cada instrucción; en TURBO solo los eventos
+    if (nivel_log < 0) {
+        nivel_log = (modo_ejecucion == MODO_TURBO) ? LOG_NIVEL_INFO : LOG_NIVEL_TRAZA;
+    }
+    logger_set_nivel(nivel_log);
+
+    // En TURBO el disco no duerme: sus tiempos solo se simulan
+    if (tiempo_real_dma < 0) {
+        tiempo_real_dma = (modo_ejecucion == MODO_TURBO) ? 0 : 1;
+    }
+    dma_tiempo_real = tiempo_real_dma;
 
     // 1. Inicializar Hardware
-    inicializar_cpu();
-    inicializar_disco();
+    if (!inicializar_cpu()) {
+        logger_close();
+        return 1;
+    }
+    if (!inicializar_disco(ruta_disco, pistas, cilindros, sectores)) {
+        LOG_ERROR("[FATAL] No se pudo preparar el disco.\n");
+        logger_close();
+        return 1;
+    }
     
     // Inicializamos Mutex
-    pthread_mutex_init(&cpu.mutex, NULL);
-    cpu.timer_periodo = 0; // Timer apagado por defecto
-    cpu.interrupcion_pendiente = 0;
+    pthread_mutex_init(&maquina.mutex, NULL);
+    // Timer apagado por defecto; con varios procesos lo necesita el Round-Robin
+    if (reloj < 0) {
+        reloj = (total_programas > 1) ? RELOJ_MULTIPROGRAMACION : 0;
+    }
+    atomic_store_explicit(&maquina.timer_periodo, reloj, memory_order_relaxed);
+    ic_reiniciar();
 
-    // 2. Cargar Programa
-    if (!cargar_programa("data/programa1.asm")) {
-        logger_log("[FATAL] Fallo la carga del programa.\n");
+    // 2. Cargar Programas: cada uno en su partición, como un proceso
+    procesos_reiniciar();
+    for (int i = 0; i < total_programas; i++) {
+        if (!procesos_crear(programas[i], i, total_programas)) {
+            LOG_ERROR("[FATAL] Fallo la carga del programa.\n");
+            cerrar_disco();
+            logger_close();
+            return 1;
+        }
+    }
+
+    // ... o la máquina entera (RAM, registros, procesos, timer y disco) de un checkpoint
+    if (ruta_restaurar[0] != '\0' && !checkpoint_restaurar(ruta_restaurar, fotos_restaurar)) {
+        cerrar_disco();
+        logger_close();
+        return 1;
+    }
+
+    // La primera foto (completa) se toma antes de la primera instrucción
+    if (ruta_checkpoint != NULL && !checkpoint_abrir(ruta_checkpoint)) {
+        cerrar_disco();
+        logger_close();
+        return 1;
+    }
+
+    // Traza binaria opcional (se decodifica con bin/simtrace)
+    if (ruta_traza != NULL && !traza_abrir(ruta_traza)) {
+        cerrar_disco();
+        logger_close();
         return 1;
     }
 
     // CREAR EL HILO DEL TIMER
     pthread_t thread_id;
-    if (pthread_create(&thread_id, NULL, hilo_timer, &cpu) != 0) {
-        logger_log("[ERROR] No se pudo crear el hilo del Timer.\n");
+    if (pthread_create(&thread_id, NULL, hilo_timer, &maquina) != 0) {
+        LOG_ERROR("[ERROR] No se pudo crear el hilo del Timer.\n");
+        cerrar_disco();
+        logger_close();
         return 1;
     }
     logger_log("[INFO] Hilo del Timer iniciado correctamente.\n");
 
     // CREAR EL HILO DEL DMA
     pthread_t thread_dma_id;
-    if (pthread_create(&thread_dma_id, NULL, hilo_dma, &cpu) != 0) {
-        logger_log("[ERROR] No se pudo crear el hilo del DMA.\n");
+    if (pthread_create(&thread_dma_id, NULL, hilo_dma, &maquina) != 0) {
+        LOG_ERROR("[ERROR] No se pudo crear el hilo del DMA.\n");
+        cerrar_disco();
+        logger_close();
         return 1;
     }
     logger_log("[INFO] Hilo del DMA iniciado correctamente.\n");
 
+    // CREAR EL HILO DE VACIADO DE LA CACHÉ (termina enseguida si no hay caché)
+    pthread_t thread_vaciado_id;
+    if (pthread_create(&thread_vaciado_id, NULL, hilo_vaciado, NULL) != 0) {
+        LOG_ERROR("[ERROR] No se pudo crear el hilo de vaciado de la cache.\n");
+        cerrar_disco();
+        logger_close();
+        return 1;
+    }
+
+    // CREAR EL HILO EXPORTADOR DE ESTADÍSTICAS (solo si se pidió el archivo)
+    pthread_t thread_estadisticas_id;
+    int exportando = 0;
+    if (ruta_estadisticas != NULL && estadisticas_abrir(ruta_estadisticas)) {
+        exportando = pthread_create(&thread_estadisticas_id, NULL, hilo_estadisticas, &maquina) == 0;
+        if (!exportando) LOG_ERROR("[ERROR] No se pudo crear el hilo de estadisticas.\n");
+    }
+
+    // Perfil del programa invitado (el reporte se escribe al terminar)
+    if (ruta_perfil != NULL && !perfil_abrir(ruta_perfil, modo_perfil)) {
+        LOG_ERROR("[ERROR] Se sigue sin perfil.\n");
+    }
+
     // Opcional: Mostrar estado del cpu antes de arrancar
     dump_cpu();
 
     // Arrancar el cpu
     ejecutar_cpu();
+    perfil_cerrar();
+    detener_dma();
     
     // Esperamos al hilo y limpiamos
     pthread_join(thread_id, NULL);
+    pthread_join(thread_vaciado_id, NULL);
     pthread_join(thread_dma_id, NULL); // Esperar al DMA también
-    pthread_mutex_destroy(&cpu.mutex);
+    if (exportando) pthread_join(thread_estadisticas_id, NULL);
+    estadisticas_exportar(); // Volcado final, con todos los hilos ya detenidos
+    pthread_mutex_destroy(&maquina.mutex);
+    traza_cerrar();
+    checkpoint_cerrar();
+    cerrar_disco();
+
+    if (ruta_resumen != NULL && !escribir_resumen(ruta_resumen)) {
+        logger_close();
+        return 1;
+    }
     
     // Opcional: Mostrar estado final del cpu
     dump_cpu();
@@ -57,7 +470,7 @@ int main(int argc, char *argv[]) {
     // Mostrar las primeras posiciones de memoria de usuario para ver si cargó
     // logger_log("\n--- VISTA DE MEMORIA (Primeras instrucciones) ---\n");
     // for(int i = 300; i < 305; i++) {
-    //     logger_log("Mem[%d] = %08X\n", i, cpu.memoria[i]);
+    //     logger_log("Mem[%d] = %08X\n", i, maquina.memoria[i]);
     // }
 
     logger_log("--- FIN DE LA EJECUCION ---\n");
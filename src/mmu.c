@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include "../include/mmu.h"
+#include "../include/cpu.h"
+#include "../include/disco.h"
+#include "../include/procesos.h"
+#include "../include/logger.h"
+
+int paginacion = 0;
+int memoria_virtual = 0;
+int paginas_proceso = 0;
+int marcos_usuario = MARCOS - PRIMER_MARCO;
+int prefetch_paginas = 0;
+
+__thread EntradaTLB_t tlb[TLB_ENTRADAS] = { [0 ... TLB_ENTRADAS - 1] = { -1, -1, 0, 0 } };
+
+// Dirección lógica que falló (la atiende INT_FALLO_PAGINA en este núcleo)
+static __thread int fallo_dir = -1;
+
+// Dueño de cada marco físico
+typedef struct {
+    int ptbr;       // Tabla del proceso dueño (-1 = libre)
+    int pagina;
+    int tomado;     // PID cuya cadena del DMA todavía lo usa (0 = ninguno)
+    int saliente;   // PTE de la página que esa cadena baja al swap (-1 = ninguna)
+    int espera;     // PID que espera esa bajada para volver a subirla (0 = ninguno)
+} Marco_t;
+
+static Marco_t marcos[MARCOS] = { [0 ... MARCOS - 1] = { -1, -1, 0, -1, 0 } };
+static int manecilla = PRIMER_MARCO;   // Reloj de segunda oportunidad
+
+// Descriptores de la cadena de un fallo: bajar y subir cada página y el terminador
+#define CADENA_PALABRAS ((2 * (1 + PREFETCH_MAX) + 1) * DESC_PALABRAS)
+
+// Las tablas se apilan desde el comienzo de la región del SO y nunca se
+// liberan: así su base sirve de etiqueta en la TLB. Con memoria virtual
+// cada tabla va seguida del área de descriptores de sus fallos
+static int fin_tablas = INICIO_SO;
+
+// Cada entrada de tabla tiene su página de swap, del final del disco hacia atrás
+static long swap_sector(int pte) {
+    return disco.total_sectores - (long)(pte + 1) * PAGINA;
+}
+
+static int ultimo_marco() {
+    return PRIMER_MARCO + marcos_usuario;
+}
+
+static PCB_t *pcb_de_tabla(int ptbr) {
+    for (int pid = 1; pid <= total_procesos; pid++) {
+        if (procesos_pcb(pid)->PTBR == ptbr) return procesos_pcb(pid);
+    }
+    return NULL;
+}
+
+static void llenar_tlb(EntradaTLB_t *e, unsigned int pagina, int pte) {
+    e->ptbr = cpu.PTBR;
+    e->pagina = (int)pagina;
+    e->marco = pte & PTE_MARCO;
+    e->sucia = (pte & PTE_SUCIA) != 0;
+}
+
+static void descartar_tlb(int ptbr, int pagina) {
+    EntradaTLB_t *e = &tlb[pagina & (TLB_ENTRADAS - 1)];
+
+    if (e->ptbr == ptbr && e->pagina == pagina) e->pagina = -1;
+}
+
+static void postear_fallo(int dir) {
+    fallo_dir = dir;
+    lanzar_interrupcion(INT_FALLO_PAGINA);
+}
+
+int mmu_fallo_tlb(int dir) {
+    unsigned int pagina = (unsigned int)dir >> PAGINA_BITS;
+    int pte;
+
+    ESTAD_SUMAR(&contadores->tlb_fallos, 1);
+    if (dir < 0 || pagina >= (unsigned int)cpu.PTLR) {
+        LOG_ERROR("[MMU] Direccion logica %d fuera del proceso (%d paginas)\n", dir, cpu.PTLR);
+        ESTAD_SUMAR(&contadores->fallas_proteccion, 1);
+        return -1;
+    }
+    pte = maquina.memoria[cpu.PTBR + pagina];
+    if (!(pte & PTE_PRESENTE)) {
+        if (memoria_virtual) {
+            postear_fallo(dir);
+            return MMU_FALLO;
+        }
+        LOG_ERROR("[MMU] Pagina %u sin marco (%d)\n", pagina, pte);
+        ESTAD_SUMAR(&contadores->fallas_proteccion, 1);
+        return -1;
+    }
+    if (memoria_virtual && !(pte & PTE_REFERENCIADA)) {
+        pte |= PTE_REFERENCIADA;
+        escribir_memoria(cpu.PTBR + pagina, pte);
+    }
+
+    llenar_tlb(&tlb[pagina & (TLB_ENTRADAS - 1)], pagina, pte);
+    return ((pte & PTE_MARCO) << PAGINA_BITS) | (dir & (PAGINA - 1));
+}
+
+int mmu_acceso(int dir, int escribe) {
+    unsigned int pagina = (unsigned int)dir >> PAGINA_BITS;
+    EntradaTLB_t *e = &tlb[pagina & (TLB_ENTRADAS - 1)];
+    int pte, nueva;
+
+    if (e->pagina == (int)pagina && e->ptbr == cpu.PTBR && (!escribe || e->sucia)) return 1;
+    if (dir < 0 || pagina >= (unsigned int)cpu.PTLR) return 1;
+
+    pte = maquina.memoria[cpu.PTBR + pagina];
+    if (!(pte & PTE_PRESENTE)) {
+        postear_fallo(dir);
+        return 0;
+    }
+
+    // Bits R y M: los lee el reloj al buscar víctima
+    ESTAD_SUMAR(&contadores->tlb_fallos, 1);
+    nueva = pte | PTE_REFERENCIADA | (escribe ? PTE_SUCIA : 0);
+    if (nueva != pte) escribir_memoria(cpu.PTBR + pagina, nueva);
+    llenar_tlb(e, pagina, nueva);
+    return 1;
+}
+
+// Primer marco sin página ni transferencia en curso. Retorna -1 si no hay
+static int marco_libre() {
+    for (int f = PRIMER_MARCO; f < ultimo_marco(); f++) {
+        if (marcos[f].ptbr < 0 && !marcos[f].tomado) return f;
+    }
+    return -1;
+}
+
+// Primer marco libre, o la víctima del reloj: pasa de largo los que están
+// en tránsito y a los que tienen R les baja el bit (segunda oportunidad).
+// Retorna -1 si todos están en tránsito
+static int elegir_marco() {
+    int libre = marco_libre();
+
+    if (libre >= 0) return libre;
+
+    // Dos vueltas alcanzan: la primera baja todos los R
+    for (int i = 0; i < 2 * marcos_usuario; i++) {
+        int f = manecilla;
+        int t = marcos[f].ptbr + marcos[f].pagina;
+
+        manecilla = (manecilla + 1 < ultimo_marco()) ? manecilla + 1 : PRIMER_MARCO;
+        if (marcos[f].tomado) continue;
+        if (maquina.memoria[t] & PTE_REFERENCIADA) {
+            escribir_memoria(t, maquina.memoria[t] & ~PTE_REFERENCIADA);
+            descartar_tlb(marcos[f].ptbr, marcos[f].pagina);   // El próximo acceso vuelve a marcar R
+            continue;
+        }
+        return f;
+    }
+    return -1;
+}
+
+// Escribe en Mem[dir] un descriptor que mueve una página entre el swap y
+// un marco. Retorna dónde va el siguiente
+static int poner_descriptor(int dir, long sector, int marco, int escritura) {
+    int desc[DESC_PALABRAS];
+
+    desc[DESC_PISTA] = (int)(sector / ((long)disco.cilindros * disco.sectores));
+    desc[DESC_CILINDRO] = (int)((sector / disco.sectores) % disco.cilindros);
+    desc[DESC_SECTOR] = (int)(sector % disco.sectores);
+    desc[DESC_MEMORIA] = marco << PAGINA_BITS;
+    desc[DESC_CANTIDAD] = PAGINA;
+    desc[DESC_ESCRITURA] = escritura;
+    escribir_bloque(dir, desc, DESC_PALABRAS);
+    return dir + DESC_PALABRAS;
+}
+
+// Saca de RAM la página del marco 'f'. Si está sucia agrega a la cadena
+// su bajada al swap. Retorna dónde sigue la cadena
+static int desalojar(int f, int dir) {
+    int v = marcos[f].ptbr + marcos[f].pagina;
+    PCB_t *dueno = pcb_de_tabla(marcos[f].ptbr);
+
+    descartar_tlb(marcos[f].ptbr, marcos[f].pagina);
+    if (dueno != NULL) dueno->residentes--;
+    if (maquina.memoria[v] & PTE_SUCIA) {
+        dir = poner_descriptor(dir, swap_sector(v), f, 1);
+        escribir_memoria(v, PTE_SALIENDO);
+        marcos[f].saliente = v;
+        ESTAD_SUMAR(&contadores->swap_paginas_escritas, 1);
+    } else {
+        escribir_memoria(v, 0);
+    }
+    return dir;
+}
+
+void mmu_atender_fallo() {
+    int pid = proceso_actual();
+    unsigned int pagina = (unsigned int)fallo_dir >> PAGINA_BITS;
+    int cadena = cpu.PTBR + cpu.PTLR;   // Área de descriptores del proceso
+    int dir = cadena, subidas = 0;
+    int fin[DESC_PALABRAS] = { 0 };
+    PCB_t *p = procesos_pcb(pid);
+    int t;
+
+    if (!memoria_virtual || p == NULL || pagina >= (unsigned int)cpu.PTLR) return;
+    t = cpu.PTBR + pagina;
+    if (maquina.memoria[t] & PTE_PRESENTE) return;
+
+    // Su bajada al swap todavía está en la cola: espera a esa cadena y reintenta
+    if (maquina.memoria[t] & PTE_SALIENDO) {
+        for (int f = PRIMER_MARCO; f < MARCOS; f++) {
+            if (marcos[f].saliente == t) {
+                marcos[f].espera = pid;
+                p->fallos_pagina++;
+                ESTAD_SUMAR(&contadores->fallos_pagina, 1);
+                procesos_bloquear_actual();
+                return;
+            }
+        }
+        escribir_memoria(t, 0);
+    }
+
+    // La página que falló y, con --prefetch, las siguientes que falten.
+    // Las adelantadas solo usan marcos libres: desalojar por ellas podría
+    // echar la página de código o del dato que la misma instrucción necesita
+    for (int k = 0; k <= prefetch_paginas && pagina + k < (unsigned int)cpu.PTLR; k++) {
+        int f;
+
+        t = cpu.PTBR + pagina + k;
+        if (k > 0 && (maquina.memoria[t] & (PTE_PRESENTE | PTE_SALIENDO))) break;
+        f = (k == 0) ? elegir_marco() : marco_libre();
+        if (f < 0) break;
+
+        if (marcos[f].ptbr >= 0) dir = desalojar(f, dir);
+        dir = poner_descriptor(dir, swap_sector(t), f, 0);
+        // Las adelantadas entran sin R: si nadie las toca son las primeras en irse
+        escribir_memoria(t, f | PTE_PRESENTE | (k == 0 ? PTE_REFERENCIADA : 0));
+        marcos[f].ptbr = cpu.PTBR;
+        marcos[f].pagina = pagina + k;
+        marcos[f].tomado = pid;
+        p->residentes++;
+        if (p->residentes > p->residentes_max) p->residentes_max = p->residentes;
+        ESTAD_SUMAR(&contadores->swap_paginas_leidas, 1);
+        if (k > 0) ESTAD_SUMAR(&contadores->prefetch_paginas, 1);
+        subidas++;
+    }
+
+    // Todos los marcos en tránsito: la instrucción vuelve a fallar en el próximo lote
+    if (subidas == 0) return;
+
+    escribir_bloque(dir, fin, DESC_PALABRAS);   // Terminador (cantidad 0)
+    p->fallos_pagina++;
+    ESTAD_SUMAR(&contadores->fallos_pagina, 1);
+    LOG_DEBUG("[MMU] Fallo de pagina %u del proceso %d: %d pagina(s) en camino\n", pagina, pid, subidas);
+
+    // Se bloquea antes de encolar, igual que SDMACAD
+    procesos_bloquear_actual();
+    dma_encolar_cadena(cadena, pid);
+}
+
+void mmu_fin_io(int pid) {
+    if (!memoria_virtual || pid < 1) return;
+
+    for (int f = PRIMER_MARCO; f < MARCOS; f++) {
+        if (marcos[f].tomado != pid) continue;
+        marcos[f].tomado = 0;
+        if (marcos[f].saliente >= 0) {
+            escribir_memoria(marcos[f].saliente, maquina.memoria[marcos[f].saliente] & ~PTE_SALIENDO);
+            marcos[f].saliente = -1;
+        }
+        if (marcos[f].espera > 0) {
+            int quien = marcos[f].espera;
+
+            marcos[f].espera = 0;
+            procesos_io_fin(quien);
+        }
+    }
+}
+
+int mmu_crear_tabla(int paginas) {
+    int ptbr = fin_tablas;
+    int palabras = paginas + (memoria_virtual ? CADENA_PALABRAS : 0);
+
+    if (paginas <= 0 || fin_tablas + palabras - 1 > FIN_SO) {
+        LOG_ERROR("[MMU] No entra otra tabla de %d paginas en la region del SO\n", paginas);
+        return -1;
+    }
+
+    if (memoria_virtual) {
+        // Todo el proceso arranca en el swap, en cero; el loader escribe el programa encima
+        if ((long)(fin_tablas + paginas) * PAGINA > disco.total_sectores) {
+            LOG_ERROR("[MMU] El swap de %d paginas no entra en el disco (%ld sectores)\n",
+                paginas, disco.total_sectores);
+            return -1;
+        }
+        for (int p = 0; p < paginas; p++) {
+            escribir_memoria(ptbr + p, 0);
+            disco_escribir_directo(swap_sector(ptbr + p), NULL, PAGINA);
+        }
+    } else {
+        if (paginas > mmu_marcos_libres()) {
+            LOG_ERROR("[MMU] Faltan marcos: el proceso pide %d y quedan %d\n", paginas, mmu_marcos_libres());
+            return -1;
+        }
+        for (int p = 0, f = PRIMER_MARCO; p < paginas; f++) {
+            if (marcos[f].ptbr >= 0) continue;
+            marcos[f].ptbr = ptbr;
+            marcos[f].pagina = p;
+            escribir_memoria(ptbr + p++, f | PTE_PRESENTE);
+        }
+    }
+    fin_tablas += palabras;
+    return ptbr;
+}
+
+int mmu_escribir_logica(int ptbr, int ptlr, int dir, const int *valores, int cantidad) {
+    int fisica = mmu_fisica(ptbr, ptlr, dir);
+
+    if (fisica >= 0) {
+        escribir_bloque(fisica, valores, cantidad);
+    } else if (memoria_virtual && dir >= 0 && (dir >> PAGINA_BITS) < ptlr) {
+        disco_escribir_directo(swap_sector(ptbr + (dir >> PAGINA_BITS)) + (dir & (PAGINA - 1)),
+            valores, cantidad);
+    }
+    return fisica;
+}
+
+void mmu_liberar_tabla(int ptbr, int paginas) {
+    PCB_t *p = pcb_de_tabla(ptbr);
+
+    for (int f = PRIMER_MARCO; f < MARCOS; f++) {
+        if (marcos[f].ptbr == ptbr && !marcos[f].tomado) {
+            marcos[f].ptbr = -1;
+            marcos[f].pagina = -1;
+        }
+    }
+    if (p != NULL) p->residentes = 0;
+}
+
+void mmu_reservar_tabla(int ptbr, int paginas) {
+    if (ptbr < 0) return;
+    if (ptbr + paginas > fin_tablas) fin_tablas = ptbr + paginas;
+    for (int p = 0; p < paginas; p++) {
+        int pte = maquina.memoria[ptbr + p];
+
+        if (!(pte & PTE_PRESENTE) || (pte & PTE_MARCO) >= MARCOS) continue;
+        marcos[pte & PTE_MARCO].ptbr = ptbr;
+        marcos[pte & PTE_MARCO].pagina = p;
+    }
+}
+
+int mmu_fisica(int ptbr, int ptlr, int dir) {
+    int pte;
+
+    if (dir < 0 || (dir >> PAGINA_BITS) >= ptlr) return -1;
+    pte = maquina.memoria[ptbr + (dir >> PAGINA_BITS)];
+    if (!(pte & PTE_PRESENTE) || (pte & PTE_MARCO) < PRIMER_MARCO || (pte & PTE_MARCO) >= MARCOS) return -1;
+    return ((pte & PTE_MARCO) << PAGINA_BITS) | (dir & (PAGINA - 1));
+}
+
+int mmu_marcos_libres() {
+    int libres = 0;
+
+    for (int f = PRIMER_MARCO; f < ultimo_marco(); f++) {
+        if (marcos[f].ptbr < 0) libres++;
+    }
+    return libres;
+}
+
+void mmu_vaciar_tlb() {
+    for (int i = 0; i < TLB_ENTRADAS; i++) {
+        tlb[i].ptbr = -1;
+        tlb[i].pagina = -1;
+    }
+}
+
+void mmu_reporte() {
+    unsigned long long aciertos = estadisticas_total(offsetof(Contadores_t, tlb_aciertos));
+    unsigned long long fallos = estadisticas_total(offsetof(Contadores_t, tlb_fallos));
+
+    if (!paginacion) return;
+    logger_log("[MMU] TLB: %llu aciertos, %llu fallos (%.2f%% de aciertos). %d de %d marcos asignados\n",
+        aciertos, fallos, aciertos + fallos > 0 ? 100.0 * aciertos / (aciertos + fallos) : 0.0,
+        marcos_usuario - mmu_marcos_libres(), marcos_usuario);
+    if (!memoria_virtual) return;
+
+    logger_log("[MMU] %llu fallos de pagina. Swap: %llu paginas leidas (%llu por prefetch), %llu escritas\n",
+        (unsigned long long)estadisticas_total(offsetof(Contadores_t, fallos_pagina)),
+        (unsigned long long)estadisticas_total(offsetof(Contadores_t, swap_paginas_leidas)),
+        (unsigned long long)estadisticas_total(offsetof(Contadores_t, prefetch_paginas)),
+        (unsigned long long)estadisticas_total(offsetof(Contadores_t, swap_paginas_escritas)));
+    for (int pid = 1; pid <= total_procesos; pid++) {
+        const PCB_t *p = procesos_pcb(pid);
+
+        logger_log("[MMU] Proceso %d: %llu fallos, %d paginas residentes (maximo %d) de %d\n",
+            pid, p->fallos_pagina, p->residentes, p->residentes_max, p->PTLR);
+    }
+}
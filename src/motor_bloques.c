@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/cpu.h"
+#include "../include/bloques.h"
+#include "../include/jit.h"
+#include "../include/constantes.h"
+#include "../include/logger.h"
+#include "../include/traza.h"
+#include "../include/estadisticas.h"
+#include "../include/perfil.h"
+#include "../include/arena.h"
+
+// ====================================================
+// MOTOR DE BLOQUES (caché de traducción)
+// ====================================================
+// Cada bloque básico se traduce una vez a una secuencia compacta de
+// operaciones y después se ejecuta entero: el Fetch (validar el PC, cargar
+// MAR/MDR/IR) se hace una sola vez por bloque en lugar de una por palabra.
+// Las secuencias frecuentes se fusionan en una sola operación:
+//   COMP + JMPxx           comparar y saltar
+//   LOAD + SUM/RES         cargar y operar
+//   LOAD + SUM/RES + STR   cargar, operar y guardar
+// Un bloque termina en un salto, RETRN, SVC, una instrucción del DMA o una
+// que cambia la protección o las interrupciones.
+//
+// Cada núcleo tiene su propia caché (indexada por la dirección física de
+// la primera palabra). Escribir sobre código ya traducido sube la
+// generación de su región y los bloques que la cubren se retraducen.
+
+atomic_uint *bloques_generacion = NULL;
+static atomic_uchar *con_codigo = NULL;
+static int regiones = 0;
+
+// Caché del núcleo que corre en este hilo (se reserva al primer uso, en
+// una arena: con una RAM grande solo ocupa los bloques que se traducen)
+static __thread Bloque_t *bloques = NULL;
+
+// Sube con cada vaciado del JIT: el código nativo de una época anterior
+// ya no existe (así no hay que recorrer toda la caché para olvidarlo)
+static __thread unsigned int epoca_jit = 0;
+
+static atomic_ullong traducidos = 0;   // Solo para el reporte
+
+void bloques_invalidar(int dir, int cantidad) {
+    for (int r = dir / REGION; r <= (dir + cantidad - 1) / REGION; r++) {
+        if (atomic_load(&con_codigo[r])) atomic_fetch_add(&bloques_generacion[r], 1);
+    }
+}
+
+int bloques_reservar(int palabras) {
+    arena_liberar(bloques_generacion, (size_t)regiones * sizeof(atomic_uint));
+    arena_liberar(con_codigo, (size_t)regiones);
+    regiones = (palabras + REGION - 1) / REGION;
+    bloques_generacion = arena_reservar((size_t)regiones * sizeof(atomic_uint));
+    con_codigo = arena_reservar((size_t)regiones);
+    return bloques_generacion != NULL && con_codigo != NULL;
+}
+
+void bloques_liberar() {
+    arena_liberar(bloques, (size_t)maquina.tamano_memoria * sizeof(Bloque_t));
+    bloques = NULL;
+    jit_liberar();
+}
+
+// --- TRADUCCIÓN ---
+
+static int es_salto(int indice) {
+    return indice == H_JMPE || indice == H_JMPNE || indice == H_JMPLT ||
+           indice == H_JMPLGT || indice == H_J;
+}
+
+// 1 si después de esta instrucción el bloque no puede seguir
+static int cierra_bloque(const Decodificada_t *d) {
+    if (es_salto(d->indice)) return 1;
+    switch (d->opcode) {
+        case OP_SVC:   case OP_RETRN: case OP_HAB:    case OP_DHAB:
+        case OP_TTI:   case OP_CHMOD: case OP_STRRB:  case OP_STRRL:
+        case OP_SDMAP: case OP_SDMAC: case OP_SDMAS:  case OP_SDMAIO:
+        case OP_SDMAM: case OP_SDMAON: case OP_SDMACNT: case OP_SDMACAD:
+        case OP_J:     case OP_JMPE:  case OP_JMPNE:  case OP_JMPLT: case OP_JMPLGT:
+            return 1;   // (los saltos llegan aquí si son anchos: H_GENERICO)
+        default:
+            // Opcode inválido: su manejador dispara la interrupción
+            return d->opcode < 0 || d->opcode > OP_MAXIMO;
+    }
+}
+
+static int es_carga(int indice) {
+    return indice == H_LOAD_DIRECTO || indice == H_LOAD_INMEDIATO || indice == H_LOAD_INDEXADO;
+}
+
+static int es_suma_resta(int indice) {
+    return indice >= H_SUM_DIRECTO && indice <= H_RES_INDEXADO;
+}
+
+static int es_comparacion(int indice) {
+    return indice == H_COMP_DIRECTO || indice == H_COMP_INMEDIATO || indice == H_COMP_INDEXADO;
+}
+
+static void traducir(Bloque_t *b, int inicio) {
+    int dir = inicio;
+
+    // Las regiones se registran antes de leer sus palabras: una escritura
+    // que llegue en medio de la traducción ya cambia la generación
+    b->ops = 0;
+    b->ejecuciones = 0;
+    b->sin_nativo = 0;
+    b->nativo = NULL;
+    b->region[0] = inicio / REGION;
+    b->region[1] = (inicio + BLOQUE_MAX - 1 < maquina.tamano_memoria ? inicio + BLOQUE_MAX - 1
+                                                                     : maquina.tamano_memoria - 1) / REGION;
+    for (int i = 0; i < 2; i++) {
+        atomic_store(&con_codigo[b->region[i]], 1);
+        b->generacion[i] = atomic_load(&bloques_generacion[b->region[i]]);
+    }
+
+    while (dir < maquina.tamano_memoria && dir - inicio < BLOQUE_MAX) {
+        OpBloque_t *op = &b->op[b->ops++];
+        const Decodificada_t *d = decodificada(dir);
+        int cabe = BLOQUE_MAX - (dir - inicio);
+
+        op->dir = dir;
+        op->d[0] = d;
+        op->largo = 1;
+        op->tipo = (d->indice == H_GENERICO) ? B_GENERICO : B_SIMPLE;
+
+        // Fusiones
+        if (cabe >= 2 && dir + 1 < maquina.tamano_memoria) {
+            const Decodificada_t *d1 = decodificada(dir + 1);
+
+            if (es_comparacion(d->indice) && es_salto(d1->indice) && d1->indice != H_J) {
+                op->tipo = B_COMP_SALTO;
+                op->largo = 2;
+                op->d[1] = d1;
+            } else if (es_carga(d->indice) && es_suma_resta(d1->indice)) {
+                op->tipo = B_CARGAR_OPERAR;
+                op->largo = 2;
+                op->d[1] = d1;
+                if (cabe >= 3 && dir + 2 < maquina.tamano_memoria &&
+                    (decodificada(dir + 2)->indice == H_STR_DIRECTO ||
+                     decodificada(dir + 2)->indice == H_STR_INDEXADO)) {
+                    op->tipo = B_CARGAR_OPERAR_GUARDAR;
+                    op->largo = 3;
+                    op->d[2] = decodificada(dir + 2);
+                }
+            }
+        }
+        op->escribe = (op->tipo == B_GENERICO || op->d[op->largo - 1]->indice == H_STR_DIRECTO ||
+                       op->d[op->largo - 1]->indice == H_STR_INDEXADO ||
+                       op->d[op->largo - 1]->indice == H_STRRX_DIRECTO ||
+                       op->d[op->largo - 1]->indice == H_STRRX_INDEXADO);
+        dir += op->largo;
+
+        if (op->tipo == B_COMP_SALTO || cierra_bloque(op->d[op->largo - 1])) break;
+    }
+
+    b->palabras = dir - inicio;
+    atomic_fetch_add_explicit(&traducidos, 1, memory_order_relaxed);
+}
+
+// --- EJECUCIÓN ---
+// El camino de un bloque está escrito con macros y no con funciones: el
+// simulador se compila sin optimizar y cada llamada por palabra se nota.
+
+// Valor del operando de una palabra decodificada
+#define OPERANDO(d)                                                        \
+    ((d)->modo == DIR_INMEDIATO ? (d)->operando :                          \
+     (d)->modo == DIR_DIRECTO   ? LEER((d)->operando + cpu.RB) :           \
+                                  LEER((d)->operando + cpu.RX + cpu.RB))
+
+// Lectura en la partición sin llamar a nada (fuera de ella, leer_dato
+// deja el log y devuelve 0)
+#define LEER(dir)                                                          \
+    ((dir) >= cpu.RB && (dir) <= cpu.RL && (dir) >= 0 && (dir) < maquina.tamano_memoria ? \
+     maquina.memoria[(dir)] : leer_dato(dir))
+
+// AC = resultado con su código de condición. Fuera de rango lo resuelve
+// guardar_resultado (interrupción de Overflow/Underflow)
+#define OPERAR(resultado)                                                  \
+    do {                                                                   \
+        long long r_ = (resultado);                                        \
+        if (r_ >= MIN_VALOR && r_ <= MAX_VALOR) {                          \
+            cpu.AC = (int)r_;                                              \
+            cpu.psw.codigo_condicion = r_ == 0 ? 0 : (r_ < 0 ? 1 : 2);     \
+        } else {                                                           \
+            guardar_resultado(r_);                                         \
+        }                                                                  \
+    } while (0)
+
+#define SALTO_TOMADO(indice)                                               \
+    ((indice) == H_JMPE   ? cpu.psw.codigo_condicion == 0 :                \
+     (indice) == H_JMPNE  ? cpu.psw.codigo_condicion != 0 :                \
+     (indice) == H_JMPLT  ? cpu.psw.codigo_condicion == 1 :                \
+     (indice) == H_JMPLGT ? cpu.psw.codigo_condicion == 2 : 1)
+
+// Cuenta una palabra retirada (lo mismo que hace el Fetch de los otros motores)
+#define RETIRAR(d, direccion)                                              \
+    do {                                                                   \
+        cpu.MAR = (direccion);                                             \
+        cpu.instrucciones++;                                               \
+        ESTAD_SUMAR(&contadores->instrucciones[(d)->contador], 1);         \
+        hechas++;                                                          \
+    } while (0)
+
+static void guardar(int dir, int valor) {
+    if (validar_direccion(dir)) {
+        escribir_memoria(dir, valor);
+        LOG_TRAZA("      -> Guardado %d en Mem[%d]\n", valor, dir);
+    } else {
+        lanzar_interrupcion(INT_DIR_INVALIDA);
+    }
+}
+
+// Una instrucción ya decodificada. Retorna la dirección de la siguiente
+static int ejecutar_simple(const Decodificada_t *d, int dir) {
+    switch (d->indice) {
+        case H_SUM_DIRECTO: case H_SUM_INMEDIATO: case H_SUM_INDEXADO:
+            OPERAR((long long)cpu.AC + OPERANDO(d)); break;
+        case H_RES_DIRECTO: case H_RES_INMEDIATO: case H_RES_INDEXADO:
+            OPERAR((long long)cpu.AC - OPERANDO(d)); break;
+        case H_MULT_DIRECTO: case H_MULT_INMEDIATO: case H_MULT_INDEXADO:
+            OPERAR((long long)cpu.AC * OPERANDO(d)); break;
+        case H_DIVI_DIRECTO: case H_DIVI_INMEDIATO: case H_DIVI_INDEXADO:
+            dividir(OPERANDO(d)); break;
+        case H_LOAD_DIRECTO: case H_LOAD_INMEDIATO: case H_LOAD_INDEXADO:
+            cpu.AC = OPERANDO(d); break;
+        case H_LOADRX_DIRECTO: case H_LOADRX_INMEDIATO: case H_LOADRX_INDEXADO:
+            cpu.RX = OPERANDO(d); break;
+        case H_COMP_DIRECTO: case H_COMP_INMEDIATO: case H_COMP_INDEXADO:
+            comparar(OPERANDO(d)); break;
+        case H_STR_DIRECTO:    guardar(d->operando + cpu.RB, cpu.AC); break;
+        case H_STR_INDEXADO:   guardar(d->operando + cpu.RB + cpu.RX, cpu.AC); break;
+        case H_STRRX_DIRECTO:  guardar(d->operando + cpu.RB, cpu.RX); break;
+        case H_STRRX_INDEXADO: guardar(d->operando + cpu.RB + cpu.RX, cpu.RX); break;
+        case H_JMPE: case H_JMPNE: case H_JMPLT: case H_JMPLGT: case H_J:
+            if (SALTO_TOMADO(d->indice)) return cpu.RB + d->operando;
+            break;
+    }
+    return dir + 1;
+}
+
+// Ejecuta hasta 'cantidad' instrucciones por bloques. Un bloque que no
+// entra en lo que queda del lote, que se sale de la partición o que no se
+// pudo traducir avanza de a una instrucción con paso_cpu. La traza, el
+// perfil exacto y el modo DEMO necesitan ver cada Fetch: también van por paso_cpu.
+// Retorna 1 si salió bien y 0 si hubo error de Fetch (igual que paso_cpu)
+int ejecutar_bloques(int cantidad) {
+    int restantes = cantidad;
+    int por_bloques = !traza_activa && !perfil_exacto && modo_ejecucion == MODO_TURBO;
+
+    if (por_bloques && bloques == NULL) {
+        bloques = arena_reservar((size_t)maquina.tamano_memoria * sizeof(Bloque_t));
+    }
+
+    while (restantes > 0 && !cpu.corte_quantum) {
+        const Bloque_t *b = NULL;
+        const OpBloque_t *op, *fin;
+        int pc = cpu.psw.pc, hechas = 0, siguiente = pc;
+
+        if (por_bloques && bloques != NULL && pc >= 0 && pc < maquina.tamano_memoria) {
+            Bloque_t *lugar = &bloques[pc];
+            if (!VIGENTE(lugar)) traducir(lugar, pc);
+            b = lugar;
+        }
+        if (b == NULL || b->palabras > restantes ||
+            (cpu.psw.modo_operacion == 0 && (pc < cpu.RB || pc + b->palabras - 1 > cpu.RL))) {
+            if (!paso_cpu()) return 0;
+            restantes--;
+            continue;
+        }
+
+        // Segundo nivel: el bloque caliente corre como código nativo (no
+        // con el muestreo, que necesita cpu.MAR de cada instrucción)
+        if (motor_cpu == MOTOR_JIT && !perfil_muestreo && !b->sin_nativo) {
+            Bloque_t *lugar = &bloques[pc];
+
+            // Compilado para el otro modo de operación, o antes del último
+            // vaciado de la arena: se recompila
+            if (lugar->nativo != NULL &&
+                (lugar->modo_nativo != cpu.psw.modo_operacion || lugar->epoca_nativo != epoca_jit)) {
+                lugar->nativo = NULL;
+            }
+
+            if (lugar->nativo == NULL && ++lugar->ejecuciones >= JIT_UMBRAL) {
+                if (!jit_hay_lugar()) {
+                    // Arena llena: se empieza de nuevo con lo que siga caliente
+                    jit_vaciar();
+                    epoca_jit++;
+                }
+                if (!jit_compilar(lugar)) lugar->sin_nativo = 1;
+                else lugar->epoca_nativo = epoca_jit;
+            }
+            if (lugar->nativo != NULL) {
+                uint64_t r = lugar->nativo(restantes);
+
+                hechas = (int)(uint32_t)r;
+                cpu.instrucciones += hechas;
+                cpu.IR = cpu.MDR = maquina.memoria[cpu.MAR];
+                restantes -= hechas;
+                // Un chequeo en línea falló: esa instrucción la hace el intérprete
+                if (r >> 32) {
+                    if (!paso_cpu()) return 0;
+                    restantes--;
+                }
+                continue;
+            }
+        }
+
+        // Ejecuta el bloque entero o hasta que una instrucción interrumpa
+        // o sobrescriba código
+        for (op = b->op, fin = b->op + b->ops; op < fin; op++) {
+            const Decodificada_t *d = op->d[0];
+
+            switch (op->tipo) {
+                case B_SIMPLE:
+                    RETIRAR(d, op->dir);
+                    siguiente = ejecutar_simple(d, op->dir);
+                    break;
+
+                case B_GENERICO:
+                    // El manejador clásico ve los registros como tras su Fetch
+                    RETIRAR(d, op->dir);
+                    cpu.psw.pc = op->dir + 1;
+                    cpu.IR = cpu.MDR = maquina.memoria[op->dir];
+                    d->manejador(d->modo, d->operando);
+                    siguiente = cpu.psw.pc;
+                    break;
+
+                case B_COMP_SALTO: {
+                    int val;
+
+                    RETIRAR(d, op->dir);
+                    val = OPERANDO(d);
+                    cpu.psw.codigo_condicion = cpu.AC == val ? 0 : (cpu.AC < val ? 1 : 2);
+                    RETIRAR(op->d[1], op->dir + 1);
+                    siguiente = SALTO_TOMADO(op->d[1]->indice) ? cpu.RB + op->d[1]->operando : op->dir + 2;
+                    break;
+                }
+
+                case B_CARGAR_OPERAR:
+                case B_CARGAR_OPERAR_GUARDAR: {
+                    const Decodificada_t *d1 = op->d[1];
+
+                    RETIRAR(d, op->dir);
+                    cpu.AC = OPERANDO(d);
+                    RETIRAR(d1, op->dir + 1);
+                    if (d1->indice <= H_SUM_INDEXADO) OPERAR((long long)cpu.AC + OPERANDO(d1));
+                    else OPERAR((long long)cpu.AC - OPERANDO(d1));
+                    siguiente = op->dir + 2;
+                    if (op->tipo == B_CARGAR_OPERAR || cpu.corte_quantum) break;
+                    RETIRAR(op->d[2], op->dir + 2);
+                    siguiente = ejecutar_simple(op->d[2], op->dir + 2);
+                    break;
+                }
+            }
+
+            if (cpu.corte_quantum || (op->escribe && !VIGENTE(b))) break;
+        }
+
+        cpu.psw.pc = siguiente;
+        cpu.IR = cpu.MDR = maquina.memoria[cpu.MAR];
+        restantes -= hechas;
+    }
+    return 1;
+}
+
+void bloques_reporte() {
+    if (atomic_load(&traducidos) > 0) {
+        logger_log("[BLOQUES] %llu bloques traducidos\n", (unsigned long long)atomic_load(&traducidos));
+    }
+    jit_reporte();
+}
@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include "../include/cpu.h"
+#include "../include/constantes.h"
+#include "../include/logger.h"
+#include "../include/traza.h"
+#include "../include/estadisticas.h"
+#include "../include/perfil.h"
+
+// ====================================================
+// MOTOR DE EJECUCIÓN "HILADO" (Direct-Threaded)
+// ====================================================
+// En vez de volver a un switch central después de cada instrucción,
+// cada rutina salta directamente a la siguiente (goto computado de GCC).
+// Además hay una rutina especializada por cada par (opcode, modo), así
+// el "¿es Directo, Inmediato o Indexado?" ya no se pregunta en ejecución.
+// Los opcodes poco frecuentes (SVC, DMA, CHMOD...) reutilizan el
+// manejador del motor clásico, para no duplicar su lógica.
+
+#if defined(__GNUC__) && !defined(MOTOR_SIN_GOTO_COMPUTADO)
+#define HILADO_GOTO_COMPUTADO 1
+#endif
+
+// Tabla de etiquetas exportada por ejecutar_hilado (NULL sin goto computado)
+void **etiquetas_hilado = NULL;
+
+// Índice de la rutina especializada para un par (opcode, modo)
+int indice_hilado(int opcode, int modo) {
+    int base;
+
+    switch (opcode) {
+        case OP_SUM:    base = H_SUM_DIRECTO;    break;
+        case OP_RES:    base = H_RES_DIRECTO;    break;
+        case OP_MULT:   base = H_MULT_DIRECTO;   break;
+        case OP_DIVI:   base = H_DIVI_DIRECTO;   break;
+        case OP_LOAD:   base = H_LOAD_DIRECTO;   break;
+        case OP_LOADRX: base = H_LOADRX_DIRECTO; break;
+        case OP_COMP:   base = H_COMP_DIRECTO;   break;
+        case OP_STR:
+            if (modo == DIR_DIRECTO)   return H_STR_DIRECTO;
+            if (modo == DIR_INDEXADO)  return H_STR_INDEXADO;
+            return H_GENERICO;
+        case OP_STRRX:
+            if (modo == DIR_DIRECTO)   return H_STRRX_DIRECTO;
+            if (modo == DIR_INDEXADO)  return H_STRRX_INDEXADO;
+            return H_GENERICO;
+        case OP_JMPE:
+        case OP_JMPNE:
+        case OP_JMPLT:
+        case OP_JMPLGT:
+        case OP_J:
+            // El salto ancho (indexado, suma RX) lo hace el manejador clásico
+            if (modo == DIR_INDEXADO) return H_GENERICO;
+            if (opcode == OP_JMPE)  return H_JMPE;
+            if (opcode == OP_JMPNE) return H_JMPNE;
+            if (opcode == OP_JMPLT) return H_JMPLT;
+            if (opcode == OP_JMPLGT) return H_JMPLGT;
+            return H_J;
+        default:        return H_GENERICO;
+    }
+
+    // Las familias con operando siguen el orden Directo, Inmediato, Indexado
+    if (modo == DIR_DIRECTO || modo == DIR_INMEDIATO || modo == DIR_INDEXADO) {
+        return base + modo;
+    }
+    return H_GENERICO; // Modo inválido: el manejador clásico decide
+}
+
+// Store especializado (STR/STRRX): misma semántica que el motor clásico
+static inline void guardar_dato(int dir, int valor, const char *formato_log) {
+    if (validar_direccion(dir)) {
+        escribir_memoria(dir, valor);
+        LOG_TRAZA(formato_log, valor, dir);
+    } else {
+        lanzar_interrupcion(INT_DIR_INVALIDA);
+    }
+}
+
+#define LOG_STR   "      -> Guardado %d en Mem[%d]\n"
+#define LOG_STRRX "      -> Guardado RX (%d) en Mem[%d]\n"
+
+// --- Macros de despacho (goto computado o switch portable) ---
+#ifdef HILADO_GOTO_COMPUTADO
+#define RUTINA(nombre)  L_##nombre
+#define SALTAR()        goto *inst->etiqueta
+#else
+#define RUTINA(nombre)  case nombre
+#define SALTAR()        goto despachar
+#endif
+
+// Fetch común a todas las rutinas: igual que las etapas a-e de paso_cpu.
+// Antes de buscar la siguiente se graba en la traza la que acaba de retirarse.
+#define SIGUIENTE()                                                         \
+    do {                                                                    \
+        if (traza_activa && inst != NULL) {                                 \
+            traza_retirar(cpu.MAR, cpu.IR, cpu.AC, cpu.psw.codigo_condicion, \
+                inst->opcode, inst->modo);                                  \
+        }                                                                   \
+        if (restantes-- <= 0 || cpu.corte_quantum)                          \
+            return 1;                                                       \
+        cpu.MAR = cpu.psw.pc;                                               \
+        if (!validar_direccion(cpu.MAR)) return 0;                          \
+        if (cpu.MAR < 0 || cpu.MAR >= maquina.tamano_memoria) {             \
+            LOG_ERROR("[CPU] PC fuera de la memoria fisica (%d)\n", cpu.MAR); \
+            return 0;                                                       \
+        }                                                                   \
+        cpu.MDR = maquina.memoria[cpu.MAR];                                     \
+        cpu.IR = cpu.MDR;                                                   \
+        cpu.psw.pc++;                                                       \
+        cpu.instrucciones++;                                                \
+        inst = decodificada(cpu.MAR);                                       \
+        ESTAD_SUMAR(&contadores->instrucciones[inst->contador], 1);        \
+        if (perfil_exacto) perfil_retirar(cpu.MAR);                         \
+        LOG_TRAZA("[CPU] PC:%04d | IR:%08d -> OP:%02d M:%d VAL:%05d\n",   \
+            cpu.MAR, cpu.IR, inst->opcode, inst->modo, inst->operando);     \
+        SALTAR();                                                           \
+    } while (0)
+
+// Ejecuta hasta 'cantidad' instrucciones con despacho hilado.
+// Se detiene antes si una instrucción dispara una interrupción (corte_quantum).
+// Retorna 1 si salió bien y 0 si hubo error de Fetch (igual que paso_cpu).
+// Con cantidad < 0 solo publica la tabla de etiquetas y retorna.
+int ejecutar_hilado(int cantidad) {
+    Decodificada_t *inst = NULL;
+    int restantes = cantidad;
+
+#ifdef HILADO_GOTO_COMPUTADO
+    static void *tabla[H_TOTAL] = {
+        [H_SUM_DIRECTO]    = &&L_H_SUM_DIRECTO,    [H_SUM_INMEDIATO]    = &&L_H_SUM_INMEDIATO,
+        [H_SUM_INDEXADO]   = &&L_H_SUM_INDEXADO,
+        [H_RES_DIRECTO]    = &&L_H_RES_DIRECTO,    [H_RES_INMEDIATO]    = &&L_H_RES_INMEDIATO,
+        [H_RES_INDEXADO]   = &&L_H_RES_INDEXADO,
+        [H_MULT_DIRECTO]   = &&L_H_MULT_DIRECTO,   [H_MULT_INMEDIATO]   = &&L_H_MULT_INMEDIATO,
+        [H_MULT_INDEXADO]  = &&L_H_MULT_INDEXADO,
+        [H_DIVI_DIRECTO]   = &&L_H_DIVI_DIRECTO,   [H_DIVI_INMEDIATO]   = &&L_H_DIVI_INMEDIATO,
+        [H_DIVI_INDEXADO]  = &&L_H_DIVI_INDEXADO,
+        [H_LOAD_DIRECTO]   = &&L_H_LOAD_DIRECTO,   [H_LOAD_INMEDIATO]   = &&L_H_LOAD_INMEDIATO,
+        [H_LOAD_INDEXADO]  = &&L_H_LOAD_INDEXADO,
+        [H_LOADRX_DIRECTO] = &&L_H_LOADRX_DIRECTO, [H_LOADRX_INMEDIATO] = &&L_H_LOADRX_INMEDIATO,
+        [H_LOADRX_INDEXADO]= &&L_H_LOADRX_INDEXADO,
+        [H_COMP_DIRECTO]   = &&L_H_COMP_DIRECTO,   [H_COMP_INMEDIATO]   = &&L_H_COMP_INMEDIATO,
+        [H_COMP_INDEXADO]  = &&L_H_COMP_INDEXADO,
+        [H_STR_DIRECTO]    = &&L_H_STR_DIRECTO,    [H_STR_INDEXADO]     = &&L_H_STR_INDEXADO,
+        [H_STRRX_DIRECTO]  = &&L_H_STRRX_DIRECTO,  [H_STRRX_INDEXADO]   = &&L_H_STRRX_INDEXADO,
+        [H_JMPE]  = &&L_H_JMPE,  [H_JMPNE]  = &&L_H_JMPNE,
+        [H_JMPLT] = &&L_H_JMPLT, [H_JMPLGT] = &&L_H_JMPLGT,
+        [H_J]     = &&L_H_J,     [H_GENERICO] = &&L_H_GENERICO,
+    };
+
+    if (cantidad < 0) {
+        etiquetas_hilado = tabla;
+        return 1;
+    }
+#else
+    if (cantidad < 0) return 1;
+#endif
+
+    SIGUIENTE();
+
+#ifndef HILADO_GOTO_COMPUTADO
+despachar:
+    switch (inst->indice) {
+#endif
+
+    // --- ARITMÉTICA ---
+    RUTINA(H_SUM_DIRECTO):    guardar_resultado((long long)cpu.AC + leer_dato(inst->operando + cpu.RB)); SIGUIENTE();
+    RUTINA(H_SUM_INMEDIATO):  guardar_resultado((long long)cpu.AC + inst->operando); SIGUIENTE();
+    RUTINA(H_SUM_INDEXADO):   guardar_resultado((long long)cpu.AC + leer_dato(inst->operando + cpu.RX + cpu.RB)); SIGUIENTE();
+
+    RUTINA(H_RES_DIRECTO):    guardar_resultado((long long)cpu.AC - leer_dato(inst->operando + cpu.RB)); SIGUIENTE();
+    RUTINA(H_RES_INMEDIATO):  guardar_resultado((long long)cpu.AC - inst->operando); SIGUIENTE();
+    RUTINA(H_RES_INDEXADO):   guardar_resultado((long long)cpu.AC - leer_dato(inst->operando + cpu.RX + cpu.RB)); SIGUIENTE();
+
+    RUTINA(H_MULT_DIRECTO):   guardar_resultado((long long)cpu.AC * leer_dato(inst->operando + cpu.RB)); SIGUIENTE();
+    RUTINA(H_MULT_INMEDIATO): guardar_resultado((long long)cpu.AC * inst->operando); SIGUIENTE();
+    RUTINA(H_MULT_INDEXADO):  guardar_resultado((long long)cpu.AC * leer_dato(inst->operando + cpu.RX + cpu.RB)); SIGUIENTE();
+
+    RUTINA(H_DIVI_DIRECTO):   dividir(leer_dato(inst->operando + cpu.RB)); SIGUIENTE();
+    RUTINA(H_DIVI_INMEDIATO): dividir(inst->operando); SIGUIENTE();
+    RUTINA(H_DIVI_INDEXADO):  dividir(leer_dato(inst->operando + cpu.RX + cpu.RB)); SIGUIENTE();
+
+    // --- TRANSFERENCIA DE DATOS ---
+    RUTINA(H_LOAD_DIRECTO):     cpu.AC = leer_dato(inst->operando + cpu.RB); SIGUIENTE();
+    RUTINA(H_LOAD_INMEDIATO):   cpu.AC = inst->operando; SIGUIENTE();
+    RUTINA(H_LOAD_INDEXADO):    cpu.AC = leer_dato(inst->operando + cpu.RX + cpu.RB); SIGUIENTE();
+
+    RUTINA(H_LOADRX_DIRECTO):   cpu.RX = leer_dato(inst->operando + cpu.RB); SIGUIENTE();
+    RUTINA(H_LOADRX_INMEDIATO): cpu.RX = inst->operando; SIGUIENTE();
+    RUTINA(H_LOADRX_INDEXADO):  cpu.RX = leer_dato(inst->operando + cpu.RX + cpu.RB); SIGUIENTE();
+
+    RUTINA(H_STR_DIRECTO):      guardar_dato(inst->operando + cpu.RB, cpu.AC, LOG_STR); SIGUIENTE();
+    RUTINA(H_STR_INDEXADO):     guardar_dato(inst->operando + cpu.RB + cpu.RX, cpu.AC, LOG_STR); SIGUIENTE();
+    RUTINA(H_STRRX_DIRECTO):    guardar_dato(inst->operando + cpu.RB, cpu.RX, LOG_STRRX); SIGUIENTE();
+    RUTINA(H_STRRX_INDEXADO):   guardar_dato(inst->operando + cpu.RB + cpu.RX, cpu.RX, LOG_STRRX); SIGUIENTE();
+
+    // --- COMPARACIÓN Y SALTOS ---
+    RUTINA(H_COMP_DIRECTO):   comparar(leer_dato(inst->operando + cpu.RB)); SIGUIENTE();
+    RUTINA(H_COMP_INMEDIATO): comparar(inst->operando); SIGUIENTE();
+    RUTINA(H_COMP_INDEXADO):  comparar(leer_dato(inst->operando + cpu.RX + cpu.RB)); SIGUIENTE();
+
+    RUTINA(H_JMPE):   if (cpu.psw.codigo_condicion == 0) cpu.psw.pc = cpu.RB + inst->operando; SIGUIENTE();
+    RUTINA(H_JMPNE):  if (cpu.psw.codigo_condicion != 0) cpu.psw.pc = cpu.RB + inst->operando; SIGUIENTE();
+    RUTINA(H_JMPLT):  if (cpu.psw.codigo_condicion == 1) cpu.psw.pc = cpu.RB + inst->operando; SIGUIENTE();
+    RUTINA(H_JMPLGT): if (cpu.psw.codigo_condicion == 2) cpu.psw.pc = cpu.RB + inst->operando; SIGUIENTE();
+    RUTINA(H_J):      cpu.psw.pc = cpu.RB + inst->operando; SIGUIENTE();
+
+    // --- RESTO: rutina del motor clásico ---
+    RUTINA(H_GENERICO): inst->manejador(inst->modo, inst->operando); SIGUIENTE();
+
+#ifndef HILADO_GOTO_COMPUTADO
+    }
+    return 1;
+#endif
+}
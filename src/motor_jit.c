@@ -0,0 +1,574 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "../include/jit.h"
+#include "../include/cpu.h"
+#include "../include/constantes.h"
+#include "../include/logger.h"
+#include "../include/estadisticas.h"
+
+// ====================================================
+// JIT x86-64
+// ====================================================
+// Cada palabra del bloque se traduce a unas pocas instrucciones del host
+// escritas a mano (no hay ensamblador). Lo que el JIT no maneja (SVC,
+// CHMOD, el DMA, HAB/DHAB, RETRN...) termina el código nativo y la
+// instrucción la ejecuta el intérprete.
+//
+// Registros del host durante el bloque:
+//   ebx = AC   r12d = RX   ebp = SP   r13d = RB   r14d = RL   r15d = CC
+//   [rsp]   instrucciones retiradas en las vueltas anteriores del lazo
+//   [rsp+4] instrucciones del lote todavía no cobradas
+// Todas las salidas pasan por una rutina común con eax = retiradas en la
+// vuelta actual, ecx = MAR, edx = PC siguiente y esi = 1 si la instrucción
+// en PC la tiene que ejecutar el intérprete.
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+
+#define JIT_MAX_BLOQUE 8192   // Cota del código de un bloque (bytes)
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+#define G_AC RBX
+#define G_RX R12
+#define G_SP RBP
+#define G_RB R13
+#define G_RL R14
+#define G_CC R15
+
+// Condiciones (segundo byte de 0F 8x). SIEMPRE = jmp
+#define CC_AE 0x3
+#define CC_E  0x4
+#define CC_NE 0x5
+#define CC_L  0xC
+#define CC_GE 0xD
+#define CC_G  0xF
+#define SIEMPRE -1
+
+#define COMUN -1   // Destino de un salto: la rutina común de salida
+
+typedef struct {
+    int retiradas, mar, pc, lateral;   // eax, ecx, edx y esi al salir
+} Salida_t;
+
+typedef struct {
+    unsigned char *p;                            // Próximo byte
+    Salida_t salidas[2 * BLOQUE_MAX + 2];
+    int total_salidas;
+    int lateral[BLOQUE_MAX];                     // Salida al intérprete de cada palabra
+    unsigned char *huecos[8 * BLOQUE_MAX + 8];   // rel32 sin resolver
+    int destino[8 * BLOQUE_MAX + 8];             // Salida a la que van (o COMUN)
+    int total_huecos;
+} Emisor_t;
+
+// Arena de código del núcleo de este hilo
+static __thread unsigned char *arena = NULL;
+static __thread size_t usado = 0;
+
+static atomic_ullong compilados = 0, bytes_nativos = 0;   // Solo para el reporte
+
+int jit_disponible() {
+    return 1;
+}
+
+// --- CODIFICACIÓN ---
+
+static void byte(Emisor_t *e, int b) {
+    *e->p++ = (unsigned char)b;
+}
+
+static void imm32(Emisor_t *e, int v) {
+    memcpy(e->p, &v, 4);
+    e->p += 4;
+}
+
+static void rex(Emisor_t *e, int w, int reg, int indice, int base) {
+    int r = 0x40 | (w << 3) | ((reg >> 3) << 2) | ((indice >> 3) << 1) | (base >> 3);
+    if (r != 0x40) byte(e, r);
+}
+
+// op reg, rm entre registros (w = 1: 64 bits)
+static void rr(Emisor_t *e, int w, int op, int reg, int rm) {
+    rex(e, w, reg, 0, rm);
+    byte(e, op);
+    byte(e, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// op reg, [base + desp]
+static void rm_mem(Emisor_t *e, int op, int reg, int base, int desp) {
+    rex(e, 0, reg, 0, base);
+    byte(e, op);
+    byte(e, 0x80 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP) byte(e, 0x24);
+    imm32(e, desp);
+}
+
+// op reg, [base + indice*4]
+static void rm_indice(Emisor_t *e, int op, int reg, int base, int indice) {
+    rex(e, 0, reg, indice, base);
+    byte(e, op);
+    byte(e, 0x04 | ((reg & 7) << 3));
+    byte(e, 0x80 | ((indice & 7) << 3) | (base & 7));
+}
+
+// Grupo 81 /ext (add=0, sub=5, cmp=7) con inmediato sobre un registro
+static void ri(Emisor_t *e, int w, int ext, int rm, int v) {
+    rex(e, w, 0, 0, rm);
+    byte(e, 0x81);
+    byte(e, 0xC0 | (ext << 3) | (rm & 7));
+    imm32(e, v);
+}
+
+// op /ext dword [base + desp], imm32 (81 para add/sub/cmp, C7 para mov)
+static void mem_imm(Emisor_t *e, int op, int ext, int base, int desp, int v) {
+    rex(e, 0, 0, 0, base);
+    byte(e, op);
+    byte(e, 0x80 | (ext << 3) | (base & 7));
+    if ((base & 7) == RSP) byte(e, 0x24);
+    imm32(e, desp);
+    imm32(e, v);
+}
+
+static void mov_ri(Emisor_t *e, int reg, int v) {
+    rex(e, 0, 0, 0, reg);
+    byte(e, 0xB8 + (reg & 7));
+    imm32(e, v);
+}
+
+static void mov_ri64(Emisor_t *e, int reg, const void *v) {
+    uint64_t valor = (uint64_t)(uintptr_t)v;
+
+    rex(e, 1, 0, 0, reg);
+    byte(e, 0xB8 + (reg & 7));
+    memcpy(e->p, &valor, 8);
+    e->p += 8;
+}
+
+// jcc/jmp rel32 a un destino que se resuelve después. Retorna el hueco
+static unsigned char *salto(Emisor_t *e, int cc) {
+    if (cc == SIEMPRE) {
+        byte(e, 0xE9);
+    } else {
+        byte(e, 0x0F);
+        byte(e, 0x80 | cc);
+    }
+    imm32(e, 0);
+    return e->p - 4;
+}
+
+static void parchar(unsigned char *hueco, const unsigned char *destino) {
+    int rel = (int)(destino - (hueco + 4));
+    memcpy(hueco, &rel, 4);
+}
+
+static int nueva_salida(Emisor_t *e, int retiradas, int mar, int pc, int lateral) {
+    Salida_t *s = &e->salidas[e->total_salidas];
+
+    s->retiradas = retiradas;
+    s->mar = mar;
+    s->pc = pc;
+    s->lateral = lateral;
+    return e->total_salidas++;
+}
+
+static void hacia(Emisor_t *e, int cc, int destino) {
+    e->huecos[e->total_huecos] = salto(e, cc);
+    e->destino[e->total_huecos++] = destino;
+}
+
+// Si se cumple 'cc', la palabra 'i' (en 'dir') la ejecuta el intérprete
+static void al_interprete(Emisor_t *e, int cc, int i, int dir) {
+    if (e->lateral[i] < 0) e->lateral[i] = nueva_salida(e, i, dir, dir, 1);
+    hacia(e, cc, e->lateral[i]);
+}
+
+// --- TRADUCCIÓN DE CADA PALABRA ---
+
+// Suma la instrucción en su contador (lo que hace el Fetch del intérprete)
+static void contar(Emisor_t *e, const Decodificada_t *d) {
+    mov_ri64(e, RAX, &contadores->instrucciones[d->contador]);
+    byte(e, 0x48); byte(e, 0xFF); byte(e, 0x00);   // inc qword [rax]
+}
+
+// r15d = 0 (=), 1 (<) o 2 (>) comparando ebx con 'reg' (o con 0)
+static void condicion(Emisor_t *e, int reg) {
+    rr(e, 0, 0x31, G_CC, G_CC);              // xor r15d, r15d
+    if (reg < 0) rr(e, 0, 0x85, G_AC, G_AC); // test ebx, ebx
+    else rr(e, 0, 0x39, reg, G_AC);          // cmp ebx, reg
+    byte(e, 0x74); byte(e, 14);              // je fin
+    mov_ri(e, G_CC, 1);
+    byte(e, 0x7C); byte(e, 6);               // jl fin
+    mov_ri(e, G_CC, 2);
+}
+
+// ecx = dirección física del operando, validada como validar_direccion
+// en el modo para el que se compila
+static void direccion(Emisor_t *e, const Decodificada_t *d, int i, int dir) {
+    rr(e, 0, 0x89, G_RB, RCX);                           // mov ecx, r13d
+    if (d->modo == DIR_INDEXADO) rr(e, 0, 0x01, G_RX, RCX); // add ecx, r12d
+    ri(e, 0, 0, RCX, d->operando);                       // add ecx, operando
+    if (cpu.psw.modo_operacion == 0) {
+        rr(e, 0, 0x39, G_RB, RCX);                       // cmp ecx, RB
+        al_interprete(e, CC_L, i, dir);
+        rr(e, 0, 0x39, G_RL, RCX);                       // cmp ecx, RL
+        al_interprete(e, CC_G, i, dir);
+    }
+    ri(e, 0, 7, RCX, maquina.tamano_memoria);
+    al_interprete(e, CC_AE, i, dir);
+}
+
+// ecx = valor del operando
+static void operando(Emisor_t *e, const Decodificada_t *d, int i, int dir) {
+    if (d->modo == DIR_INMEDIATO) {
+        mov_ri(e, RCX, d->operando);
+        return;
+    }
+    direccion(e, d, i, dir);
+    mov_ri64(e, RAX, maquina.memoria);
+    rm_indice(e, 0x8B, RCX, RAX, RCX);                   // mov ecx, [rax+rcx*4]
+}
+
+// AC = AC op ecx en 64 bits; fuera de 8 dígitos va al intérprete
+static void aritmetica(Emisor_t *e, int familia, int i, int dir) {
+    rr(e, 1, 0x63, RAX, G_AC);                           // movsxd rax, ebx
+    rr(e, 1, 0x63, RCX, RCX);                            // movsxd rcx, ecx
+    if (familia == H_SUM_DIRECTO) rr(e, 1, 0x01, RCX, RAX);
+    else if (familia == H_RES_DIRECTO) rr(e, 1, 0x29, RCX, RAX);
+    else { byte(e, 0x48); byte(e, 0x0F); byte(e, 0xAF); byte(e, 0xC1); } // imul rax, rcx
+    ri(e, 1, 7, RAX, MAX_VALOR);
+    al_interprete(e, CC_G, i, dir);
+    ri(e, 1, 7, RAX, MIN_VALOR);
+    al_interprete(e, CC_L, i, dir);
+    rr(e, 0, 0x89, RAX, G_AC);                           // mov ebx, eax
+    condicion(e, -1);
+}
+
+static int jit_escribir(int dir, int valor, const Bloque_t *b) {
+    escribir_memoria(dir, valor);
+    return VIGENTE(b);
+}
+
+// Mem[ecx] = 'fuente' por escribir_memoria (caché de decodificación,
+// invalidación y checkpoints). Si pisó el bloque, sale con la palabra ya
+// retirada. 'pila' = 1 para PSH, que baja SP después de escribir
+static void escribir(Emisor_t *e, const Bloque_t *b, const Decodificada_t *d, int i, int dir,
+                     int fuente, int pila) {
+    contar(e, d);
+    rr(e, 0, 0x89, RCX, RDI);                            // mov edi, ecx
+    rr(e, 0, 0x89, fuente, RSI);                         // mov esi, fuente
+    mov_ri64(e, RDX, b);
+    mov_ri64(e, RAX, (const void *)jit_escribir);
+    byte(e, 0xFF); byte(e, 0xD0);                        // call rax
+    if (pila) ri(e, 0, 5, G_SP, 1);                      // sub ebp, 1
+    rr(e, 0, 0x85, RAX, RAX);
+    hacia(e, CC_E, nueva_salida(e, i + 1, dir, dir + 1, 0));
+}
+
+// 1 si el JIT sabe traducir la palabra
+static int soportada(const Decodificada_t *d) {
+    // Las rutinas H_* son aritmética, cargas, COMP, STR/STRRX y saltos
+    if (d->indice != H_GENERICO) return 1;
+    return d->opcode == OP_LOADSP || d->opcode == OP_STRSP ||
+           d->opcode == OP_PSH || d->opcode == OP_POP;
+}
+
+static void emitir_palabra(Emisor_t *e, const Bloque_t *b, const Decodificada_t *d, int i, int dir) {
+    switch (d->indice) {
+        case H_SUM_DIRECTO: case H_SUM_INMEDIATO: case H_SUM_INDEXADO:
+            operando(e, d, i, dir);
+            aritmetica(e, H_SUM_DIRECTO, i, dir);
+            break;
+        case H_RES_DIRECTO: case H_RES_INMEDIATO: case H_RES_INDEXADO:
+            operando(e, d, i, dir);
+            aritmetica(e, H_RES_DIRECTO, i, dir);
+            break;
+        case H_MULT_DIRECTO: case H_MULT_INMEDIATO: case H_MULT_INDEXADO:
+            operando(e, d, i, dir);
+            aritmetica(e, H_MULT_DIRECTO, i, dir);
+            break;
+        case H_DIVI_DIRECTO: case H_DIVI_INMEDIATO: case H_DIVI_INDEXADO:
+            // Dividir por 0 interrumpe y por -1 puede desbordar idiv
+            operando(e, d, i, dir);
+            rr(e, 0, 0x85, RCX, RCX);
+            al_interprete(e, CC_E, i, dir);
+            ri(e, 0, 7, RCX, -1);
+            al_interprete(e, CC_E, i, dir);
+            rr(e, 0, 0x89, G_AC, RAX);                   // mov eax, ebx
+            byte(e, 0x99);                               // cdq
+            byte(e, 0xF7); byte(e, 0xF9);                // idiv ecx
+            rr(e, 0, 0x89, RAX, G_AC);
+            condicion(e, -1);
+            break;
+        case H_LOAD_DIRECTO: case H_LOAD_INMEDIATO: case H_LOAD_INDEXADO:
+            operando(e, d, i, dir);
+            rr(e, 0, 0x89, RCX, G_AC);
+            break;
+        case H_LOADRX_DIRECTO: case H_LOADRX_INMEDIATO: case H_LOADRX_INDEXADO:
+            operando(e, d, i, dir);
+            rr(e, 0, 0x89, RCX, G_RX);
+            break;
+        case H_COMP_DIRECTO: case H_COMP_INMEDIATO: case H_COMP_INDEXADO:
+            operando(e, d, i, dir);
+            condicion(e, RCX);
+            break;
+        case H_STR_DIRECTO: case H_STR_INDEXADO:
+            direccion(e, d, i, dir);
+            escribir(e, b, d, i, dir, G_AC, 0);
+            return;
+        case H_STRRX_DIRECTO: case H_STRRX_INDEXADO:
+            direccion(e, d, i, dir);
+            escribir(e, b, d, i, dir, G_RX, 0);
+            return;
+        default:
+            switch (d->opcode) {
+                case OP_LOADSP:
+                    rr(e, 0, 0x89, G_SP, G_AC);
+                    break;
+                case OP_STRSP:
+                    rr(e, 0, 0x89, G_AC, G_SP);
+                    break;
+                case OP_PSH:
+                    // SP >= 0 y RB + SP <= RL (y dentro de la RAM)
+                    rr(e, 0, 0x85, G_SP, G_SP);
+                    al_interprete(e, CC_L, i, dir);
+                    rr(e, 0, 0x89, G_RB, RCX);
+                    rr(e, 0, 0x01, G_SP, RCX);           // ecx = RB + SP
+                    rr(e, 0, 0x39, G_RL, RCX);
+                    al_interprete(e, CC_G, i, dir);
+                    ri(e, 0, 7, RCX, maquina.tamano_memoria);
+                    al_interprete(e, CC_AE, i, dir);
+                    escribir(e, b, d, i, dir, G_AC, 1);
+                    return;
+                case OP_POP:
+                    // SP < RL - RB; después SP++ y AC = Mem[RB + SP]
+                    rr(e, 0, 0x89, G_RL, RAX);
+                    rr(e, 0, 0x29, G_RB, RAX);           // eax = RL - RB
+                    rr(e, 0, 0x39, RAX, G_SP);           // cmp ebp, eax
+                    al_interprete(e, CC_GE, i, dir);
+                    rr(e, 0, 0x89, G_RB, RCX);
+                    rr(e, 0, 0x01, G_SP, RCX);
+                    ri(e, 0, 0, RCX, 1);                 // ecx = RB + SP + 1
+                    ri(e, 0, 7, RCX, maquina.tamano_memoria);
+                    al_interprete(e, CC_AE, i, dir);
+                    ri(e, 0, 0, G_SP, 1);
+                    mov_ri64(e, RAX, maquina.memoria);
+                    rm_indice(e, 0x8B, G_AC, RAX, RCX);  // mov ebx, [rax+rcx*4]
+                    break;
+            }
+            break;
+    }
+    contar(e, d);
+}
+
+// Último salto del bloque. Si vuelve al comienzo del mismo bloque, da
+// otra vuelta sin salir mientras entre en el lote y nadie lo haya pisado
+static void emitir_salto(Emisor_t *e, const Bloque_t *b, const Decodificada_t *d, int dir,
+                         const unsigned char *lazo) {
+    unsigned char *no_tomado = NULL, *fuera, *fin_lazo[3];
+    int inicio = b->op[0].dir;
+
+    contar(e, d);
+    switch (d->indice) {
+        case H_JMPE:   ri(e, 0, 7, G_CC, 0); no_tomado = salto(e, CC_NE); break;
+        case H_JMPNE:  ri(e, 0, 7, G_CC, 0); no_tomado = salto(e, CC_E); break;
+        case H_JMPLT:  ri(e, 0, 7, G_CC, 1); no_tomado = salto(e, CC_NE); break;
+        case H_JMPLGT: ri(e, 0, 7, G_CC, 2); no_tomado = salto(e, CC_NE); break;
+    }
+
+    rr(e, 0, 0x89, G_RB, RDX);
+    ri(e, 0, 0, RDX, d->operando);                       // edx = RB + operando
+    ri(e, 0, 7, RDX, inicio);
+    fuera = salto(e, CC_NE);
+
+    mem_imm(e, 0x81, 0, RSP, 0, b->palabras);            // retiradas += palabras
+    mem_imm(e, 0x81, 5, RSP, 4, b->palabras);            // lote -= palabras
+    mem_imm(e, 0x81, 7, RSP, 4, b->palabras);
+    fin_lazo[0] = salto(e, CC_L);
+    for (int r = 0; r < 2; r++) {
+        mov_ri64(e, RAX, &bloques_generacion[b->region[r]]);
+        mem_imm(e, 0x81, 7, RAX, 0, (int)b->generacion[r]);
+        fin_lazo[1 + r] = salto(e, CC_NE);
+    }
+    parchar(salto(e, SIEMPRE), lazo);
+
+    // Lo de esta vuelta ya está sumado en [rsp]
+    for (int k = 0; k < 3; k++) parchar(fin_lazo[k], e->p);
+    mov_ri(e, RAX, 0);
+    mov_ri(e, RCX, dir);
+    mov_ri(e, RSI, 0);
+    hacia(e, SIEMPRE, COMUN);
+
+    parchar(fuera, e->p);
+    mov_ri(e, RAX, b->palabras);
+    mov_ri(e, RCX, dir);
+    mov_ri(e, RSI, 0);
+    hacia(e, SIEMPRE, COMUN);
+
+    if (no_tomado != NULL) {
+        parchar(no_tomado, e->p);
+        hacia(e, SIEMPRE, nueva_salida(e, b->palabras, dir, dir + 1, 0));
+    }
+}
+
+static int es_salto(int indice) {
+    return indice == H_JMPE || indice == H_JMPNE || indice == H_JMPLT ||
+           indice == H_JMPLGT || indice == H_J;
+}
+
+static void prologo(Emisor_t *e) {
+    byte(e, 0x53); byte(e, 0x55);                        // push rbx, rbp
+    byte(e, 0x41); byte(e, 0x54); byte(e, 0x41); byte(e, 0x55);   // push r12, r13
+    byte(e, 0x41); byte(e, 0x56); byte(e, 0x41); byte(e, 0x57);   // push r14, r15
+    ri(e, 1, 5, RSP, 8);                                 // sub rsp, 8 (pila alineada)
+    mem_imm(e, 0xC7, 0, RSP, 0, 0);                      // [rsp] = 0
+    rm_mem(e, 0x89, RDI, RSP, 4);                        // [rsp+4] = restantes
+    mov_ri64(e, RAX, &cpu);
+    rm_mem(e, 0x8B, G_AC, RAX, offsetof(CPU_t, AC));
+    rm_mem(e, 0x8B, G_RX, RAX, offsetof(CPU_t, RX));
+    rm_mem(e, 0x8B, G_SP, RAX, offsetof(CPU_t, SP));
+    rm_mem(e, 0x8B, G_RB, RAX, offsetof(CPU_t, RB));
+    rm_mem(e, 0x8B, G_RL, RAX, offsetof(CPU_t, RL));
+    rm_mem(e, 0x8B, G_CC, RAX, offsetof(CPU_t, psw.codigo_condicion));
+}
+
+// Devuelve los registros a cpu y retorna retiradas | lateral << 32
+static void rutina_comun(Emisor_t *e) {
+    rm_mem(e, 0x03, RAX, RSP, 0);                        // add eax, [rsp]
+    mov_ri64(e, RDI, &cpu);
+    rm_mem(e, 0x89, G_AC, RDI, offsetof(CPU_t, AC));
+    rm_mem(e, 0x89, G_RX, RDI, offsetof(CPU_t, RX));
+    rm_mem(e, 0x89, G_SP, RDI, offsetof(CPU_t, SP));
+    rm_mem(e, 0x89, G_CC, RDI, offsetof(CPU_t, psw.codigo_condicion));
+    rm_mem(e, 0x89, RDX, RDI, offsetof(CPU_t, psw.pc));
+    rm_mem(e, 0x89, RCX, RDI, offsetof(CPU_t, MAR));
+    byte(e, 0x48); byte(e, 0xC1); byte(e, 0xE6); byte(e, 32);   // shl rsi, 32
+    rr(e, 1, 0x09, RSI, RAX);                            // or rax, rsi
+    ri(e, 1, 0, RSP, 8);
+    byte(e, 0x41); byte(e, 0x5F); byte(e, 0x41); byte(e, 0x5E);   // pop r15, r14
+    byte(e, 0x41); byte(e, 0x5D); byte(e, 0x41); byte(e, 0x5C);   // pop r13, r12
+    byte(e, 0x5D); byte(e, 0x5B);                        // pop rbp, rbx
+    byte(e, 0xC3);                                       // ret
+}
+
+int jit_compilar(Bloque_t *b) {
+    Emisor_t e;
+    unsigned char *codigo, *lazo, *comun, *destinos[2 * BLOQUE_MAX + 2];
+    int inicio = b->op[0].dir, terminado = 0;
+
+    if (b->palabras == 0 || !soportada(b->op[0].d[0])) return 0;
+    if (arena == NULL) {
+        void *m = mmap(NULL, JIT_ARENA, PROT_READ | PROT_WRITE | PROT_EXEC,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED) {
+            LOG_ERROR("[JIT] No se pudo reservar la arena de codigo\n");
+            return 0;
+        }
+        arena = m;
+        usado = 0;
+    }
+    if (!jit_hay_lugar()) return 0;
+
+    memset(&e, 0, sizeof(e));
+    memset(e.lateral, -1, sizeof(e.lateral));
+    codigo = e.p = arena + usado;
+
+    prologo(&e);
+    lazo = e.p;
+    for (int k = 0; k < b->ops && !terminado; k++) {
+        const OpBloque_t *op = &b->op[k];
+
+        for (int j = 0; j < op->largo && !terminado; j++) {
+            const Decodificada_t *d = op->d[j];
+            int dir = op->dir + j;
+
+            if (!soportada(d)) {
+                // Desde acá sigue el intérprete
+                hacia(&e, SIEMPRE, nueva_salida(&e, dir - inicio, dir - 1, dir, 0));
+                terminado = 1;
+            } else if (es_salto(d->indice)) {
+                emitir_salto(&e, b, d, dir, lazo);
+                terminado = 1;
+            } else {
+                emitir_palabra(&e, b, d, dir - inicio, dir);
+            }
+        }
+    }
+    if (!terminado) {
+        // Bloque cortado por largo: sigue en la palabra de al lado
+        hacia(&e, SIEMPRE, nueva_salida(&e, b->palabras, inicio + b->palabras - 1,
+                                        inicio + b->palabras, 0));
+    }
+
+    for (int s = 0; s < e.total_salidas; s++) {
+        destinos[s] = e.p;
+        mov_ri(&e, RAX, e.salidas[s].retiradas);
+        mov_ri(&e, RCX, e.salidas[s].mar);
+        mov_ri(&e, RDX, e.salidas[s].pc);
+        mov_ri(&e, RSI, e.salidas[s].lateral);
+        hacia(&e, SIEMPRE, COMUN);
+    }
+    comun = e.p;
+    rutina_comun(&e);
+    for (int h = 0; h < e.total_huecos; h++) {
+        parchar(e.huecos[h], e.destino[h] == COMUN ? comun : destinos[e.destino[h]]);
+    }
+
+    b->nativo = (nativo_t)(void *)codigo;
+    b->modo_nativo = cpu.psw.modo_operacion;
+    usado = (e.p - arena + 15) & ~(size_t)15;
+    atomic_fetch_add_explicit(&compilados, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes_nativos, e.p - codigo, memory_order_relaxed);
+    return 1;
+}
+
+int jit_hay_lugar() {
+    return usado + JIT_MAX_BLOQUE <= JIT_ARENA;
+}
+
+void jit_vaciar() {
+    usado = 0;
+}
+
+void jit_liberar() {
+    if (arena != NULL) munmap(arena, JIT_ARENA);
+    arena = NULL;
+    usado = 0;
+}
+
+void jit_reporte() {
+    if (atomic_load(&compilados) > 0) {
+        logger_log("[JIT] %llu bloques compilados (%llu bytes de codigo nativo)\n",
+            (unsigned long long)atomic_load(&compilados), (unsigned long long)atomic_load(&bytes_nativos));
+    }
+}
+
+#else
+
+// Host sin x86-64/Linux: --motor=jit queda en el motor de bloques
+
+int jit_disponible() {
+    return 0;
+}
+
+int jit_compilar(Bloque_t *b) {
+    return 0;
+}
+
+int jit_hay_lugar() {
+    return 0;
+}
+
+void jit_vaciar() {
+}
+
+void jit_liberar() {
+}
+
+void jit_reporte() {
+}
+
+#endif
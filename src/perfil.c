@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+#include "../include/perfil.h"
+#include "../include/cpu.h"
+#include "../include/procesos.h"
+#include "../include/logger.h"
+#include "../include/arena.h"
+
+#define MAX_ARISTAS 4096   // Por núcleo (potencia de 2)
+#define MAX_FUENTES 64     // Tramos cargados: uno por proceso, o uno por página con --paginacion
+
+typedef struct {
+    int origen;
+    int destino;
+    unsigned long long cuenta;   // 0 = lugar libre
+} Arista_t;
+
+// Lo de un núcleo: solo lo escribe su hilo (o el SIGPROF que lo interrumpe)
+typedef struct {
+    unsigned long long *cuentas;   // Una por palabra de RAM (NULL = núcleo que no corre)
+    Arista_t aristas[MAX_ARISTAS];
+    unsigned long long aristas_perdidas;   // Tabla llena
+} PerfilNucleo_t;
+
+typedef struct {
+    int inicio;
+    int fin;
+    unsigned long long suma;   // Instrucciones retiradas en todo el bloque
+} Bloque_t;
+
+// De dónde salió cada palabra cargada
+typedef struct {
+    char ruta[256];
+    int base;
+    int palabras;
+    int *lineas;   // NULL si vino de una imagen
+} Fuente_t;
+
+int perfil_periodo_us = PERFIL_PERIODO_DEFECTO;
+int perfil_exacto = 0;
+int perfil_muestreo = 0;
+__thread volatile sig_atomic_t perfil_en_lote = 0;
+__thread int perfil_anterior = -1;
+
+static PerfilNucleo_t por_nucleo[MAX_NUCLEOS];
+static atomic_ullong muestras_fuera = 0;
+static int modo_actual = PERFIL_APAGADO;
+static char ruta_reporte[1024];
+
+static Fuente_t fuentes[MAX_FUENTES];
+static int total_fuentes = 0;
+
+// Totales de todos los núcleos (los arma el reporte) y tablas del reporte
+static unsigned long long *total_dir;
+static int *orden;
+static unsigned char *lider;
+static Bloque_t *bloques;
+
+void perfil_fuente(const char *ruta, int base, int palabras, const int *lineas) {
+    Fuente_t *f;
+
+    // Una partición recargada reemplaza a su fuente anterior
+    for (int i = 0; i < total_fuentes; i++) {
+        if (fuentes[i].base == base) {
+            free(fuentes[i].lineas);
+            fuentes[i] = fuentes[--total_fuentes];
+            break;
+        }
+    }
+    if (total_fuentes == MAX_FUENTES) return;
+
+    f = &fuentes[total_fuentes];
+    snprintf(f->ruta, sizeof(f->ruta), "%s", ruta);
+    f->base = base;
+    f->palabras = palabras;
+    f->lineas = NULL;
+    if (lineas != NULL && palabras > 0 && (f->lineas = malloc(palabras * sizeof(int))) != NULL) {
+        memcpy(f->lineas, lineas, palabras * sizeof(int));
+    }
+    total_fuentes++;
+}
+
+// --- CAPTURA ---
+
+static void al_muestrear(int senal) {
+    (void)senal;
+
+    // Solo cuenta si interrumpió a un núcleo en medio de un lote
+    if (perfil_en_lote && cpu.MAR >= 0 && cpu.MAR < maquina.tamano_memoria) {
+        por_nucleo[cpu.nucleo].cuentas[cpu.MAR]++;
+    } else {
+        atomic_fetch_add_explicit(&muestras_fuera, 1, memory_order_relaxed);
+    }
+}
+
+static void liberar_cuentas() {
+    for (int c = 0; c < MAX_NUCLEOS; c++) {
+        arena_liberar(por_nucleo[c].cuentas, (size_t)maquina.tamano_memoria * sizeof(unsigned long long));
+        por_nucleo[c].cuentas = NULL;
+    }
+}
+
+int perfil_abrir(const char *ruta, int modo) {
+    struct sigaction accion;
+    struct itimerval periodo;
+
+    snprintf(ruta_reporte, sizeof(ruta_reporte), "%s", ruta);
+    memset(por_nucleo, 0, sizeof(por_nucleo));
+
+    // Las cuentas van en arenas: con una RAM grande solo ocupan lo que se ejecuta
+    for (int c = 0; c < maquina.nucleos; c++) {
+        por_nucleo[c].cuentas = arena_reservar((size_t)maquina.tamano_memoria * sizeof(unsigned long long));
+        if (por_nucleo[c].cuentas == NULL) {
+            LOG_ERROR("[ERROR] No hay memoria para el perfil\n");
+            liberar_cuentas();
+            return 0;
+        }
+    }
+    modo_actual = modo;
+
+    if (modo == PERFIL_EXACTO) {
+        perfil_exacto = 1;
+        logger_log("[PERFIL] Conteo exacto por direccion; reporte en %s\n", ruta);
+        return 1;
+    }
+
+    // SIGPROF cuenta tiempo de CPU: un hilo dormido no genera muestras
+    memset(&accion, 0, sizeof(accion));
+    accion.sa_handler = al_muestrear;
+    accion.sa_flags = SA_RESTART;
+    sigemptyset(&accion.sa_mask);
+    periodo.it_interval.tv_sec = perfil_periodo_us / 1000000;
+    periodo.it_interval.tv_usec = perfil_periodo_us % 1000000;
+    periodo.it_value = periodo.it_interval;
+    if (sigaction(SIGPROF, &accion, NULL) != 0 || setitimer(ITIMER_PROF, &periodo, NULL) != 0) {
+        perror("[ERROR] No se pudo arrancar el muestreo");
+        liberar_cuentas();
+        modo_actual = PERFIL_APAGADO;
+        return 0;
+    }
+    perfil_muestreo = 1;
+    logger_log("[PERFIL] Muestreo cada %d us de CPU; reporte en %s\n", perfil_periodo_us, ruta);
+    return 1;
+}
+
+static void agregar_arista(PerfilNucleo_t *p, int origen, int destino) {
+    unsigned int h = ((unsigned int)origen * 2654435761u ^ (unsigned int)destino) & (MAX_ARISTAS - 1);
+
+    for (int i = 0; i < MAX_ARISTAS; i++, h = (h + 1) & (MAX_ARISTAS - 1)) {
+        Arista_t *a = &p->aristas[h];
+
+        if (a->cuenta == 0) {
+            a->origen = origen;
+            a->destino = destino;
+        } else if (a->origen != origen || a->destino != destino) {
+            continue;
+        }
+        a->cuenta++;
+        return;
+    }
+    p->aristas_perdidas++;
+}
+
+void perfil_retirar(int pc) {
+    PerfilNucleo_t *p = &por_nucleo[cpu.nucleo];
+
+    p->cuentas[pc]++;
+    if (perfil_anterior >= 0 && pc != perfil_anterior + 1) {
+        agregar_arista(p, perfil_anterior, pc);
+    }
+    perfil_anterior = pc;
+}
+
+// --- REPORTE ---
+
+static const Fuente_t *buscar_fuente(int dir) {
+    for (int i = 0; i < total_fuentes; i++) {
+        if (dir >= fuentes[i].base && dir < fuentes[i].base + fuentes[i].palabras) return &fuentes[i];
+    }
+    return NULL;
+}
+
+// Línea 'numero' del archivo, sin la sangría ni el salto de línea
+static void leer_linea(const char *ruta, int numero, char *texto, size_t tam) {
+    FILE *f = fopen(ruta, "r");
+    int c, actual = 1;
+    size_t n = 0, desde = 0;
+
+    texto[0] = '\0';
+    if (f == NULL) return;
+    while ((c = getc(f)) != EOF && actual <= numero) {
+        if (c == '\n') actual++;
+        else if (actual == numero && n + 1 < tam) texto[n++] = (char)c;
+    }
+    fclose(f);
+
+    while (n > 0 && (texto[n - 1] == '\r' || texto[n - 1] == ' ' || texto[n - 1] == '\t')) n--;
+    texto[n] = '\0';
+    while (texto[desde] == ' ' || texto[desde] == '\t') desde++;
+    memmove(texto, texto + desde, n - desde + 1);
+}
+
+// "archivo:linea" (o "imagen+desplazamiento") de una dirección
+static void ubicar(int dir, char *ubicacion, size_t tam) {
+    const Fuente_t *f = buscar_fuente(dir);
+
+    if (f == NULL) snprintf(ubicacion, tam, "?");
+    else if (f->lineas != NULL) snprintf(ubicacion, tam, "%s:%d", f->ruta, f->lineas[dir - f->base]);
+    else snprintf(ubicacion, tam, "%s+%d", f->ruta, dir - f->base);
+}
+
+// Texto fuente de una dirección (o la palabra, si vino de una imagen)
+static void fuente_de(int dir, char *texto, size_t tam) {
+    const Fuente_t *f = buscar_fuente(dir);
+
+    if (f != NULL && f->lineas != NULL) leer_linea(f->ruta, f->lineas[dir - f->base], texto, tam);
+    else snprintf(texto, tam, "%08d", maquina.memoria[dir]);
+}
+
+// Orden de mayor a menor
+static int comparar_direcciones(const void *a, const void *b) {
+    unsigned long long x = total_dir[*(const int *)a], y = total_dir[*(const int *)b];
+    return (x < y) - (x > y);
+}
+
+static int comparar_aristas(const void *a, const void *b) {
+    unsigned long long x = ((const Arista_t *)a)->cuenta, y = ((const Arista_t *)b)->cuenta;
+    return (x < y) - (x > y);
+}
+
+static int comparar_bloques(const void *a, const void *b) {
+    unsigned long long x = ((const Bloque_t *)a)->suma, y = ((const Bloque_t *)b)->suma;
+    return (x < y) - (x > y);
+}
+
+static const char *tipo_arista(int origen) {
+    switch (cache_decodificada[origen].opcode) {
+        case OP_J:      return "salto";
+        case OP_JMPE:
+        case OP_JMPNE:
+        case OP_JMPLT:
+        case OP_JMPLGT: return "condicional";
+        case OP_RETRN:  return "retorno";
+        default:        return "otro";
+    }
+}
+
+// 1 si la instrucción en 'dir' termina un bloque básico
+static int cierra_bloque(int dir) {
+    int op = cache_decodificada[dir].opcode;
+    return op == OP_J || op == OP_JMPE || op == OP_JMPNE || op == OP_JMPLT ||
+           op == OP_JMPLGT || op == OP_RETRN || op == OP_SVC;
+}
+
+static void escribir_calientes(FILE *f, unsigned long long total) {
+    char ubicacion[300], texto[200];
+    int n = 0;
+
+    for (int d = 0; d < maquina.tamano_memoria; d++) {
+        if (total_dir[d] > 0) orden[n++] = d;
+    }
+    qsort(orden, n, sizeof(int), comparar_direcciones);
+
+    fprintf(f, "\n## Direcciones calientes\n");
+    fprintf(f, "%7s %12s  %-4s  %-24s %s\n", "%", "cuenta", "dir", "fuente", "linea");
+    for (int i = 0; i < n && i < PERFIL_TOP; i++) {
+        int d = orden[i];
+
+        ubicar(d, ubicacion, sizeof(ubicacion));
+        fuente_de(d, texto, sizeof(texto));
+        fprintf(f, "%6.2f%% %12llu  %04d  %-24s %s\n",
+            100.0 * total_dir[d] / total, total_dir[d], d, ubicacion, texto);
+    }
+}
+
+// Junta las aristas de todos los núcleos en 'todas'. Retorna cuántas quedaron
+static int juntar_aristas(Arista_t *todas) {
+    int n = 0;
+
+    for (int c = 0; c < MAX_NUCLEOS; c++) {
+        for (int i = 0; i < MAX_ARISTAS; i++) {
+            const Arista_t *a = &por_nucleo[c].aristas[i];
+            int k;
+
+            if (a->cuenta == 0) continue;
+            for (k = 0; k < n; k++) {
+                if (todas[k].origen == a->origen && todas[k].destino == a->destino) break;
+            }
+            if (k == n) todas[n++] = *a;
+            else todas[k].cuenta += a->cuenta;
+        }
+    }
+    return n;
+}
+
+// Bloques básicos: empiezan donde llega una arista, después de un salto o
+// tras una dirección que nunca se ejecutó
+static void escribir_bloques(FILE *f, const Arista_t *aristas, int total_aristas) {
+    char desde[300], hasta[300];
+    int n = 0;
+
+    for (int i = 0; i < total_aristas; i++) lider[aristas[i].destino] = 1;
+    for (int d = 0; d < maquina.tamano_memoria; d++) {
+        if (total_dir[d] > 0 && (d == 0 || total_dir[d - 1] == 0 || cierra_bloque(d - 1))) lider[d] = 1;
+    }
+
+    for (int d = 0; d < maquina.tamano_memoria; d++) {
+        Bloque_t *b = &bloques[n];
+
+        if (!lider[d]) continue;
+        b->inicio = b->fin = d;
+        b->suma = total_dir[d];
+        while (!cierra_bloque(b->fin) && b->fin + 1 < maquina.tamano_memoria &&
+               !lider[b->fin + 1] && total_dir[b->fin + 1] > 0) {
+            b->fin++;
+            b->suma += total_dir[b->fin];
+        }
+        n++;
+    }
+    qsort(bloques, n, sizeof(Bloque_t), comparar_bloques);
+
+    fprintf(f, "\n## Bloques basicos (por instrucciones retiradas)\n");
+    fprintf(f, "%12s %12s  %-9s  %s\n", "instrucciones", "entradas", "dirs", "fuente");
+    for (int i = 0; i < n && i < PERFIL_TOP; i++) {
+        ubicar(bloques[i].inicio, desde, sizeof(desde));
+        ubicar(bloques[i].fin, hasta, sizeof(hasta));
+        fprintf(f, "%12llu %12llu  %04d-%04d  %s .. %s\n", bloques[i].suma,
+            total_dir[bloques[i].inicio], bloques[i].inicio, bloques[i].fin, desde, hasta);
+    }
+}
+
+static void escribir_aristas(FILE *f, Arista_t *aristas, int n) {
+    char desde[300], hasta[300];
+
+    qsort(aristas, n, sizeof(Arista_t), comparar_aristas);
+
+    fprintf(f, "\n## Aristas (saltos tomados y retornos)\n");
+    fprintf(f, "%12s  %-11s  %-4s    %-4s  %s\n", "cuenta", "tipo", "de", "a", "fuente");
+    for (int i = 0; i < n && i < PERFIL_TOP; i++) {
+        ubicar(aristas[i].origen, desde, sizeof(desde));
+        ubicar(aristas[i].destino, hasta, sizeof(hasta));
+        fprintf(f, "%12llu  %-11s  %04d -> %04d  %s -> %s\n", aristas[i].cuenta,
+            tipo_arista(aristas[i].origen), aristas[i].origen, aristas[i].destino, desde, hasta);
+    }
+
+    // Llamadas: un RETRN a 'r' vuelve de la subrutina que saltó desde r-1
+    fprintf(f, "\n## Llamadas (J seguido de RETRN a la instruccion siguiente)\n");
+    fprintf(f, "%12s  %-4s    %-4s  %s\n", "cuenta", "de", "a", "fuente");
+    for (int i = 0; i < n; i++) {
+        int sitio = aristas[i].destino - 1;
+
+        if (cache_decodificada[aristas[i].origen].opcode != OP_RETRN || sitio < 0 ||
+            cache_decodificada[sitio].opcode != OP_J) {
+            continue;
+        }
+        for (int k = 0; k < n; k++) {
+            if (aristas[k].origen != sitio) continue;
+            ubicar(sitio, desde, sizeof(desde));
+            ubicar(aristas[k].destino, hasta, sizeof(hasta));
+            fprintf(f, "%12llu  %04d -> %04d  %s -> %s\n",
+                aristas[i].cuenta, sitio, aristas[k].destino, desde, hasta);
+        }
+    }
+}
+
+// Suelta las tablas del reporte y las cuentas de los núcleos
+static void liberar_reporte(size_t palabras) {
+    arena_liberar(total_dir, palabras * sizeof(unsigned long long));
+    arena_liberar(orden, palabras * sizeof(int));
+    arena_liberar(lider, palabras);
+    arena_liberar(bloques, palabras * sizeof(Bloque_t));
+    total_dir = NULL;
+    orden = NULL;
+    lider = NULL;
+    bloques = NULL;
+    liberar_cuentas();
+}
+
+void perfil_cerrar() {
+    static Arista_t aristas[MAX_ARISTAS * MAX_NUCLEOS];
+    struct itimerval nada;
+    unsigned long long total = 0, perdidas = 0;
+    size_t palabras;
+    int n;
+    FILE *f;
+
+    if (modo_actual == PERFIL_APAGADO) return;
+    memset(&nada, 0, sizeof(nada));
+    if (modo_actual == PERFIL_MUESTREO) setitimer(ITIMER_PROF, &nada, NULL);
+    perfil_exacto = 0;
+    perfil_muestreo = 0;
+
+    palabras = maquina.tamano_memoria;
+    total_dir = arena_reservar(palabras * sizeof(unsigned long long));
+    orden = arena_reservar(palabras * sizeof(int));
+    lider = arena_reservar(palabras);
+    bloques = arena_reservar(palabras * sizeof(Bloque_t));
+    f = (total_dir && orden && lider && bloques) ? fopen(ruta_reporte, "w") : NULL;
+    if (f == NULL) {
+        perror("[ERROR] No se pudo escribir el perfil");
+        modo_actual = PERFIL_APAGADO;
+        liberar_reporte(palabras);
+        return;
+    }
+
+    for (int c = 0; c < MAX_NUCLEOS; c++) {
+        if (por_nucleo[c].cuentas == NULL) continue;
+        for (size_t d = 0; d < palabras; d++) total_dir[d] += por_nucleo[c].cuentas[d];
+    }
+    for (size_t d = 0; d < palabras; d++) total += total_dir[d];
+
+    if (modo_actual == PERFIL_EXACTO) {
+        fprintf(f, "# Perfil exacto: %llu instrucciones retiradas\n", total);
+    } else {
+        fprintf(f, "# Perfil por muestreo cada %d us de CPU: %llu muestras en los programas, "
+                   "%llu fuera (planificador, interrupciones, DMA, ocio)\n",
+            perfil_periodo_us, total, (unsigned long long)atomic_load(&muestras_fuera));
+    }
+    if (total > 0) escribir_calientes(f, total);
+
+    // Las aristas solo existen en el modo exacto
+    if (modo_actual == PERFIL_EXACTO && total > 0) {
+        n = juntar_aristas(aristas);
+        escribir_bloques(f, aristas, n);
+        escribir_aristas(f, aristas, n);
+        for (int c = 0; c < MAX_NUCLEOS; c++) perdidas += por_nucleo[c].aristas_perdidas;
+        if (perdidas > 0) fprintf(f, "\n# %llu aristas sin lugar en la tabla\n", perdidas);
+    }
+    fclose(f);
+
+    logger_log("[PERFIL] Reporte escrito en %s\n", ruta_reporte);
+    modo_actual = PERFIL_APAGADO;
+    liberar_reporte(palabras);
+    for (int i = 0; i < total_fuentes; i++) free(fuentes[i].lineas);
+    total_fuentes = 0;
+}
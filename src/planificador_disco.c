@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../include/planificador_disco.h"
+#include "../include/logger.h"
+
+int pd_politica = PD_FCFS;
+ModeloDisco_t pd_modelo = {
+    PD_SEEK_BASE_DEFECTO, PD_SEEK_CILINDRO_DEFECTO, PD_ROTACION_DEFECTO
+};
+
+static const char *NOMBRES[] = { "FCFS", "SSTF", "SCAN", "C-SCAN" };
+
+// Estado del brazo (solo lo toca el hilo del DMA)
+static int cilindro_actual = 0;
+static int sentido = 1;              // SCAN: +1 hacia arriba, -1 hacia abajo
+static double reloj_disco = 0;       // us simulados
+static double inicio_actual = 0;     // Cuando empezó la solicitud en curso
+static struct timespec arranque;
+
+// Estadísticas
+static unsigned long long solicitudes = 0;
+static unsigned long long recorrido = 0;   // Cilindros recorridos por el brazo
+static double suma_latencia = 0, suma_espera = 0, max_latencia = 0;
+
+int pd_politica_desde_texto(const char *texto) {
+    if (strcmp(texto, "fcfs") == 0)  return PD_FCFS;
+    if (strcmp(texto, "sstf") == 0)  return PD_SSTF;
+    if (strcmp(texto, "scan") == 0)  return PD_SCAN;
+    if (strcmp(texto, "cscan") == 0) return PD_CSCAN;
+    return -1;
+}
+
+int pd_modelo_desde_texto(const char *texto) {
+    ModeloDisco_t m;
+
+    if (sscanf(texto, "%d,%d,%d", &m.seek_base_us, &m.seek_cilindro_us, &m.rotacion_us) != 3 ||
+        m.seek_base_us < 0 || m.seek_cilindro_us < 0 || m.rotacion_us < 0) {
+        return 0;
+    }
+    pd_modelo = m;
+    return 1;
+}
+
+void pd_reiniciar() {
+    cilindro_actual = 0;
+    sentido = 1;
+    reloj_disco = 0;
+    inicio_actual = 0;
+    solicitudes = 0;
+    recorrido = 0;
+    suma_latencia = suma_espera = max_latencia = 0;
+    clock_gettime(CLOCK_MONOTONIC, &arranque);
+}
+
+long long pd_ahora_us() {
+    struct timespec ahora;
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (ahora.tv_sec - arranque.tv_sec) * 1000000LL + (ahora.tv_nsec - arranque.tv_nsec) / 1000;
+}
+
+// Lleva el brazo al cilindro indicado y retorna el tiempo de seek
+static double mover_brazo(int cilindro) {
+    int distancia = abs(cilindro - cilindro_actual);
+
+    cilindro_actual = cilindro;
+    if (distancia == 0) return 0;
+    recorrido += distancia;
+    return pd_modelo.seek_base_us + (double)pd_modelo.seek_cilindro_us * distancia;
+}
+
+// Cilindro donde empieza una solicitud. Una cadena (o un vaciado de la
+// caché) no se conoce hasta atenderla: se la trata como si estuviera bajo
+// la cabeza.
+static int cilindro_de(const SolicitudDMA_t *s) {
+    return (s->cadena != -1) ? cilindro_actual : s->cilindro;
+}
+
+// La solicitud más cercana en el sentido dado (-1 si no hay ninguna)
+static int mas_cercana_hacia(const SolicitudDMA_t *cola, int cantidad, int hacia) {
+    int elegida = -1, mejor = 0;
+
+    for (int i = 0; i < cantidad; i++) {
+        int distancia = (cilindro_de(&cola[i]) - cilindro_actual) * hacia;
+        if (distancia < 0) continue;
+        if (elegida < 0 || distancia < mejor) {
+            elegida = i;
+            mejor = distancia;
+        }
+    }
+    return elegida;
+}
+
+int pd_elegir(const SolicitudDMA_t *cola, int cantidad) {
+    int elegida = 0;
+
+    switch (pd_politica) {
+        case PD_SSTF: {
+            int mejor = abs(cilindro_de(&cola[0]) - cilindro_actual);
+            for (int i = 1; i < cantidad; i++) {
+                int distancia = abs(cilindro_de(&cola[i]) - cilindro_actual);
+                if (distancia < mejor) {
+                    elegida = i;
+                    mejor = distancia;
+                }
+            }
+            break;
+        }
+        case PD_SCAN:
+            elegida = mas_cercana_hacia(cola, cantidad, sentido);
+            if (elegida < 0) {
+                // Nada adelante: el brazo llega al borde y da la vuelta
+                reloj_disco += mover_brazo(sentido > 0 ? disco.cilindros - 1 : 0);
+                sentido = -sentido;
+                elegida = mas_cercana_hacia(cola, cantidad, sentido);
+            }
+            break;
+        case PD_CSCAN:
+            elegida = mas_cercana_hacia(cola, cantidad, 1);
+            if (elegida < 0) {
+                // Nada adelante: sube hasta el borde y regresa al cilindro 0
+                reloj_disco += mover_brazo(disco.cilindros - 1);
+                reloj_disco += mover_brazo(0);
+                elegida = mas_cercana_hacia(cola, cantidad, 1);
+            }
+            break;
+        default: // PD_FCFS
+            break;
+    }
+    return elegida;
+}
+
+void pd_iniciar(const SolicitudDMA_t *s) {
+    // Si el disco estaba libre arranca cuando llegó la solicitud
+    if (reloj_disco < s->llegada_us) reloj_disco = s->llegada_us;
+    inicio_actual = reloj_disco;
+}
+
+// Tiempo hasta que 'sector' pase bajo la cabeza en el instante 'momento'
+static double espera_rotacion(int sector, double momento) {
+    double por_sector, bajo_cabeza;
+
+    if (pd_modelo.rotacion_us == 0) return 0;
+    por_sector = (double)pd_modelo.rotacion_us / disco.sectores;
+    bajo_cabeza = fmod(momento / por_sector, disco.sectores);
+    return fmod(sector - bajo_cabeza + disco.sectores, disco.sectores) * por_sector;
+}
+
+long long pd_servir(int cilindro, int sector, int cantidad) {
+    double por_sector = (double)pd_modelo.rotacion_us / disco.sectores;
+    double t = mover_brazo(cilindro);
+    int restantes = cantidad;
+
+    // Una ráfaga larga sigue en el cilindro siguiente (o vuelve al 0 al
+    // pasar a la próxima pista) y paga un seek por cada cambio
+    while (1) {
+        int tramo = disco.sectores - sector;
+        if (tramo > restantes) tramo = restantes;
+
+        t += espera_rotacion(sector, reloj_disco + t);
+        t += tramo * por_sector;
+        restantes -= tramo;
+        if (restantes <= 0) break;
+
+        sector = 0;
+        t += mover_brazo((cilindro_actual + 1) % disco.cilindros);
+    }
+
+    reloj_disco += t;
+    return llround(t);
+}
+
+void pd_terminar(const SolicitudDMA_t *s) {
+    double latencia = reloj_disco - s->llegada_us;
+    double espera = inicio_actual - s->llegada_us;
+
+    solicitudes++;
+    suma_latencia += latencia;
+    suma_espera += espera;
+    if (latencia > max_latencia) max_latencia = latencia;
+
+    LOG_DEBUG("[DISCO] Solicitud #%llu (cil %d): espera %.0f us, servicio %.0f us, latencia %.0f us\n",
+        solicitudes, cilindro_actual, espera, reloj_disco - inicio_actual, latencia);
+}
+
+void pd_reporte() {
+    if (solicitudes == 0) return;
+
+    logger_log("[DISCO] Planificador %s: %llu solicitudes, brazo recorrio %llu cilindros\n",
+        NOMBRES[pd_politica], solicitudes, recorrido);
+    logger_log("[DISCO] Latencia media %.0f us (espera en cola %.0f us), maxima %.0f us\n",
+        suma_latencia / solicitudes, suma_espera / solicitudes, max_latencia);
+    logger_log("[DISCO] Tiempo simulado %.3f s (%.1f solicitudes por segundo simulado)\n",
+        reloj_disco / 1e6, reloj_disco > 0 ? solicitudes / (reloj_disco / 1e6) : 0.0);
+}
+
+// --- CHECKPOINT ---
+// El reloj real viaja como "us desde el arranque": al restaurar se corre
+// 'arranque' hacia atrás y las marcas ya tomadas siguen valiendo
+typedef struct {
+    long long ahora_us;
+    int cilindro_actual;
+    int sentido;
+    double reloj_disco;
+    double inicio_actual;
+    unsigned long long solicitudes;
+    unsigned long long recorrido;
+    double suma_latencia, suma_espera, max_latencia;
+} FotoPlanificador_t;
+
+int pd_guardar(FILE *f) {
+    FotoPlanificador_t e = {
+        pd_ahora_us(), cilindro_actual, sentido, reloj_disco, inicio_actual,
+        solicitudes, recorrido, suma_latencia, suma_espera, max_latencia
+    };
+
+    return fwrite(&e, sizeof(e), 1, f) == 1;
+}
+
+int pd_restaurar(FILE *f) {
+    FotoPlanificador_t e;
+    long long ns;
+
+    if (fread(&e, sizeof(e), 1, f) != 1) return 0;
+    cilindro_actual = e.cilindro_actual;
+    sentido = e.sentido;
+    reloj_disco = e.reloj_disco;
+    inicio_actual = e.inicio_actual;
+    solicitudes = e.solicitudes;
+    recorrido = e.recorrido;
+    suma_latencia = e.suma_latencia;
+    suma_espera = e.suma_espera;
+    max_latencia = e.max_latencia;
+
+    clock_gettime(CLOCK_MONOTONIC, &arranque);
+    ns = arranque.tv_sec * 1000000000LL + arranque.tv_nsec - e.ahora_us * 1000;
+    arranque.tv_sec = ns / 1000000000LL;
+    arranque.tv_nsec = ns % 1000000000LL;
+    return 1;
+}
@@ -0,0 +1,435 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/procesos.h"
+#include "../include/interrupciones.h"
+#include "../include/loader.h"
+#include "../include/logger.h"
+#include "../include/mmu.h"
+
+int quantum_rr = QUANTUM_RR_DEFECTO;
+unsigned long long limite_instrucciones = 0;
+int total_procesos = 0;
+
+// La tabla y la cola de listos son de toda la máquina: los núcleos las
+// tocan bajo este mutex
+static pthread_mutex_t procesos_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static PCB_t tabla[MAX_PROCESOS];
+
+// Estado del planificador de cada núcleo (uno por hilo de CPU)
+static __thread int actual = -1;            // Índice en 'tabla' del proceso en este núcleo
+static __thread int ticks_turno = 0;        // Ticks de reloj del turno actual
+static __thread int cambio_pendiente = 0;   // El turno venció: ceder en el próximo despacho
+
+// Núcleos esperando en procesos_ocioso (bit n = núcleo n)
+static atomic_uint nucleos_ociosos = 0;
+
+// Cola de listos (FIFO circular de índices de 'tabla')
+static int listos[MAX_PROCESOS];
+static int listos_inicio = 0, listos_cantidad = 0;
+
+// Reloj de estadísticas
+static struct timespec arranque;
+static double ocioso_ms = 0;
+static unsigned long long cambios_contexto = 0;
+
+static double ahora_ms() {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec - arranque.tv_sec) * 1000.0 + (t.tv_nsec - arranque.tv_nsec) / 1e6;
+}
+
+static void encolar_listo(int i) {
+    tabla[i].estado = PROC_LISTO;
+    tabla[i].desde = ahora_ms();
+    listos[(listos_inicio + listos_cantidad) % MAX_PROCESOS] = i;
+    listos_cantidad++;
+}
+
+static int sacar_listo() {
+    int i = listos[listos_inicio];
+
+    listos_inicio = (listos_inicio + 1) % MAX_PROCESOS;
+    listos_cantidad--;
+    tabla[i].espera += ahora_ms() - tabla[i].desde;
+    return i;
+}
+
+// Despierta a un núcleo ocioso (que no sea este) para que tome un proceso listo
+static void despertar_ocioso() {
+    unsigned int ociosos = atomic_load(&nucleos_ociosos) & ~(1u << cpu.nucleo);
+
+    if (ociosos != 0) {
+        ic_postear_nucleo(__builtin_ctz(ociosos), INT_IPI);
+    }
+}
+
+void procesos_reiniciar() {
+    memset(tabla, 0, sizeof(tabla));
+    total_procesos = 0;
+    actual = -1;
+    ticks_turno = 0;
+    cambio_pendiente = 0;
+    listos_inicio = listos_cantidad = 0;
+    atomic_store(&nucleos_ociosos, 0);
+    ocioso_ms = 0;
+    cambios_contexto = 0;
+    clock_gettime(CLOCK_MONOTONIC, &arranque);
+}
+
+int procesos_crear(const char *programa, int indice, int particiones) {
+    int tamano = (maquina.tamano_memoria - INICIO_USUARIO) / particiones;
+    int entrada;
+    PCB_t *p;
+
+    if (total_procesos >= MAX_PROCESOS) {
+        LOG_ERROR("[SO] Error: Maximo %d procesos\n", MAX_PROCESOS);
+        return 0;
+    }
+    p = &tabla[total_procesos];
+
+    if (paginacion) {
+        // Espacio lógico propio desde 0, en los marcos que haya libres. Con
+        // memoria virtual puede ser más grande que los marcos (--marcos)
+        int paginas = paginas_proceso > 0 ? paginas_proceso
+                    : (memoria_virtual ? MARCOS - PRIMER_MARCO : marcos_usuario) / particiones;
+
+        p->PTBR = mmu_crear_tabla(paginas);
+        if (p->PTBR < 0) return 0;
+        p->PTLR = paginas;
+        p->RB = 0;
+        p->RL = paginas * PAGINA - 1;
+    } else {
+        // Particiones fijas e iguales; la última se queda con el resto
+        p->RB = INICIO_USUARIO + indice * tamano;
+        p->RL = (indice == particiones - 1) ? maquina.tamano_memoria - 1 : p->RB + tamano - 1;
+        p->PTBR = -1;
+        p->PTLR = 0;
+    }
+
+    if (!cargar_programa(programa, p->RB, p->RL, p->PTBR, &entrada)) return 0;
+
+    p->pid = total_procesos + 1;
+    snprintf(p->nombre, sizeof(p->nombre), "%s", programa);
+    p->AC = 0;
+    p->RX = 0;
+    p->SP = p->RL - p->RB;              // Pila al tope de la partición (relativo a RB)
+    p->psw = cpu.psw;                   // Mismo PSW de arranque que la CPU
+    p->psw.pc = entrada;                // _start del programa
+    p->dma = dma;
+    p->nucleo = -1;
+    p->llegada = ahora_ms();
+
+    encolar_listo(total_procesos);
+    total_procesos++;
+
+    if (paginacion) {
+        logger_log("[SO] Proceso %d (%s) con %d paginas, tabla en %d\n", p->pid, programa, p->PTLR, p->PTBR);
+    } else {
+        logger_log("[SO] Proceso %d (%s) en la particion %d-%d\n", p->pid, programa, p->RB, p->RL);
+    }
+    return 1;
+}
+
+int proceso_actual() {
+    return (actual >= 0) ? tabla[actual].pid : -1;
+}
+
+// --- CAMBIO DE CONTEXTO ---
+static void guardar_contexto(PCB_t *p) {
+    p->AC = cpu.AC;
+    p->RX = cpu.RX;
+    p->SP = cpu.SP;
+    p->RB = cpu.RB;
+    p->RL = cpu.RL;
+    p->PTBR = cpu.PTBR;
+    p->PTLR = cpu.PTLR;
+    p->psw = cpu.psw;
+    p->dma = dma;
+}
+
+static void cargar_contexto(const PCB_t *p) {
+    cpu.AC = p->AC;
+    cpu.RX = p->RX;
+    cpu.SP = p->SP;
+    cpu.RB = p->RB;
+    cpu.RL = p->RL;
+    cpu.PTBR = p->PTBR;
+    cpu.PTLR = p->PTLR;
+    cpu.psw = p->psw;
+    dma = p->dma;   // Solo registros de programación: el estado es del controlador
+}
+
+// Saca de la CPU al proceso actual (ya cambió de estado o vuelve a listos)
+static void desalojar() {
+    PCB_t *p = &tabla[actual];
+
+    guardar_contexto(p);
+    p->instrucciones += cpu.instrucciones - p->instrucciones_al_entrar;
+    p->nucleo = -1;
+    if (p->estado == PROC_EJECUTANDO) encolar_listo(actual);
+    actual = -1;
+}
+
+int procesos_despachar() {
+    int anterior = actual;
+    int vivos = 0;
+
+    pthread_mutex_lock(&procesos_mutex);
+
+    // Sigue el mismo proceso mientras pueda correr y no se le venza el turno
+    if (actual >= 0 && tabla[actual].estado == PROC_EJECUTANDO) {
+        if (!cambio_pendiente || listos_cantidad == 0) {
+            cambio_pendiente = 0;
+            pthread_mutex_unlock(&procesos_mutex);
+            return 1;
+        }
+    }
+    cambio_pendiente = 0;
+
+    if (actual >= 0) desalojar();
+
+    if (listos_cantidad == 0) {
+        for (int i = 0; i < total_procesos; i++) {
+            if (tabla[i].estado != PROC_TERMINADO) vivos++;
+        }
+        if (vivos == 0) atomic_store_explicit(&maquina.ejecutando, 0, memory_order_relaxed); // Terminaron todos: se apaga la máquina
+        pthread_mutex_unlock(&procesos_mutex);
+        return 0;
+    }
+
+    actual = sacar_listo();
+    tabla[actual].estado = PROC_EJECUTANDO;
+    tabla[actual].nucleo = cpu.nucleo;
+    tabla[actual].instrucciones_al_entrar = cpu.instrucciones;
+    cargar_contexto(&tabla[actual]);
+    ticks_turno = 0;
+
+    if (anterior >= 0 && anterior != actual) {
+        cambios_contexto++;
+        LOG_DEBUG("[SO] Nucleo %d: cambio de contexto, proceso %d -> %d (PC %d)\n",
+            cpu.nucleo, tabla[anterior].pid, tabla[actual].pid, cpu.psw.pc);
+    }
+    pthread_mutex_unlock(&procesos_mutex);
+    return 1;
+}
+
+void procesos_bloquear_actual() {
+    PCB_t *p;
+
+    if (actual < 0) return;
+    pthread_mutex_lock(&procesos_mutex);
+    p = &tabla[actual];
+    p->io_pendientes++;
+    p->estado = PROC_BLOQUEADO;
+    p->desde = ahora_ms();
+    pthread_mutex_unlock(&procesos_mutex);
+    cpu.corte_quantum = 1;  // El lote termina aquí y se despacha a otro
+}
+
+static void terminar(int error, int codigo) {
+    PCB_t *p;
+
+    if (actual < 0) return;
+    pthread_mutex_lock(&procesos_mutex);
+    p = &tabla[actual];
+    if (p->estado == PROC_TERMINADO) { // Ya terminó en este mismo lote
+        pthread_mutex_unlock(&procesos_mutex);
+        return;
+    }
+    p->estado = PROC_TERMINADO;
+    p->error = error;
+    p->codigo_salida = codigo;
+    p->fin = ahora_ms();
+    // Se cuentan ya: con varios núcleos la máquina puede apagarse antes
+    // de que este núcleo vuelva a despachar
+    p->instrucciones += cpu.instrucciones - p->instrucciones_al_entrar;
+    p->instrucciones_al_entrar = cpu.instrucciones;
+    pthread_mutex_unlock(&procesos_mutex);
+    cpu.corte_quantum = 1;
+
+    // Sus marcos quedan para los fallos de los demás
+    if (memoria_virtual) mmu_liberar_tabla(p->PTBR, p->PTLR);
+
+    logger_log("[SO] Proceso %d %s (AC=%d)\n", p->pid, error ? "abortado" : "terminado", cpu.AC);
+}
+
+void procesos_terminar_actual() {
+    terminar(0, INT_SYSCALL);
+}
+
+void procesos_abortar_actual(int codigo) {
+    terminar(1, codigo);
+}
+
+int procesos_presupuesto(int cantidad) {
+    const PCB_t *p;
+    unsigned long long hechas;
+
+    if (limite_instrucciones == 0 || actual < 0) return cantidad;
+    p = &tabla[actual];
+    hechas = p->instrucciones + (cpu.instrucciones - p->instrucciones_al_entrar);
+    if (hechas >= limite_instrucciones) return 0;
+    if (limite_instrucciones - hechas < (unsigned long long)cantidad) {
+        return (int)(limite_instrucciones - hechas);
+    }
+    return cantidad;
+}
+
+PCB_t *procesos_pcb(int pid) {
+    if (pid < 1 || pid > total_procesos) return NULL;
+    return &tabla[pid - 1];
+}
+
+// --- CHECKPOINT ---
+// Solo con un núcleo: el estado por hilo que se guarda es el del núcleo 0
+typedef struct {
+    double ahora_ms;        // Al restaurar, 'arranque' se corre hacia atrás
+    double ocioso_ms;
+    unsigned long long cambios_contexto;
+    int total_procesos;
+    int listos_inicio, listos_cantidad;
+    int actual, ticks_turno, cambio_pendiente;
+    int paginacion;         // Los PCB solo tienen sentido con el mismo modo de memoria
+} FotoProcesos_t;
+
+int procesos_guardar(FILE *f) {
+    FotoProcesos_t e;
+    int exito;
+
+    pthread_mutex_lock(&procesos_mutex);
+    e.ahora_ms = ahora_ms();
+    e.ocioso_ms = ocioso_ms;
+    e.cambios_contexto = cambios_contexto;
+    e.total_procesos = total_procesos;
+    e.listos_inicio = listos_inicio;
+    e.listos_cantidad = listos_cantidad;
+    e.actual = actual;
+    e.ticks_turno = ticks_turno;
+    e.cambio_pendiente = cambio_pendiente;
+    e.paginacion = paginacion;
+    exito = fwrite(&e, sizeof(e), 1, f) == 1 &&
+            fwrite(listos, sizeof(listos), 1, f) == 1 &&
+            fwrite(tabla, sizeof(PCB_t), total_procesos, f) == (size_t)total_procesos;
+    pthread_mutex_unlock(&procesos_mutex);
+    return exito;
+}
+
+int procesos_restaurar(FILE *f) {
+    FotoProcesos_t e;
+    long long ns;
+
+    if (fread(&e, sizeof(e), 1, f) != 1 || e.total_procesos < 0 || e.total_procesos > MAX_PROCESOS) {
+        return 0;
+    }
+    if (e.paginacion != paginacion) {
+        LOG_ERROR("[ERROR] El checkpoint se grabo %s --paginacion: hay que restaurarlo igual.\n",
+            e.paginacion ? "con" : "sin");
+        return 0;
+    }
+    memset(tabla, 0, sizeof(tabla));
+    if (fread(listos, sizeof(listos), 1, f) != 1 ||
+        fread(tabla, sizeof(PCB_t), e.total_procesos, f) != (size_t)e.total_procesos) {
+        return 0;
+    }
+    total_procesos = e.total_procesos;
+    listos_inicio = e.listos_inicio;
+    listos_cantidad = e.listos_cantidad;
+    actual = e.actual;
+    ticks_turno = e.ticks_turno;
+    cambio_pendiente = e.cambio_pendiente;
+    ocioso_ms = e.ocioso_ms;
+    cambios_contexto = e.cambios_contexto;
+    atomic_store(&nucleos_ociosos, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &arranque);
+    ns = arranque.tv_sec * 1000000000LL + arranque.tv_nsec - (long long)(e.ahora_ms * 1e6);
+    arranque.tv_sec = ns / 1000000000LL;
+    arranque.tv_nsec = ns % 1000000000LL;
+    return 1;
+}
+
+void procesos_tick() {
+    if (++ticks_turno >= quantum_rr) {
+        cambio_pendiente = 1;
+    }
+}
+
+void procesos_io_fin(int pid) {
+    PCB_t *p;
+
+    int despertar = 0;
+
+    if (pid < 1 || pid > total_procesos) return;
+    pthread_mutex_lock(&procesos_mutex);
+    p = &tabla[pid - 1];
+    if (p->io_pendientes > 0) p->io_pendientes--;
+
+    // Con todas sus transferencias terminadas vuelve a la cola de listos
+    if (p->estado == PROC_BLOQUEADO && p->io_pendientes == 0) {
+        p->bloqueado += ahora_ms() - p->desde;
+        if (p->nucleo >= 0) {
+            // Otro núcleo todavía no lo desalojó: sigue corriendo allí
+            p->estado = PROC_EJECUTANDO;
+        } else {
+            encolar_listo(pid - 1);
+            despertar = 1;
+        }
+    }
+    pthread_mutex_unlock(&procesos_mutex);
+
+    if (despertar) despertar_ocioso();
+}
+
+void procesos_ocioso() {
+    double desde = ahora_ms();
+    unsigned int bit = 1u << cpu.nucleo;
+    int hay_listos;
+
+    // Nos anotamos antes de mirar la cola: un proceso que se encole
+    // después ya ve el bit y nos manda un INT_IPI
+    atomic_fetch_or(&nucleos_ociosos, bit);
+    pthread_mutex_lock(&procesos_mutex);
+    hay_listos = listos_cantidad > 0;
+    pthread_mutex_unlock(&procesos_mutex);
+
+    // Sin procesos listos la CPU espera a que un dispositivo interrumpa
+    while (!hay_listos && atomic_load_explicit(&maquina.ejecutando, memory_order_relaxed) && !ic_hay_pendientes()) {
+        usleep(50);
+    }
+    atomic_fetch_and(&nucleos_ociosos, ~bit);
+
+    pthread_mutex_lock(&procesos_mutex);
+    ocioso_ms += ahora_ms() - desde;
+    pthread_mutex_unlock(&procesos_mutex);
+}
+
+void procesos_reporte() {
+    double total = ahora_ms();
+    double suma_retorno = 0, suma_espera = 0;
+
+    if (total_procesos == 0) return;
+
+    logger_log("[SO] PID  Retorno(ms)  Espera(ms)  Bloqueado(ms)  Instrucciones  Estado\n");
+    for (int i = 0; i < total_procesos; i++) {
+        PCB_t *p = &tabla[i];
+        double fin = (p->estado == PROC_TERMINADO) ? p->fin : total;
+
+        suma_retorno += fin - p->llegada;
+        suma_espera += p->espera;
+        logger_log("[SO] %3d  %11.1f  %10.1f  %13.1f  %13llu  %s\n",
+            p->pid, fin - p->llegada, p->espera, p->bloqueado, p->instrucciones,
+            p->estado != PROC_TERMINADO ? "vivo" : (p->error ? "abortado" : "terminado"));
+    }
+    logger_log("[SO] Retorno medio %.1f ms, espera media %.1f ms, %llu cambios de contexto\n",
+        suma_retorno / total_procesos, suma_espera / total_procesos, cambios_contexto);
+    // Con varios núcleos el tiempo disponible es total * núcleos
+    logger_log("[SO] Uso de CPU: %.1f%% (%.1f ms ociosa de %.1f ms x %d nucleo(s))\n",
+        total > 0 ? 100.0 * (total * maquina.nucleos - ocioso_ms) / (total * maquina.nucleos) : 0.0,
+        ocioso_ms, total, maquina.nucleos);
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/traza.h"
+#include "../include/cpu.h"
+#include "../include/logger.h"
+
+// Registros que junta cada núcleo antes de un fwrite (~384 KB)
+#define TRAZA_BUFFER 16384
+
+int traza_activa = 0;
+
+static FILE *archivo_traza = NULL;
+
+// Buffer de un núcleo: solo lo llena su hilo, sin candado. El candado
+// del archivo se toma recién al vaciarlo
+typedef struct {
+    RegistroTraza_t *registros;
+    int usados;
+    unsigned long long total;
+} ALINEADO_LINEA BufferTraza_t;
+
+static BufferTraza_t buffers[MAX_NUCLEOS];
+static pthread_mutex_t mutex_traza = PTHREAD_MUTEX_INITIALIZER;
+
+// Escritura pendiente de la instrucción actual. Es por hilo: así las
+// escrituras del DMA no se mezclan con las de la CPU.
+static __thread int escritura_dir = -1;
+static __thread int escritura_valor = 0;
+
+static void vaciar_buffer(BufferTraza_t *b) {
+    if (b->usados > 0) {
+        pthread_mutex_lock(&mutex_traza);
+        fwrite(b->registros, sizeof(RegistroTraza_t), b->usados, archivo_traza);
+        pthread_mutex_unlock(&mutex_traza);
+        b->usados = 0;
+    }
+}
+
+static void liberar_buffers() {
+    for (int n = 0; n < MAX_NUCLEOS; n++) {
+        free(buffers[n].registros);
+        buffers[n].registros = NULL;
+    }
+}
+
+int traza_abrir(const char *ruta) {
+    CabeceraTraza_t cabecera;
+
+    archivo_traza = fopen(ruta, "wb");
+    if (archivo_traza == NULL) {
+        LOG_ERROR("[TRAZA] No se pudo crear %s\n", ruta);
+        return 0;
+    }
+
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magico, TRAZA_MAGICO, sizeof(cabecera.magico));
+    cabecera.version = TRAZA_VERSION;
+    cabecera.tamano_registro = sizeof(RegistroTraza_t);
+    fwrite(&cabecera, sizeof(cabecera), 1, archivo_traza);
+
+    for (int n = 0; n < maquina.nucleos; n++) {
+        buffers[n].usados = 0;
+        buffers[n].total = 0;
+        buffers[n].registros = malloc(TRAZA_BUFFER * sizeof(RegistroTraza_t));
+        if (buffers[n].registros == NULL) {
+            LOG_ERROR("[TRAZA] No hay memoria para el buffer del nucleo %d\n", n);
+            liberar_buffers();
+            fclose(archivo_traza);
+            archivo_traza = NULL;
+            return 0;
+        }
+    }
+
+    traza_activa = 1;
+    logger_log("[TRAZA] Grabando traza binaria en %s\n", ruta);
+    return 1;
+}
+
+void traza_anotar_escritura(int dir, int valor) {
+    escritura_dir = dir;
+    escritura_valor = valor;
+}
+
+void traza_retirar(int pc, int ir, int ac, int cc, int opcode, int modo) {
+    BufferTraza_t *b = &buffers[cpu.nucleo];
+    RegistroTraza_t *r = &b->registros[b->usados];
+
+    r->pc = pc;
+    r->ir = ir;
+    r->ac = ac;
+    r->dir_escritura = escritura_dir;
+    r->valor_escritura = escritura_valor;
+    r->cc = (uint8_t)cc;
+    r->opcode = (uint8_t)opcode;
+    r->modo = (uint8_t)modo;
+    r->nucleo = (uint8_t)cpu.nucleo;
+
+    escritura_dir = -1;
+    b->total++;
+
+    if (++b->usados == TRAZA_BUFFER) {
+        vaciar_buffer(b);
+    }
+}
+
+void traza_cerrar() {
+    unsigned long long total = 0;
+
+    if (archivo_traza == NULL) return;
+
+    // Los núcleos ya terminaron: sus buffers se vacían desde este hilo
+    traza_activa = 0;
+    for (int n = 0; n < MAX_NUCLEOS; n++) {
+        if (buffers[n].registros == NULL) continue;
+        vaciar_buffer(&buffers[n]);
+        total += buffers[n].total;
+    }
+    liberar_buffers();
+    fclose(archivo_traza);
+    archivo_traza = NULL;
+    logger_log("[TRAZA] %llu instrucciones grabadas.\n", total);
+}
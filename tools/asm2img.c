@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/imagen.h"
+
+// ====================================================
+// ASM2IMG: convierte un programa .asm en imagen binaria
+// ====================================================
+// Uso: asm2img programa.asm [-o salida.img] [--base=N]
+//      asm2img --ver imagen.img
+//
+// Sin -o la imagen se escribe junto al .asm con extensión .img.
+
+static void uso() {
+    fprintf(stderr, "Uso: asm2img programa.asm [-o salida.img] [--base=N]\n"
+                    "     asm2img --ver imagen.img\n");
+}
+
+// Lee un archivo completo. Retorna el buffer (NULL si falló)
+static char *leer_archivo(const char *ruta, size_t *largo) {
+    FILE *f = fopen(ruta, "rb");
+    char *datos;
+    long tamano;
+
+    if (f == NULL) return NULL;
+    fseek(f, 0, SEEK_END);
+    tamano = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    datos = malloc(tamano > 0 ? tamano : 1);
+    if (datos != NULL && fread(datos, 1, tamano, f) != (size_t)tamano) {
+        free(datos);
+        datos = NULL;
+    }
+    fclose(f);
+    *largo = tamano;
+    return datos;
+}
+
+// Muestra la cabecera de una imagen y si su suma es correcta
+static int ver_imagen(const char *ruta) {
+    size_t largo;
+    char *datos = leer_archivo(ruta, &largo);
+    const CabeceraImagen_t *c = (const CabeceraImagen_t *)datos;
+    const char *motivo;
+
+    if (datos == NULL) {
+        fprintf(stderr, "asm2img: no se pudo leer %s\n", ruta);
+        return 1;
+    }
+    motivo = imagen_validar(datos, largo);
+    if (motivo != NULL && !imagen_es_binaria(datos, largo)) {
+        fprintf(stderr, "asm2img: %s: %s\n", ruta, motivo);
+        free(datos);
+        return 1;
+    }
+
+    printf("Nombre:   %.*s\n", IMAGEN_NOMBRE, c->nombre);
+    printf("Version:  %u\n", c->version);
+    printf("Palabras: %d\n", c->palabras);
+    printf("Base:     %d\n", c->base);
+    printf("Entrada:  %d\n", c->entrada);
+    printf("Suma:     %08x (%s)\n", c->suma, motivo == NULL ? "correcta" : motivo);
+    free(datos);
+    return motivo == NULL ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *entrada = NULL;
+    const char *salida = NULL;
+    char salida_defecto[1024];
+    char *texto;
+    size_t largo;
+    int base = 0;
+    Programa_t p;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ver") == 0 && i + 1 < argc) {
+            return ver_imagen(argv[i + 1]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            salida = argv[++i];
+        } else if (strncmp(argv[i], "--base=", 7) == 0) {
+            base = atoi(argv[i] + 7);
+        } else if (argv[i][0] == '-') {
+            uso();
+            return 1;
+        } else {
+            entrada = argv[i];
+        }
+    }
+    if (entrada == NULL || base < 0) {
+        uso();
+        return 1;
+    }
+
+    // Sin -o: programa.asm -> programa.img
+    if (salida == NULL) {
+        const char *punto = strrchr(entrada, '.');
+        int largo_base = (punto != NULL && strchr(punto, '/') == NULL) ? (int)(punto - entrada)
+                                                                       : (int)strlen(entrada);
+        snprintf(salida_defecto, sizeof(salida_defecto), "%.*s.img", largo_base, entrada);
+        salida = salida_defecto;
+    }
+
+    texto = leer_archivo(entrada, &largo);
+    if (texto == NULL) {
+        fprintf(stderr, "asm2img: no se pudo leer %s\n", entrada);
+        return 1;
+    }
+    if (imagen_es_binaria(texto, largo)) {
+        fprintf(stderr, "asm2img: %s ya es una imagen\n", entrada);
+        free(texto);
+        return 1;
+    }
+    if (!imagen_parsear_texto(texto, largo, &p)) {
+        fprintf(stderr, "asm2img: %s:%d: linea invalida\n", entrada, p.linea_error);
+        imagen_liberar(&p);
+        free(texto);
+        return 1;
+    }
+    free(texto);
+
+    if (p.declaradas >= 0 && p.declaradas != p.palabras) {
+        fprintf(stderr, "asm2img: aviso: .NumeroPalabras dice %d pero hay %d palabras\n",
+            p.declaradas, p.palabras);
+    }
+    if (!imagen_escribir(salida, &p, base)) {
+        fprintf(stderr, "asm2img: no se pudo escribir %s\n", salida);
+        imagen_liberar(&p);
+        return 1;
+    }
+
+    printf("%s -> %s (%d palabras, entrada %d, base %d)\n", entrada, salida, p.palabras, p.entrada, base);
+    imagen_liberar(&p);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+// ====================================================
+// BENCH: corre la suite de rendimiento del simulador
+// ====================================================
+// Uso: bench [--repeticiones=N] [--simulador=bin/simulador]
+//            [--base=resultados.txt] [--tolerancia=PCT] suite.txt
+//
+// Cada línea de la suite es "nombre argumentos..." (programas y opciones
+// del simulador); las que empiezan con # se ignoran. Cada benchmark corre
+// N veces en modo turbo y sin log, y cada corrida deja su línea de
+// métricas con --resumen. Por benchmark se escribe una línea clave=valor
+// con la mediana de cada métrica (el máximo para las que son máximos).
+// Con --base se compara el MIPS contra una salida anterior y se sale con
+// 1 si alguno cayó más que la tolerancia.
+
+#define MAX_METRICAS      32
+#define MAX_REPETICIONES  101
+#define MAX_ARGUMENTOS    64
+
+typedef struct {
+    char nombre[48];
+    double valores[MAX_REPETICIONES];
+} Metrica_t;
+
+static Metrica_t metricas[MAX_METRICAS];
+static int total_metricas;
+
+static void uso() {
+    fprintf(stderr, "Uso: bench [--repeticiones=N] [--simulador=bin/simulador]\n"
+                    "             [--base=resultados.txt] [--tolerancia=PCT] suite.txt\n");
+}
+
+static int comparar_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Mediana (o máximo) de las 'n' repeticiones de una métrica
+static double agregar(Metrica_t *m, int n) {
+    qsort(m->valores, n, sizeof(double), comparar_double);
+    if (strstr(m->nombre, "max") != NULL) return m->valores[n - 1];
+    return n % 2 ? m->valores[n / 2] : (m->valores[n / 2 - 1] + m->valores[n / 2]) / 2;
+}
+
+// Guarda los clave=valor de una línea de resumen como repetición 'rep'
+static int leer_resumen(const char *ruta, int rep) {
+    char linea[2048], *campo, *resto;
+    FILE *f = fopen(ruta, "r");
+
+    if (f == NULL) return 0;
+    if (fgets(linea, sizeof(linea), f) == NULL) {
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+
+    for (campo = strtok_r(linea, " \n", &resto); campo != NULL; campo = strtok_r(NULL, " \n", &resto)) {
+        char *igual = strchr(campo, '=');
+        int m;
+
+        if (igual == NULL) continue;
+        *igual = '\0';
+        for (m = 0; m < total_metricas; m++) {
+            if (strcmp(metricas[m].nombre, campo) == 0) break;
+        }
+        if (m == total_metricas) {
+            if (rep > 0 || total_metricas == MAX_METRICAS) continue; // Solo las de la primera
+            snprintf(metricas[m].nombre, sizeof(metricas[m].nombre), "%s", campo);
+            total_metricas++;
+        }
+        metricas[m].valores[rep] = atof(igual + 1);
+    }
+    return 1;
+}
+
+// Corre el simulador una vez. Retorna 1 si terminó bien y dejó su resumen
+static int correr(const char *simulador, char **argumentos, int cantidad, const char *resumen, int rep) {
+    char opcion_resumen[512];
+    char *argv[MAX_ARGUMENTOS + 5];
+    int estado, n = 0;
+    pid_t pid;
+
+    snprintf(opcion_resumen, sizeof(opcion_resumen), "--resumen=%s", resumen);
+    argv[n++] = (char *)simulador;
+    argv[n++] = "--modo=turbo";
+    argv[n++] = "--log=error";
+    argv[n++] = opcion_resumen;
+    for (int i = 0; i < cantidad; i++) argv[n++] = argumentos[i];
+    argv[n] = NULL;
+
+    unlink(resumen);
+    pid = fork();
+    if (pid < 0) return 0;
+    if (pid == 0) {
+        int nulo = open("/dev/null", O_WRONLY);
+        dup2(nulo, STDOUT_FILENO);
+        dup2(nulo, STDERR_FILENO);
+        execv(simulador, argv);
+        _exit(127);
+    }
+    if (waitpid(pid, &estado, 0) < 0 || !WIFEXITED(estado) || WEXITSTATUS(estado) != 0) return 0;
+    return leer_resumen(resumen, rep);
+}
+
+// MIPS de 'nombre' en una salida anterior de bench (-1 si no está)
+static double mips_base(const char *ruta, const char *nombre) {
+    char linea[4096], buscado[128];
+    double mips = -1;
+    FILE *f;
+
+    if (ruta == NULL || (f = fopen(ruta, "r")) == NULL) return -1;
+    snprintf(buscado, sizeof(buscado), "bench=%s ", nombre);
+    while (fgets(linea, sizeof(linea), f) != NULL) {
+        char *p;
+        if (strncmp(linea, buscado, strlen(buscado)) != 0) continue;
+        if ((p = strstr(linea, " mips=")) != NULL) mips = atof(p + 6);
+    }
+    fclose(f);
+    return mips;
+}
+
+int main(int argc, char *argv[]) {
+    const char *simulador = "bin/simulador";
+    const char *ruta_suite = NULL;
+    const char *ruta_base = NULL;
+    char resumen[64], linea[1024];
+    int repeticiones = 5, regresiones = 0, fallidos = 0;
+    double tolerancia = 10;
+    FILE *suite;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--repeticiones=", 15) == 0) {
+            repeticiones = atoi(argv[i] + 15);
+        } else if (strncmp(argv[i], "--simulador=", 12) == 0) {
+            simulador = argv[i] + 12;
+        } else if (strncmp(argv[i], "--base=", 7) == 0) {
+            ruta_base = argv[i] + 7;
+        } else if (strncmp(argv[i], "--tolerancia=", 13) == 0) {
+            tolerancia = atof(argv[i] + 13);
+        } else if (argv[i][0] == '-') {
+            uso();
+            return 1;
+        } else {
+            ruta_suite = argv[i];
+        }
+    }
+    if (ruta_suite == NULL || repeticiones < 1 || repeticiones > MAX_REPETICIONES) {
+        uso();
+        return 1;
+    }
+    suite = fopen(ruta_suite, "r");
+    if (suite == NULL) {
+        fprintf(stderr, "bench: no se pudo abrir %s\n", ruta_suite);
+        return 1;
+    }
+    snprintf(resumen, sizeof(resumen), "/tmp/bench-%d.txt", (int)getpid());
+
+    printf("# simulador=%s repeticiones=%d suite=%s\n", simulador, repeticiones, ruta_suite);
+    fflush(stdout);
+
+    while (fgets(linea, sizeof(linea), suite) != NULL) {
+        char *argumentos[MAX_ARGUMENTOS], *nombre, *resto;
+        int cantidad = 0, hechas = 0;
+        double base;
+
+        nombre = strtok_r(linea, " \t\n", &resto);
+        if (nombre == NULL || nombre[0] == '#') continue;
+        while (cantidad < MAX_ARGUMENTOS &&
+               (argumentos[cantidad] = strtok_r(NULL, " \t\n", &resto)) != NULL) {
+            cantidad++;
+        }
+
+        total_metricas = 0;
+        for (int r = 0; r < repeticiones; r++) {
+            if (!correr(simulador, argumentos, cantidad, resumen, hechas)) break;
+            hechas++;
+        }
+        if (hechas < repeticiones) {
+            printf("bench=%s error=1\n", nombre);
+            fflush(stdout);
+            fallidos++;
+            continue;
+        }
+
+        printf("bench=%s repeticiones=%d", nombre, hechas);
+        for (int m = 0; m < total_metricas; m++) {
+            double valor = agregar(&metricas[m], hechas);
+
+            // Los contadores salen enteros; tiempos y tasas con 3 decimales
+            if (valor == (long long)valor) printf(" %s=%lld", metricas[m].nombre, (long long)valor);
+            else printf(" %s=%.3f", metricas[m].nombre, valor);
+            if (strcmp(metricas[m].nombre, "mips") == 0) {
+                // Ya quedaron ordenadas por agregar
+                printf(" mips_min=%.3f mips_max=%.3f", metricas[m].valores[0], metricas[m].valores[hechas - 1]);
+            }
+        }
+
+        base = mips_base(ruta_base, nombre);
+        for (int m = 0; base > 0 && m < total_metricas; m++) {
+            double cambio;
+
+            if (strcmp(metricas[m].nombre, "mips") != 0) continue;
+            cambio = (agregar(&metricas[m], hechas) - base) * 100 / base;
+            printf(" mips_vs_base=%+.1f%%", cambio);
+            if (cambio < -tolerancia) {
+                printf(" regresion=1");
+                regresiones++;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    fclose(suite);
+    unlink(resumen);
+
+    if (regresiones > 0) {
+        fprintf(stderr, "bench: %d benchmark(s) perdieron mas de %.0f%% de MIPS\n", regresiones, tolerancia);
+    }
+    return (regresiones > 0 || fallidos > 0) ? 1 : 0;
+}
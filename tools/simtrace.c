@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/traza.h"
+#include "../include/constantes.h"
+
+// ====================================================
+// SIMTRACE: decodificador de trazas binarias del simulador
+// ====================================================
+// Uso: simtrace archivo.bin [--pc=A[-B]] [--opcode=N|NOMBRE]
+//                           [--nucleo=N] [--limite=N] [--resumen]
+
+#define LOTE 4096
+#define MAX_OPCODES 100
+#define TOP_PCS 10
+#define NUCLEOS 256   // Lo que entra en el byte 'nucleo' del registro
+
+static const char *NOMBRES[OP_MAXIMO + 1] = {
+    "SUM", "RES", "MULT", "DIVI", "LOAD", "STR", "LOADRX", "STRRX",
+    "COMP", "JMPE", "JMPNE", "JMPLT", "JMPLGT", "SVC", "RETRN", "HAB",
+    "DHAB", "TTI", "CHMOD", "LOADRB", "STRRB", "LOADRL", "STRRL", "LOADSP",
+    "STRSP", "PSH", "POP", "J", "SDMAP", "SDMAC", "SDMAS", "SDMAIO",
+    "SDMAM", "SDMAON", "SDMACNT", "SDMACAD"
+};
+
+static const char *nombre_opcode(int opcode) {
+    if (opcode >= 0 && opcode <= OP_MAXIMO) return NOMBRES[opcode];
+    return "???";
+}
+
+// Número de opcode desde un nombre o una cadena de dígitos. Retorna -1 si
+// no es ninguna de las dos
+static int opcode_desde_texto(const char *texto) {
+    for (int i = 0; i <= OP_MAXIMO; i++) {
+        if (strcmp(texto, NOMBRES[i]) == 0) return i;
+    }
+    if (texto[0] == '\0' || strspn(texto, "0123456789") != strlen(texto) || strlen(texto) > 2) return -1;
+    return atoi(texto);
+}
+
+// Conteo por PC para el top de direcciones más ejecutadas
+typedef struct {
+    int pc;
+    unsigned long long veces;
+} ConteoPC_t;
+
+static int comparar_conteos(const void *a, const void *b) {
+    const ConteoPC_t *x = a, *y = b;
+    if (x->veces != y->veces) return (x->veces < y->veces) ? 1 : -1;
+    return x->pc - y->pc;
+}
+
+// Agranda la tabla por PC para que entre 'pc' (la RAM puede ser de --memoria=N).
+// Retorna 1 si tuvo éxito, 0 si falló
+static int crecer_por_pc(ConteoPC_t **por_pc, int *capacidad, int pc) {
+    int nueva = *capacidad;
+    ConteoPC_t *tabla;
+
+    while (nueva <= pc) nueva = (nueva > 0x3fffffff) ? pc + 1 : nueva * 2;
+    tabla = realloc(*por_pc, (size_t)nueva * sizeof(ConteoPC_t));
+    if (tabla == NULL) return 0;
+    for (int i = *capacidad; i < nueva; i++) {
+        tabla[i].pc = i;
+        tabla[i].veces = 0;
+    }
+    *por_pc = tabla;
+    *capacidad = nueva;
+    return 1;
+}
+
+static void uso() {
+    fprintf(stderr, "Uso: simtrace archivo.bin [--pc=A[-B]] [--opcode=N|NOMBRE]\n"
+                    "                          [--nucleo=N] [--limite=N] [--resumen]\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *ruta = NULL;
+    int pc_desde = 0, pc_hasta = 0x7fffffff;
+    int opcode_filtro = -1;
+    int nucleo_filtro = -1;
+    long long limite = -1;
+    int solo_resumen = 0;
+    FILE *f;
+    CabeceraTraza_t cabecera;
+    RegistroTraza_t lote[LOTE];
+    size_t leidos;
+
+    // Estadísticas
+    unsigned long long total = 0, filtrados = 0, escrituras = 0, impresos = 0;
+    unsigned long long por_opcode[MAX_OPCODES] = {0};
+    unsigned long long por_nucleo[NUCLEOS] = {0};   // Índice de cada registro en el flujo de su núcleo
+    unsigned long long filtrados_nucleo[NUCLEOS] = {0};
+    int pc_min = 0x7fffffff, pc_max = -1;
+    ConteoPC_t *por_pc = calloc(TAMANO_MEMORIA, sizeof(ConteoPC_t));
+    int capacidad_pc = TAMANO_MEMORIA;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--pc=", 5) == 0) {
+            char *guion = strchr(argv[i] + 5, '-');
+            pc_desde = atoi(argv[i] + 5);
+            pc_hasta = guion ? atoi(guion + 1) : pc_desde;
+        } else if (strncmp(argv[i], "--opcode=", 9) == 0) {
+            opcode_filtro = opcode_desde_texto(argv[i] + 9);
+            if (opcode_filtro < 0) {
+                fprintf(stderr, "[ERROR] Opcode desconocido: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--nucleo=", 9) == 0) {
+            nucleo_filtro = atoi(argv[i] + 9);
+            if (nucleo_filtro < 0 || nucleo_filtro >= NUCLEOS) {
+                fprintf(stderr, "[ERROR] Nucleo invalido: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--limite=", 9) == 0) {
+            limite = atoll(argv[i] + 9);
+        } else if (strcmp(argv[i], "--resumen") == 0) {
+            solo_resumen = 1;
+        } else if (argv[i][0] == '-') {
+            uso();
+            return 1;
+        } else {
+            ruta = argv[i];
+        }
+    }
+    if (ruta == NULL || por_pc == NULL) {
+        uso();
+        return 1;
+    }
+
+    f = fopen(ruta, "rb");
+    if (f == NULL) {
+        perror("[ERROR] No se pudo abrir la traza");
+        return 1;
+    }
+    if (fread(&cabecera, sizeof(cabecera), 1, f) != 1 ||
+        memcmp(cabecera.magico, TRAZA_MAGICO, sizeof(cabecera.magico)) != 0 ||
+        cabecera.version != TRAZA_VERSION || cabecera.tamano_registro != sizeof(RegistroTraza_t)) {
+        fprintf(stderr, "[ERROR] %s no es una traza valida (version %d)\n", ruta, TRAZA_VERSION);
+        fclose(f);
+        return 1;
+    }
+
+    for (int i = 0; i < TAMANO_MEMORIA; i++) por_pc[i].pc = i;
+
+    while ((leidos = fread(lote, sizeof(RegistroTraza_t), LOTE, f)) > 0) {
+        for (size_t i = 0; i < leidos; i++) {
+            RegistroTraza_t *r = &lote[i];
+            unsigned long long indice = por_nucleo[r->nucleo]++;
+            total++;
+
+            if (nucleo_filtro >= 0 && r->nucleo != nucleo_filtro) continue;
+            if (r->pc < pc_desde || r->pc > pc_hasta) continue;
+            if (opcode_filtro >= 0 && r->opcode != opcode_filtro) continue;
+
+            filtrados++;
+            filtrados_nucleo[r->nucleo]++;
+            if (r->opcode < MAX_OPCODES) por_opcode[r->opcode]++;
+            if (r->pc >= capacidad_pc && !crecer_por_pc(&por_pc, &capacidad_pc, r->pc)) {
+                fprintf(stderr, "[ERROR] No hay memoria para contar el PC %d\n", r->pc);
+                fclose(f);
+                return 1;
+            }
+            if (r->pc >= 0) por_pc[r->pc].veces++;
+            if (r->pc < pc_min) pc_min = r->pc;
+            if (r->pc > pc_max) pc_max = r->pc;
+            if (r->dir_escritura >= 0) escrituras++;
+
+            if (solo_resumen || (limite >= 0 && (long long)impresos >= limite)) continue;
+
+            printf("N%d %10llu PC:%04d IR:%08d %-6s M:%d AC:%08d CC:%d",
+                r->nucleo, indice, r->pc, r->ir, nombre_opcode(r->opcode), r->modo, r->ac, r->cc);
+            if (r->dir_escritura >= 0) {
+                printf(" Mem[%d]=%d", r->dir_escritura, r->valor_escritura);
+            }
+            printf("\n");
+            impresos++;
+        }
+    }
+    fclose(f);
+
+    // --- RESUMEN ---
+    printf("\n=== RESUMEN DE TRAZA ===\n");
+    printf("Instrucciones en archivo : %llu\n", total);
+    printf("Instrucciones filtradas  : %llu\n", filtrados);
+    printf("Escrituras a memoria     : %llu\n", escrituras);
+    if (filtrados > 0) {
+        printf("Rango de PC              : %d - %d\n", pc_min, pc_max);
+    }
+
+    printf("\nPor nucleo:\n");
+    for (int n = 0; n < NUCLEOS; n++) {
+        if (filtrados_nucleo[n] == 0) continue;
+        printf("  %-11d %12llu  %6.2f%%\n", n, filtrados_nucleo[n],
+            100.0 * filtrados_nucleo[n] / filtrados);
+    }
+
+    printf("\nPor opcode:\n");
+    for (int op = 0; op < MAX_OPCODES; op++) {
+        if (por_opcode[op] == 0) continue;
+        printf("  %-6s (%02d) %12llu  %6.2f%%\n", nombre_opcode(op), op,
+            por_opcode[op], 100.0 * por_opcode[op] / filtrados);
+    }
+
+    qsort(por_pc, capacidad_pc, sizeof(ConteoPC_t), comparar_conteos);
+    printf("\nPC mas ejecutados:\n");
+    for (int i = 0; i < TOP_PCS && por_pc[i].veces > 0; i++) {
+        printf("  %04d %12llu  %6.2f%%\n", por_pc[i].pc, por_pc[i].veces,
+            100.0 * por_pc[i].veces / filtrados);
+    }
+
+    free(por_pc);
+    return 0;
+}